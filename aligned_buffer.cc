@@ -0,0 +1,191 @@
+#include "aligned_buffer.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+constexpr std::size_t aligned_buffer::alignment;
+constexpr std::size_t aligned_buffer::huge_page_size;
+
+namespace {
+
+thread_local bool huge_pages = false;
+
+// mappings are rounded up to whole huge pages
+std::size_t mapped_length(std::size_t size) {
+    const std::size_t page = aligned_buffer::huge_page_size;
+    return (size + page - 1) / page * page;
+}
+
+#ifdef __linux__
+void *map_huge_pages(std::size_t size) {
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+        return p;
+
+    p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+    madvise(p, size, MADV_HUGEPAGE);
+    return p;
+}
+#endif
+
+/**
+ * Allocates size bytes aligned to aligned_buffer::alignment, mapped sets whether they have to be
+ * unmapped with mapped_length(size)
+ */
+value_type *allocate_aligned(std::size_t size, bool &mapped) {
+    mapped = false;
+#ifdef __linux__
+    if (huge_pages && size >= aligned_buffer::huge_page_size) {
+        void *p = map_huge_pages(mapped_length(size));
+        if (p != nullptr) {
+            mapped = true;
+            return static_cast<value_type *>(p);
+        }
+    }
+#endif
+    void *p = nullptr;
+    const std::size_t alignment = aligned_buffer::alignment;
+    if (posix_memalign(&p, alignment, (size + alignment - 1) / alignment * alignment) != 0)
+        throw std::bad_alloc();
+    return static_cast<value_type *>(p);
+}
+
+void free_aligned(value_type *data, std::size_t size, bool mapped) {
+#ifdef __linux__
+    if (mapped) {
+        munmap(data, mapped_length(size));
+        return;
+    }
+#else
+    (void)size;
+    (void)mapped;
+#endif
+    std::free(data);
+}
+
+} // namespace
+
+struct aligned_buffer::arena {
+    arena() = default;
+
+    ~arena() {
+        for (const block &b : blocks)
+            free_aligned(b.data, b.size, b.mapped);
+    }
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    value_type *allocate(std::size_t size) {
+        size = (size + alignment - 1) / alignment * alignment;
+        const std::size_t block_size = huge_pages ? huge_page_size : std::size_t(64) << 10;
+        if (size > block_size)
+            return add_block(size);
+
+        if (current_size - used < size) {
+            current = add_block(block_size);
+            current_size = block_size;
+            used = 0;
+        }
+        value_type *p = current + used;
+        used += size;
+        return p;
+    }
+
+private:
+    struct block {
+        value_type *data;
+        std::size_t size;
+        bool mapped;
+    };
+
+    value_type *add_block(std::size_t size) {
+        bool mapped = false;
+        value_type *data = allocate_aligned(size, mapped);
+        try {
+            blocks.push_back({data, size, mapped});
+        } catch (...) {
+            free_aligned(data, size, mapped);
+            throw;
+        }
+        return data;
+    }
+
+    std::vector<block> blocks;
+    value_type *current = nullptr; // block the small buffers are carved from
+    std::size_t current_size = 0;
+    std::size_t used = 0;
+};
+
+std::shared_ptr<aligned_buffer::arena> &aligned_buffer::current_arena() {
+    static thread_local std::shared_ptr<arena> current;
+    return current;
+}
+
+aligned_buffer::arena_scope::arena_scope()
+    : _previous(std::move(current_arena())) {
+    current_arena() = std::make_shared<arena>();
+}
+
+aligned_buffer::arena_scope::~arena_scope() {
+    current_arena() = std::move(_previous);
+}
+
+aligned_buffer::huge_pages_scope::huge_pages_scope(bool enabled)
+    : _previous(huge_pages) {
+    huge_pages = enabled;
+}
+
+aligned_buffer::huge_pages_scope::~huge_pages_scope() {
+    huge_pages = _previous;
+}
+
+aligned_buffer::aligned_buffer(std::size_t size)
+    : _data(nullptr)
+    , _size(size)
+    , _mapped(false)
+    , _arena(size == 0 ? nullptr : current_arena()) {
+    if (size == 0)
+        return;
+
+    _data = _arena ? _arena->allocate(size) : allocate_aligned(size, _mapped);
+    std::memset(_data, 0, size);
+}
+
+aligned_buffer::~aligned_buffer() {
+    release();
+}
+
+aligned_buffer::aligned_buffer(aligned_buffer &&other) noexcept
+    : _data(std::exchange(other._data, nullptr))
+    , _size(std::exchange(other._size, 0))
+    , _mapped(std::exchange(other._mapped, false))
+    , _arena(std::move(other._arena)) {}
+
+aligned_buffer &aligned_buffer::operator=(aligned_buffer &&other) noexcept {
+    if (this != &other) {
+        release();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _mapped = std::exchange(other._mapped, false);
+        _arena = std::move(other._arena);
+    }
+    return *this;
+}
+
+void aligned_buffer::release() {
+    if (_arena)
+        _arena.reset();
+    else if (_data != nullptr)
+        free_aligned(_data, _size, _mapped);
+    _data = nullptr;
+}
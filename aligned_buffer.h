@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using value_type = std::uint8_t;
+
+/**
+ * @brief Contiguous 64-byte aligned byte buffer for the internal state of streams
+ *
+ * Buffers allocated while an arena_scope is active are carved out of the arena of that scope, so
+ * the buffers of a stream tree lie next to each other in a few large blocks. The arena lives as
+ * long as any of its buffers.
+ *
+ * Buffers of 2 MB and more, and the blocks of an arena, can be backed by huge pages, which the
+ * "huge_pages" option of the generator config enables for the streams of that generator (see
+ * huge_pages_scope). When the system has no huge pages reserved, the kernel is only advised to
+ * use transparent huge pages.
+ */
+class aligned_buffer {
+    struct arena;
+
+public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    aligned_buffer()
+        : _data(nullptr)
+        , _size(0)
+        , _mapped(false) {}
+
+    explicit aligned_buffer(std::size_t size);
+    ~aligned_buffer();
+
+    aligned_buffer(aligned_buffer &&other) noexcept;
+    aligned_buffer &operator=(aligned_buffer &&other) noexcept;
+
+    aligned_buffer(const aligned_buffer &) = delete;
+    aligned_buffer &operator=(const aligned_buffer &) = delete;
+
+    value_type *data() { return _data; }
+    const value_type *data() const { return _data; }
+    std::size_t size() const { return _size; }
+
+    value_type *begin() { return _data; }
+    value_type *end() { return _data + _size; }
+    const value_type *begin() const { return _data; }
+    const value_type *end() const { return _data + _size; }
+    const value_type *cbegin() const { return _data; }
+    const value_type *cend() const { return _data + _size; }
+
+    value_type &operator[](std::size_t i) { return _data[i]; }
+    const value_type &operator[](std::size_t i) const { return _data[i]; }
+
+    /**
+     * @brief Sets whether the buffers allocated by the calling thread use huge pages, until the
+     * scope ends
+     *
+     * A generator builds its streams in its own scope, so generators of a campaign running on other
+     * threads keep their setting.
+     */
+    class huge_pages_scope {
+    public:
+        explicit huge_pages_scope(bool enabled);
+        ~huge_pages_scope();
+
+        huge_pages_scope(const huge_pages_scope &) = delete;
+        huge_pages_scope &operator=(const huge_pages_scope &) = delete;
+
+    private:
+        bool _previous;
+    };
+
+    /**
+     * @brief Makes the buffers allocated by the calling thread share one arena, until the scope
+     * ends
+     *
+     * A generator builds the streams of each of its trees in a scope. Blocks of the arena are
+     * 64 KiB, or one huge page when huge pages are enabled; larger buffers get a block of their
+     * own. Buffers are never returned to the arena, it is meant for buffers living as long as the
+     * tree.
+     */
+    class arena_scope {
+    public:
+        arena_scope();
+        ~arena_scope();
+
+        arena_scope(const arena_scope &) = delete;
+        arena_scope &operator=(const arena_scope &) = delete;
+
+    private:
+        std::shared_ptr<arena> _previous;
+    };
+
+private:
+    void release();
+
+    static std::shared_ptr<arena> &current_arena();
+
+    value_type *_data;
+    std::size_t _size;
+    bool _mapped;
+    std::shared_ptr<arena> _arena; // owns _data when set
+};
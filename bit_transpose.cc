@@ -0,0 +1,287 @@
+#include "bit_transpose.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace bit_transpose {
+
+namespace {
+
+/**
+ * Transposes the 8x8 block with top left corner at row 8 * row_block and byte column col_byte
+ */
+void transpose_block(const std::uint8_t *in,
+                     std::size_t row_bytes,
+                     std::size_t out_bytes,
+                     std::size_t row_block,
+                     std::size_t col_byte,
+                     std::uint8_t *out) {
+    // row 0 in the most significant byte, so the bits are in row-major order from the top
+    std::uint64_t x = 0;
+    const std::uint8_t *src = in + 8 * row_block * row_bytes + col_byte;
+    for (std::size_t k = 0; k < 8; ++k, src += row_bytes)
+        x = (x << 8) | *src;
+
+    std::uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    x = x ^ t ^ (t << 28);
+
+    std::uint8_t *dst = out + 8 * col_byte * out_bytes + row_block;
+    for (std::size_t k = 0; k < 8; ++k, dst += out_bytes)
+        *dst = std::uint8_t(x >> (56 - 8 * k));
+}
+
+void transpose_scalar(const std::uint8_t *in,
+                      std::size_t rows,
+                      std::size_t row_bytes,
+                      std::uint8_t *out,
+                      std::size_t first_row_block) {
+    const std::size_t out_bytes = rows / 8;
+    for (std::size_t rb = first_row_block; rb < out_bytes; ++rb)
+        for (std::size_t cb = 0; cb < row_bytes; ++cb)
+            transpose_block(in, row_bytes, out_bytes, rb, cb, out);
+}
+
+#ifdef STREAMS_X86_DISPATCH
+
+/**
+ * Loads 16 rows of 16 bytes and transposes them as a byte matrix. Register k of the result holds
+ * byte column k of the rows in reversed order within each group of 8 rows, which puts the first
+ * row of a group into the most significant bit of the movemask result.
+ */
+STREAMS_TARGET("sse2")
+inline __attribute__((always_inline)) void load_transposed_16x16(const std::uint8_t *src, std::size_t row_bytes, __m128i *r) {
+    __m128i a[16];
+    for (int k = 0; k < 16; ++k) {
+        const int row = (k & 8) | (7 - (k & 7));
+        a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + std::size_t(row) * row_bytes));
+    }
+
+    __m128i b[16];
+    for (int k = 0; k < 8; ++k) {
+        b[2 * k] = _mm_unpacklo_epi8(a[2 * k], a[2 * k + 1]);
+        b[2 * k + 1] = _mm_unpackhi_epi8(a[2 * k], a[2 * k + 1]);
+    }
+    for (int k = 0; k < 4; ++k) {
+        for (int h = 0; h < 2; ++h) {
+            a[4 * k + h] = _mm_unpacklo_epi16(b[4 * k + h], b[4 * k + h + 2]);
+            a[4 * k + h + 2] = _mm_unpackhi_epi16(b[4 * k + h], b[4 * k + h + 2]);
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        for (int h = 0; h < 4; ++h) {
+            b[8 * k + h] = _mm_unpacklo_epi32(a[8 * k + h], a[8 * k + h + 4]);
+            b[8 * k + h + 4] = _mm_unpackhi_epi32(a[8 * k + h], a[8 * k + h + 4]);
+        }
+    }
+    for (int h = 0; h < 8; ++h) {
+        a[h] = _mm_unpacklo_epi64(b[h], b[h + 8]);
+        a[h + 8] = _mm_unpackhi_epi64(b[h], b[h + 8]);
+    }
+
+    // after the four rounds byte column c sits in register with index of bits of c reversed
+    for (int c = 0; c < 16; ++c) {
+        const int idx = ((c & 1) << 3) | ((c & 2) << 1) | ((c & 4) >> 1) | ((c & 8) >> 3);
+        r[c] = a[idx];
+    }
+}
+
+/**
+ * Output of the SIMD kernels is collected in a tile of 128 rows (one group of 16 input byte
+ * columns) and 128 bytes, so that every row of the output is written two cache lines at a time.
+ * Writing the strided output directly makes the rows, whose distance is a large power of two,
+ * evict each other from the cache. Whole aligned tile rows bypass the cache with streaming
+ * stores, the output is not read again by the transposition and the lines would only push the
+ * input out.
+ */
+constexpr std::size_t tile_rows = 128;
+constexpr std::size_t tile_bytes = 128;
+
+STREAMS_TARGET("sse2")
+void store_tile(const std::uint8_t (*tile)[tile_bytes],
+                std::size_t width,
+                std::uint8_t *out,
+                std::size_t out_bytes) {
+    if (width == tile_bytes && (reinterpret_cast<std::uintptr_t>(out) | out_bytes) % 64 == 0) {
+        for (std::size_t r = 0; r < tile_rows; ++r, out += out_bytes) {
+            const auto *src = reinterpret_cast<const __m128i *>(tile[r]);
+            auto *dst = reinterpret_cast<__m128i *>(out);
+            for (std::size_t k = 0; k < tile_bytes / 16; ++k)
+                _mm_stream_si128(dst + k, _mm_load_si128(src + k));
+        }
+        return;
+    }
+    for (std::size_t r = 0; r < tile_rows; ++r, out += out_bytes)
+        std::memcpy(out, tile[r], width);
+}
+
+/**
+ * Transposes the byte columns which do not fill a whole group of 16 with the scalar kernel
+ */
+void transpose_column_tail(const std::uint8_t *in,
+                           std::size_t row_bytes,
+                           std::size_t out_bytes,
+                           std::size_t row_blocks,
+                           std::uint8_t *out) {
+    for (std::size_t rb = 0; rb < row_blocks; ++rb)
+        for (std::size_t cb = row_bytes / 16 * 16; cb < row_bytes; ++cb)
+            transpose_block(in, row_bytes, out_bytes, rb, cb, out);
+}
+
+STREAMS_TARGET("sse2")
+void transpose_sse2(const std::uint8_t *in,
+                    std::size_t rows,
+                    std::size_t row_bytes,
+                    std::uint8_t *out,
+                    std::size_t &done_row_blocks) {
+    const std::size_t out_bytes = rows / 8;
+    const std::size_t simd_bytes = rows / 16 * 2;
+    alignas(64) std::uint8_t tile[tile_rows][tile_bytes];
+
+    for (std::size_t first = 0; first < simd_bytes; first += tile_bytes) {
+        const std::size_t width = std::min(tile_bytes, simd_bytes - first);
+
+        for (std::size_t cg = 0; cg < row_bytes / 16; ++cg) {
+            for (std::size_t offset = 0; offset < width; offset += 2) {
+                __m128i columns[16];
+                const std::size_t row = 8 * (first + offset);
+                load_transposed_16x16(in + row * row_bytes + 16 * cg, row_bytes, columns);
+
+                for (std::size_t c = 0; c < 16; ++c) {
+                    __m128i v = columns[c];
+                    for (std::size_t bit = 0; bit < 8; ++bit) {
+                        // x86 is little endian, the first group of 8 rows goes to the first byte
+                        const auto mask = std::uint16_t(_mm_movemask_epi8(v));
+                        std::memcpy(&tile[8 * c + bit][offset], &mask, sizeof(mask));
+                        v = _mm_add_epi8(v, v);
+                    }
+                }
+            }
+            store_tile(tile, width, out + 128 * cg * out_bytes + first, out_bytes);
+        }
+    }
+    transpose_column_tail(in, row_bytes, out_bytes, simd_bytes, out);
+    done_row_blocks = simd_bytes;
+}
+
+/**
+ * Like load_transposed_16x16, with rows 16 to 31 in the upper lane of every register. The unpacks
+ * do not cross the lanes, so 32 rows take the same instructions as 16.
+ */
+STREAMS_TARGET("avx2")
+inline __attribute__((always_inline)) void
+load_transposed_32x16(const std::uint8_t *src, std::size_t row_bytes, __m256i *r) {
+    __m256i a[16];
+    for (int k = 0; k < 16; ++k) {
+        const std::size_t row = std::size_t((k & 8) | (7 - (k & 7)));
+        const __m128i lo =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + row * row_bytes));
+        const __m128i hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (row + 16) * row_bytes));
+        a[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+
+    __m256i b[16];
+    for (int k = 0; k < 8; ++k) {
+        b[2 * k] = _mm256_unpacklo_epi8(a[2 * k], a[2 * k + 1]);
+        b[2 * k + 1] = _mm256_unpackhi_epi8(a[2 * k], a[2 * k + 1]);
+    }
+    for (int k = 0; k < 4; ++k) {
+        for (int h = 0; h < 2; ++h) {
+            a[4 * k + h] = _mm256_unpacklo_epi16(b[4 * k + h], b[4 * k + h + 2]);
+            a[4 * k + h + 2] = _mm256_unpackhi_epi16(b[4 * k + h], b[4 * k + h + 2]);
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        for (int h = 0; h < 4; ++h) {
+            b[8 * k + h] = _mm256_unpacklo_epi32(a[8 * k + h], a[8 * k + h + 4]);
+            b[8 * k + h + 4] = _mm256_unpackhi_epi32(a[8 * k + h], a[8 * k + h + 4]);
+        }
+    }
+    for (int h = 0; h < 8; ++h) {
+        a[h] = _mm256_unpacklo_epi64(b[h], b[h + 8]);
+        a[h + 8] = _mm256_unpackhi_epi64(b[h], b[h + 8]);
+    }
+
+    for (int c = 0; c < 16; ++c) {
+        const int idx = ((c & 1) << 3) | ((c & 2) << 1) | ((c & 4) >> 1) | ((c & 8) >> 3);
+        r[c] = a[idx];
+    }
+}
+
+STREAMS_TARGET("avx2")
+void transpose_avx2(const std::uint8_t *in,
+                    std::size_t rows,
+                    std::size_t row_bytes,
+                    std::uint8_t *out,
+                    std::size_t &done_row_blocks) {
+    const std::size_t out_bytes = rows / 8;
+    const std::size_t simd_bytes = rows / 64 * 8;
+    alignas(64) std::uint8_t tile[tile_rows][tile_bytes];
+
+    for (std::size_t first = 0; first < simd_bytes; first += tile_bytes) {
+        const std::size_t width = std::min(tile_bytes, simd_bytes - first);
+
+        for (std::size_t cg = 0; cg < row_bytes / 16; ++cg) {
+            // 64 rows per step, every row of the tile gets 8 bytes at once
+            for (std::size_t offset = 0; offset < width; offset += 8) {
+                __m256i lo[16];
+                __m256i hi[16];
+                const std::uint8_t *src = in + 8 * (first + offset) * row_bytes + 16 * cg;
+                load_transposed_32x16(src, row_bytes, lo);
+                load_transposed_32x16(src + 32 * row_bytes, row_bytes, hi);
+
+                for (std::size_t c = 0; c < 16; ++c) {
+                    __m256i u = lo[c];
+                    __m256i v = hi[c];
+                    for (std::size_t bit = 0; bit < 8; ++bit) {
+                        const std::uint64_t mask =
+                            std::uint64_t(std::uint32_t(_mm256_movemask_epi8(u))) |
+                            std::uint64_t(std::uint32_t(_mm256_movemask_epi8(v))) << 32;
+                        std::memcpy(&tile[8 * c + bit][offset], &mask, sizeof(mask));
+                        u = _mm256_add_epi8(u, u);
+                        v = _mm256_add_epi8(v, v);
+                    }
+                }
+            }
+            store_tile(tile, width, out + 128 * cg * out_bytes + first, out_bytes);
+        }
+    }
+    transpose_column_tail(in, row_bytes, out_bytes, simd_bytes, out);
+    done_row_blocks = simd_bytes;
+}
+
+#endif
+
+} // namespace
+
+void transpose(const std::uint8_t *in,
+               std::size_t rows,
+               std::size_t row_bytes,
+               std::uint8_t *out,
+               bool use_simd) {
+    if (rows % 8 != 0)
+        throw std::runtime_error("bit matrix transposition needs a multiple of 8 rows");
+
+    std::size_t done_row_blocks = 0;
+#ifdef STREAMS_X86_DISPATCH
+    if (use_simd && simd::has_avx2())
+        transpose_avx2(in, rows, row_bytes, out, done_row_blocks);
+    else if (use_simd && simd::has_sse2())
+        transpose_sse2(in, rows, row_bytes, out, done_row_blocks);
+    // orders the streaming stores before the following ones
+    if (done_row_blocks != 0)
+        _mm_sfence();
+#else
+    (void)use_simd;
+#endif
+    transpose_scalar(in, rows, row_bytes, out, done_row_blocks);
+}
+
+} // namespace bit_transpose
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Transposition of bit matrices stored row by row, the most significant bit of a byte first.
+ */
+namespace bit_transpose {
+
+/**
+ * @brief Transposes a rows x (8 * row_bytes) bit matrix
+ *
+ * Row j of the output is column j of the input and holds rows / 8 bytes. The matrix is processed
+ * in 8x8 bit blocks; the SSE2 and AVX2 kernels transpose 16x16 bytes in registers and extract
+ * the bits with movemask, the scalar kernel works on one 64 bit word per block. All kernels
+ * produce the same bytes. The SIMD kernels write output aligned to 64 bytes with streaming stores.
+ *
+ * @param rows number of input rows, has to be a multiple of 8
+ * @param use_simd selects the best kernel supported by the CPU
+ */
+void transpose(const std::uint8_t *in,
+               std::size_t rows,
+               std::size_t row_bytes,
+               std::uint8_t *out,
+               bool use_simd = true);
+
+} // namespace bit_transpose
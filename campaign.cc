@@ -0,0 +1,190 @@
+#include "campaign.h"
+#include "generator.h"
+#include "work_stealing_pool.h"
+
+#include <eacirc-core/logger.h>
+
+#include <chrono>
+#include <fstream>
+#include <glob.h>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+std::string directory_of(const std::string &path) {
+    const auto slash = path.rfind('/');
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+json load_json(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("can't open config file " + path);
+    return json::parse(file);
+}
+
+std::vector<std::string> expand_glob(const std::string &pattern) {
+    glob_t matches;
+    const int status = glob(pattern.c_str(), 0, nullptr, &matches);
+    if (status == GLOB_NOMATCH)
+        throw std::runtime_error("no campaign config matches " + pattern);
+    if (status != 0)
+        throw std::runtime_error("cannot expand campaign configs " + pattern);
+
+    std::vector<std::string> paths(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+    return paths;
+}
+
+/**
+ * The node the parameters are swept on, found the same way as the default output file name
+ */
+json &algorithm_node(json &config) {
+    json *node = &config.at("stream");
+    while (node->find("algorithm") == node->end())
+        node = &node->at("source");
+    return *node;
+}
+
+std::uint64_t file_size(const std::string &name) {
+    std::ifstream file(name, std::ios::binary | std::ios::ate);
+    return file ? std::uint64_t(file.tellg()) : 0;
+}
+
+} // namespace
+
+campaign::campaign(const std::string &path)
+    : campaign(load_json(path), directory_of(path)) {}
+
+campaign::campaign(const json &config, const std::string &base_dir)
+    : _threads(config.value("threads", std::size_t(0)))
+    , _manifest(config.value("manifest", std::string("campaign_manifest.json"))) {
+    auto configs_it = config.find("configs");
+    if (configs_it != config.end())
+        add_configs(*configs_it, base_dir);
+    auto sweep_it = config.find("sweep");
+    if (sweep_it != config.end())
+        add_sweep(*sweep_it);
+
+    if (_jobs.empty())
+        throw std::runtime_error("campaign has no configs");
+    for (job &j : _jobs) {
+        if (j.config.value("stdout", false))
+            throw std::runtime_error("campaign config " + j.name +
+                                     " writes to the standard output");
+        if (config.find("cache") != config.end() && j.config.find("cache") == j.config.end())
+            j.config["cache"] = config.at("cache");
+    }
+
+    // the configs run at once, a file written by two of them would hold either output
+    std::map<std::string, const job *> writers;
+    for (const job &j : _jobs) {
+        for (const std::string &name : generator::output_names(j.config)) {
+            const auto inserted = writers.emplace(name, &j);
+            if (!inserted.second)
+                throw std::runtime_error("campaign configs " + inserted.first->second->name +
+                                         " and " + j.name + " both write " + name +
+                                         ", give them different file names");
+        }
+    }
+}
+
+void campaign::add_configs(const json &patterns, const std::string &base_dir) {
+    for (const std::string pattern : patterns) {
+        const std::string full =
+            pattern.empty() || pattern[0] == '/' ? pattern : base_dir + "/" + pattern;
+        for (const std::string &path : expand_glob(full))
+            _jobs.push_back({path, load_json(path)});
+    }
+}
+
+void campaign::add_sweep(const json &sweep) {
+    const json &base = sweep.at("template");
+    if (base.find("file_name") != base.end())
+        throw std::runtime_error("sweep template cannot set the file_name of all its configs");
+
+    std::vector<std::pair<std::string, std::vector<json>>> parameters;
+    for (auto it = sweep.at("parameters").begin(); it != sweep.at("parameters").end(); ++it) {
+        parameters.emplace_back(it.key(), std::vector<json>(it->begin(), it->end()));
+        if (parameters.back().second.empty())
+            return; // no combinations
+    }
+
+    // odometer over the parameter values, the last parameter changes fastest
+    std::vector<std::size_t> index(parameters.size(), 0);
+    for (;;) {
+        json config = base;
+        json &node = algorithm_node(config);
+        std::string name;
+        for (std::size_t i = 0; i < parameters.size(); ++i) {
+            const json &value = parameters[i].second[index[i]];
+            node[parameters[i].first] = value;
+            name += (i == 0 ? "" : ",") + parameters[i].first + "=" + value.dump();
+        }
+        _jobs.push_back({name, config});
+
+        std::size_t i = parameters.size();
+        for (; i != 0 && ++index[i - 1] == parameters[i - 1].second.size(); --i)
+            index[i - 1] = 0;
+        if (i == 0)
+            break;
+    }
+}
+
+void campaign::run() {
+    std::unique_ptr<work_stealing_pool> own_pool;
+    if (_threads != 0)
+        own_pool = std::make_unique<work_stealing_pool>(_threads - 1);
+    work_stealing_pool &pool = own_pool ? *own_pool : work_stealing_pool::shared();
+    logger::info() << "campaign of " << _jobs.size() << " configs on " << pool.size() + 1
+                   << " threads" << std::endl;
+
+    std::vector<json> results(_jobs.size());
+    const auto start = std::chrono::steady_clock::now();
+
+    pool.parallel_for(_jobs.size(), [&](std::size_t i) {
+        json &result = results[i];
+        result["config"] = _jobs[i].name;
+
+        const auto job_start = std::chrono::steady_clock::now();
+        try {
+            generator g(_jobs[i].config);
+            g.generate();
+
+            result["outputs"] = json::array();
+            for (const std::string &name : g.outputs())
+                result["outputs"].push_back({{"file", name}, {"size", file_size(name)}});
+
+            if (_jobs[i].config.find("cache") != _jobs[i].config.end()) {
+                const dataset_cache::statistics &cache = g.cache_statistics();
+                result["cache"] = {{"hits", cache.hits},
+                                   {"extended", cache.extended},
+                                   {"misses", cache.misses},
+                                   {"reused_bytes", cache.reused_bytes},
+                                   {"generated_bytes", cache.generated_bytes}};
+            }
+        } catch (std::exception &e) {
+            result["error"] = e.what();
+            logger::error("campaign config " + _jobs[i].name + " failed: " + e.what());
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - job_start;
+        result["seconds"] = elapsed.count();
+    });
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t failed = 0;
+    for (const json &result : results)
+        failed += result.find("error") != result.end();
+
+    const json manifest = {{"configs", results},
+                           {"threads", pool.size() + 1},
+                           {"seconds", elapsed.count()},
+                           {"failed", failed}};
+    std::ofstream(_manifest) << manifest.dump(4) << std::endl;
+
+    if (failed != 0)
+        throw std::runtime_error(std::to_string(failed) + " of " + std::to_string(_jobs.size()) +
+                                 " campaign configs failed, see " + _manifest);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <eacirc-core/json.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs many generator configs in one process, on a work-stealing thread pool
+ *
+ * The campaign file is an object with any of
+ *  - "configs": paths or glob patterns of generator configs, relative to the campaign file,
+ *  - "sweep": {"template": generator config, "parameters": {name: [values]}}, one config for
+ *    every combination of the parameter values, set on the stream node with the "algorithm"
+ *    (for example "algorithm", "round" and "block_size"),
+ *  - "threads": number of configs run at once, all hardware threads by default, 1 runs them one
+ *    after another on the calling thread,
+ *  - "manifest": file receiving the outputs, their sizes and the timings of every config,
+ *    "campaign_manifest.json" by default,
+ *  - "cache": dataset cache directory of the configs which do not set their own.
+ *
+ * Configs writing the same file are rejected when the campaign is built, including swept configs
+ * which differ only in parameters outside the default file name (algorithm, round and block size).
+ *
+ * Without "threads" the configs run on the pool shared with the parallel streams (e.g. tuples
+ * with "parallel"). A thread waiting for such a stream runs only its tasks, never another config.
+ *
+ * A failing config does not stop the others, its error is recorded in the manifest and run
+ * throws after all configs finished.
+ */
+struct campaign {
+    explicit campaign(const std::string &path);
+
+    campaign(const json &config, const std::string &base_dir);
+
+    void run();
+
+    std::size_t size() const { return _jobs.size(); }
+
+private:
+    struct job {
+        std::string name; // config path or the swept parameters
+        json config;
+    };
+
+    void add_configs(const json &patterns, const std::string &base_dir);
+    void add_sweep(const json &sweep);
+
+    std::vector<job> _jobs;
+    std::size_t _threads;
+    std::string _manifest;
+};
@@ -0,0 +1,414 @@
+#include "combinators.h"
+#include "simd.h"
+#include "streams.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace combine {
+
+namespace {
+
+std::uint64_t load_word(const value_type *in, std::size_t bytes) {
+    std::uint64_t word = 0;
+    for (std::size_t j = 0; j < bytes; ++j)
+        word |= std::uint64_t(in[j]) << (8 * j);
+    return word;
+}
+
+void store_word(value_type *out, std::uint64_t word, std::size_t bytes) {
+    for (std::size_t j = 0; j < bytes; ++j)
+        out[j] = value_type(word >> (8 * j));
+}
+
+void accumulate_scalar(operation op,
+                       std::size_t word_size,
+                       value_type *acc,
+                       const value_type *in,
+                       std::size_t n) {
+    switch (op) {
+    case operation::xor_op:
+        for (std::size_t i = 0; i < n; ++i)
+            acc[i] ^= in[i];
+        break;
+    case operation::and_op:
+        for (std::size_t i = 0; i < n; ++i)
+            acc[i] &= in[i];
+        break;
+    case operation::or_op:
+        for (std::size_t i = 0; i < n; ++i)
+            acc[i] |= in[i];
+        break;
+    case operation::add:
+        for (std::size_t i = 0; i < n; i += word_size)
+            store_word(acc + i, load_word(acc + i, word_size) + load_word(in + i, word_size),
+                       word_size);
+        break;
+    }
+}
+
+void rotate_scalar(value_type *data, std::size_t n, std::size_t word_size, unsigned shift) {
+    const unsigned bits = unsigned(8 * word_size);
+    const std::uint64_t mask = bits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+    for (std::size_t i = 0; i < n; i += word_size) {
+        const std::uint64_t word = load_word(data + i, word_size);
+        store_word(data + i, ((word << shift) | (word >> (bits - shift))) & mask, word_size);
+    }
+}
+
+std::uint64_t pext_scalar(std::uint64_t x, std::uint64_t mask) {
+    std::uint64_t result = 0;
+    for (std::uint64_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1)
+        if (x & mask & (~mask + 1))
+            result |= bit;
+    return result;
+}
+
+/**
+ * Appends groups of up to 64 bits to a little endian bit string
+ */
+struct bit_writer {
+    explicit bit_writer(value_type *out)
+        : _out(out)
+        , _acc(0)
+        , _bits(0) {}
+
+    void push(std::uint64_t value, unsigned bits) {
+        if (bits == 0)
+            return;
+        _acc |= value << _bits;
+        if (_bits + bits >= 64) {
+            store_word(_out, _acc, 8);
+            _out += 8;
+            _acc = _bits == 0 ? 0 : value >> (64 - _bits);
+            _bits = _bits + bits - 64;
+        } else {
+            _bits += bits;
+        }
+    }
+
+    void flush() { store_word(_out, _acc, (_bits + 7) / 8); }
+
+private:
+    value_type *_out;
+    std::uint64_t _acc;
+    unsigned _bits;
+};
+
+#ifdef STREAMS_X86_DISPATCH
+
+template <operation Op, std::size_t WordSize>
+STREAMS_TARGET("avx2")
+std::size_t accumulate_avx2(value_type *acc, const value_type *in, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i *p = reinterpret_cast<__m256i *>(acc + i);
+        const __m256i a = _mm256_loadu_si256(p);
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        // Op and WordSize are constants, the branches fold away
+        if (Op == operation::xor_op)
+            _mm256_storeu_si256(p, _mm256_xor_si256(a, b));
+        else if (Op == operation::and_op)
+            _mm256_storeu_si256(p, _mm256_and_si256(a, b));
+        else if (Op == operation::or_op)
+            _mm256_storeu_si256(p, _mm256_or_si256(a, b));
+        else if (WordSize == 1)
+            _mm256_storeu_si256(p, _mm256_add_epi8(a, b));
+        else if (WordSize == 2)
+            _mm256_storeu_si256(p, _mm256_add_epi16(a, b));
+        else if (WordSize == 4)
+            _mm256_storeu_si256(p, _mm256_add_epi32(a, b));
+        else
+            _mm256_storeu_si256(p, _mm256_add_epi64(a, b));
+    }
+    return i;
+}
+
+std::size_t accumulate_avx2(operation op,
+                            std::size_t word_size,
+                            value_type *acc,
+                            const value_type *in,
+                            std::size_t n) {
+    switch (op) {
+    case operation::xor_op:
+        return accumulate_avx2<operation::xor_op, 1>(acc, in, n);
+    case operation::and_op:
+        return accumulate_avx2<operation::and_op, 1>(acc, in, n);
+    case operation::or_op:
+        return accumulate_avx2<operation::or_op, 1>(acc, in, n);
+    case operation::add:
+        switch (word_size) {
+        case 1:
+            return accumulate_avx2<operation::add, 1>(acc, in, n);
+        case 2:
+            return accumulate_avx2<operation::add, 2>(acc, in, n);
+        case 4:
+            return accumulate_avx2<operation::add, 4>(acc, in, n);
+        default:
+            return accumulate_avx2<operation::add, 8>(acc, in, n);
+        }
+    }
+    return 0;
+}
+
+STREAMS_TARGET("avx2")
+std::size_t rotate_avx2(value_type *data, std::size_t n, std::size_t word_size, unsigned shift) {
+    const __m128i left = _mm_cvtsi32_si128(int(shift));
+    const __m128i right = _mm_cvtsi32_si128(int(8 * word_size - shift));
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i *p = reinterpret_cast<__m256i *>(data + i);
+        const __m256i v = _mm256_loadu_si256(p);
+        switch (word_size) {
+        case 2:
+            _mm256_storeu_si256(
+                p, _mm256_or_si256(_mm256_sll_epi16(v, left), _mm256_srl_epi16(v, right)));
+            break;
+        case 4:
+            _mm256_storeu_si256(
+                p, _mm256_or_si256(_mm256_sll_epi32(v, left), _mm256_srl_epi32(v, right)));
+            break;
+        default:
+            _mm256_storeu_si256(
+                p, _mm256_or_si256(_mm256_sll_epi64(v, left), _mm256_srl_epi64(v, right)));
+            break;
+        }
+    }
+    return i;
+}
+
+STREAMS_TARGET("bmi2")
+void extract_bmi2(const std::vector<std::uint64_t> &mask,
+                  std::size_t size,
+                  const value_type *in,
+                  value_type *out) {
+    bit_writer writer(out);
+    for (std::size_t i = 0; i < mask.size(); ++i) {
+        const std::uint64_t x = load_word(in + 8 * i, std::min<std::size_t>(8, size - 8 * i));
+        writer.push(_pext_u64(x, mask[i]), unsigned(__builtin_popcountll(mask[i])));
+    }
+    writer.flush();
+}
+
+#endif
+
+} // namespace
+
+void accumulate(operation op,
+                std::size_t word_size,
+                value_type *acc,
+                const value_type *in,
+                std::size_t n,
+                bool use_simd) {
+    std::size_t done = 0;
+#ifdef STREAMS_X86_DISPATCH
+    if (use_simd && simd::has_avx2())
+        done = accumulate_avx2(op, word_size, acc, in, n);
+#else
+    (void)use_simd;
+#endif
+    accumulate_scalar(op, word_size, acc + done, in + done, n - done);
+}
+
+void rotate(value_type *data, std::size_t n, std::size_t word_size, unsigned shift, bool use_simd) {
+    shift %= unsigned(8 * word_size);
+    if (shift == 0)
+        return;
+
+    std::size_t done = 0;
+#ifdef STREAMS_X86_DISPATCH
+    if (use_simd && word_size > 1 && simd::has_avx2())
+        done = rotate_avx2(data, n, word_size, shift);
+#else
+    (void)use_simd;
+#endif
+    rotate_scalar(data + done, n - done, word_size, shift);
+}
+
+bit_select::bit_select(const std::vector<value_type> &mask)
+    : _size(mask.size())
+    , _count(0) {
+    for (std::size_t i = 0; i < mask.size(); i += 8) {
+        _mask.push_back(load_word(mask.data() + i, std::min<std::size_t>(8, mask.size() - i)));
+        _count += std::size_t(__builtin_popcountll(_mask.back()));
+    }
+}
+
+void bit_select::extract(const value_type *in, value_type *out, bool use_simd) const {
+#ifdef STREAMS_X86_DISPATCH
+    if (use_simd && simd::has_bmi2()) {
+        extract_bmi2(_mask, _size, in, out);
+        return;
+    }
+#else
+    (void)use_simd;
+#endif
+    bit_writer writer(out);
+    for (std::size_t i = 0; i < _mask.size(); ++i) {
+        const std::uint64_t x = load_word(in + 8 * i, std::min<std::size_t>(8, _size - 8 * i));
+        writer.push(pext_scalar(x, _mask[i]), unsigned(__builtin_popcountll(_mask[i])));
+    }
+    writer.flush();
+}
+
+} // namespace combine
+
+namespace {
+
+std::vector<value_type> parse_mask(const std::string &hex) {
+    if (hex.size() % 2 != 0)
+        throw std::runtime_error("select mask needs an even number of hexadecimal digits");
+
+    std::vector<value_type> mask;
+    for (std::size_t i = 0; i < hex.size(); i += 2)
+        mask.push_back(value_type(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    return mask;
+}
+
+} // namespace
+
+combinator_stream::combinator_stream(
+    const json &config,
+    default_seed_source &seeder,
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+    const std::size_t osize)
+    : stream(osize)
+    , _operation(combine::operation::xor_op)
+    , _word_size(config.value("word_size", std::size_t(1)))
+    , _shift(config.value("shift", 0u))
+    , _selected_pos(0) {
+    const std::string operation = config.at("operation");
+    if (_word_size != 1 && _word_size != 2 && _word_size != 4 && _word_size != 8)
+        throw std::runtime_error("combinator word_size has to be 1, 2, 4 or 8 bytes");
+
+    std::size_t source_size = osize;
+    if (operation == "select") {
+        _kind = kind::select;
+        const std::vector<value_type> mask = parse_mask(config.at("mask"));
+        _select = std::make_unique<combine::bit_select>(mask);
+        if (_select->count() == 0)
+            throw std::runtime_error("select mask has no bits set");
+        source_size = mask.size();
+        _selected.resize(_select->count() / 8 + 16);
+        _selected_pos = _select->count();
+    } else if (operation == "rotate") {
+        _kind = kind::rotate;
+    } else {
+        _kind = kind::accumulate;
+        if (operation == "xor")
+            _operation = combine::operation::xor_op;
+        else if (operation == "and")
+            _operation = combine::operation::and_op;
+        else if (operation == "or")
+            _operation = combine::operation::or_op;
+        else if (operation == "add")
+            _operation = combine::operation::add;
+        else
+            throw std::runtime_error("requested combinator operation \"" + operation +
+                                     "\" does not exist");
+    }
+    if (_kind != kind::select && osize % _word_size != 0)
+        throw std::runtime_error("combinator output size has to be a multiple of word_size");
+
+    for (const json &source : config.at("sources"))
+        _sources.push_back(make_stream(source, seeder, pipes, source_size));
+    if (_sources.empty())
+        throw std::runtime_error("combinator needs at least one source");
+    if (_kind != kind::accumulate && _sources.size() != 1)
+        throw std::runtime_error("combinator operation \"" + operation + "\" takes one source");
+}
+
+vec_cview combinator_stream::next() {
+    switch (_kind) {
+    case kind::accumulate: {
+        set_data(_sources[0]->next());
+        for (std::size_t i = 1; i < _sources.size(); ++i)
+            combine::accumulate(_operation, _word_size, _data.data(), &*_sources[i]->next().begin(),
+                                osize());
+        break;
+    }
+    case kind::rotate:
+        set_data(_sources[0]->next());
+        combine::rotate(_data.data(), osize(), _word_size, _shift);
+        break;
+    case kind::select:
+        next_selected();
+        break;
+    }
+    return make_cview(_data);
+}
+
+void combinator_stream::next_batch(value_type *out, std::size_t count) {
+    if (_kind == kind::select) {
+        stream::next_batch(out, count);
+        return;
+    }
+
+    // whole batches of the sources are combined by one kernel call
+    const std::size_t n = count * osize();
+    _sources[0]->next_batch(out, count);
+    if (_kind == kind::rotate) {
+        combine::rotate(out, n, _word_size, _shift);
+        return;
+    }
+    _scratch.resize(n);
+    for (std::size_t i = 1; i < _sources.size(); ++i) {
+        _sources[i]->next_batch(_scratch.data(), count);
+        combine::accumulate(_operation, _word_size, out, _scratch.data(), n);
+    }
+}
+
+bool combinator_stream::seekable() const {
+    return std::all_of(_sources.begin(), _sources.end(), [](const std::unique_ptr<stream> &source) {
+        return source->seekable();
+    });
+}
+
+void combinator_stream::skip(const std::uint64_t count) {
+    if (_kind != kind::select) {
+        for (auto &source : _sources)
+            source->skip(count);
+        return;
+    }
+
+    const std::uint64_t selected = _select->count();
+    std::uint64_t bits = count * osize() * 8;
+    const std::uint64_t carried = std::min<std::uint64_t>(bits, selected - _selected_pos);
+    _selected_pos += std::size_t(carried);
+    bits -= carried;
+
+    if (bits != 0) {
+        // the last of the source vectors covering the bits is extracted, its rest is carried
+        _sources[0]->skip((bits - 1) / selected);
+        _select->extract(&*_sources[0]->next().begin(), _selected.data());
+        _selected_pos = std::size_t((bits - 1) % selected + 1);
+    }
+}
+
+void combinator_stream::next_selected() {
+    const std::size_t selected = _select->count();
+    const std::size_t out_bits = osize() * 8;
+
+    std::uint64_t acc = 0;
+    unsigned acc_bits = 0;
+    std::size_t written = 0; // bytes of _data
+    while (8 * written + acc_bits < out_bits) {
+        if (_selected_pos == selected) {
+            _select->extract(&*_sources[0]->next().begin(), _selected.data());
+            _selected_pos = 0;
+        }
+
+        // at most 56 bits, so that they fit next to the unwritten bits
+        const std::size_t take = std::min<std::size_t>(
+            {56, selected - _selected_pos, out_bits - 8 * written - acc_bits});
+        std::uint64_t bits = 0;
+        for (std::size_t j = 0; j < 8; ++j)
+            bits |= std::uint64_t(_selected[_selected_pos / 8 + j]) << (8 * j);
+        bits = (bits >> (_selected_pos % 8)) & ((std::uint64_t(1) << take) - 1);
+        _selected_pos += take;
+
+        acc |= bits << acc_bits;
+        acc_bits += unsigned(take);
+        for (; acc_bits >= 8; acc >>= 8, acc_bits -= 8)
+            _data[written++] = value_type(acc);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "stream.h"
+#include <cstddef>
+#include <cstdint>
+#include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Kernels combining whole vectors, with AVX2 variants selected at runtime. Words are little
+ * endian and the bits of a vector are numbered from the least significant bit of its first byte.
+ */
+namespace combine {
+
+enum class operation { xor_op, and_op, or_op, add };
+
+/**
+ * @brief acc[i] = acc[i] op in[i] for n bytes, addition works on words of word_size bytes
+ */
+void accumulate(operation op,
+                std::size_t word_size,
+                value_type *acc,
+                const value_type *in,
+                std::size_t n,
+                bool use_simd = true);
+
+/**
+ * @brief Rotates each word of word_size bytes left by shift bits
+ */
+void rotate(value_type *data,
+            std::size_t n,
+            std::size_t word_size,
+            unsigned shift,
+            bool use_simd = true);
+
+/**
+ * @brief Extracts the bits selected by a mask and packs them, like the BMI2 pext instruction
+ */
+struct bit_select {
+    explicit bit_select(const std::vector<value_type> &mask);
+
+    /**
+     * Packs the selected bits of in (mask-sized) to out, which has room for count() bits plus
+     * 8 bytes
+     */
+    void extract(const value_type *in, value_type *out, bool use_simd = true) const;
+
+    std::size_t count() const { return _count; }
+
+private:
+    std::vector<std::uint64_t> _mask;
+    std::size_t _size;
+    std::size_t _count;
+};
+
+} // namespace combine
+
+/**
+ * @brief Stream combining its "sources" by "operation"
+ *
+ * Operations "xor", "and", "or" and "add" (modulo 2^(8 * "word_size"), default 1 byte) combine any
+ * number of sources of the output size. "rotate" rotates the words of its single source left by
+ * "shift" bits. "select" packs the bits of its single source chosen by the hexadecimal "mask"
+ * (the source vectors have the size of the mask) and fills the output with them, carrying the
+ * remaining selected bits to the following vector.
+ */
+struct combinator_stream : stream {
+    combinator_stream(
+        const json &config,
+        default_seed_source &seeder,
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+        const std::size_t osize);
+
+    vec_cview next() override;
+
+    void next_batch(value_type *out, std::size_t count) override;
+
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override;
+
+private:
+    void next_selected();
+
+    enum class kind { accumulate, rotate, select };
+
+    kind _kind;
+    combine::operation _operation;
+    std::size_t _word_size;
+    unsigned _shift;
+    std::unique_ptr<combine::bit_select> _select;
+
+    std::vector<std::unique_ptr<stream>> _sources;
+    std::vector<value_type> _scratch;
+
+    std::vector<value_type> _selected; // packed selected bits of the last source vector
+    std::size_t _selected_pos;         // first unused bit of _selected
+};
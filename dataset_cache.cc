@@ -0,0 +1,189 @@
+#include "dataset_cache.h"
+
+#include <eacirc-core/version.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// FNV-1a, the descriptions are compared in full, so the hash needs no cryptographic strength
+std::uint64_t fnv1a(const char *data, std::size_t size) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char *end = data + size; data != end; ++data) {
+        hash ^= std::uint8_t(*data);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void copy_prefix(const std::string &from, const std::string &to, std::uint64_t size) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+    while (size != 0) {
+        const auto chunk = std::streamsize(std::min<std::uint64_t>(size, buffer.size()));
+        if (!in.read(buffer.data(), chunk))
+            throw std::runtime_error("can't read cached file " + from);
+        out.write(buffer.data(), chunk);
+        size -= std::uint64_t(chunk);
+    }
+    if (!out)
+        throw std::runtime_error("can't write file " + to);
+}
+
+// unique for concurrent runs of a campaign and of several processes
+std::string temporary_suffix() {
+    std::stringstream ss;
+    ss << ".tmp" << ::getpid() << "_" << std::hash<std::thread::id>()(std::this_thread::get_id());
+    return ss.str();
+}
+
+} // namespace
+
+constexpr std::size_t dataset_cache::block_size;
+
+dataset_cache::dataset_cache(std::string dir)
+    : _dir(std::move(dir)) {
+    if (::mkdir(_dir.c_str(), 0777) != 0 && errno != EEXIST)
+        throw std::runtime_error("can't create cache directory " + _dir);
+}
+
+json dataset_cache::description(const json &stream,
+                                const json &seed,
+                                const std::size_t tv_size,
+                                const std::size_t file_index) {
+    return {{"stream", stream},
+            {"seed", seed},
+            {"tv_size", tv_size},
+            {"file", file_index},
+            {"version", VERSION_TAG}};
+}
+
+std::string dataset_cache::path(const json &description, const std::string &suffix) const {
+    const std::string canonical = description.dump();
+    std::stringstream ss;
+    ss << _dir << "/" << std::hex << std::setw(16) << std::setfill('0')
+       << fnv1a(canonical.data(), canonical.size()) << suffix;
+    return ss.str();
+}
+
+template <typename F> void dataset_cache::checksums(const std::string &file, F &&f) {
+    std::ifstream in(file, std::ios::binary);
+    std::vector<char> block(block_size);
+    while (in.read(block.data(), std::streamsize(block.size())) || in.gcount() != 0)
+        f(fnv1a(block.data(), std::size_t(in.gcount())));
+}
+
+std::uint64_t dataset_cache::size(const json &description) const {
+    std::ifstream meta(path(description, ".json"));
+    if (!meta.is_open() || json::parse(meta).at("description") != description)
+        return 0;
+
+    struct stat info;
+    if (::stat(path(description, ".bin").c_str(), &info) != 0)
+        return 0;
+    return std::uint64_t(info.st_size);
+}
+
+dataset_cache::block_checker::block_checker(std::vector<std::uint64_t> checksums,
+                                            const std::uint64_t size)
+    : _checksums(std::move(checksums))
+    , _size(size)
+    , _checked(_checksums.size(), false) {}
+
+std::uint64_t dataset_cache::block_checker::check(const char *data,
+                                                  std::uint64_t begin,
+                                                  const std::uint64_t end) {
+    for (std::size_t block = std::size_t(begin / block_size); begin < end; ++block) {
+        if (!check_block(block, data + block * block_size))
+            return block * std::uint64_t(block_size);
+        begin = (block + 1) * std::uint64_t(block_size);
+    }
+    return end;
+}
+
+bool dataset_cache::block_checker::check_block(const std::size_t block, const char *data) {
+    // blocks beyond the checksums were appended to the data, the checksums of blocks beyond its
+    // end were cut off
+    const std::uint64_t first = block * std::uint64_t(block_size);
+    if (block >= _checksums.size() || first >= _size)
+        return false;
+    if (_checked[block])
+        return true;
+
+    const auto size = std::size_t(std::min<std::uint64_t>(block_size, _size - first));
+    _checked[block] = fnv1a(data, size) == _checksums[block];
+    return _checked[block];
+}
+
+dataset_cache::block_checker dataset_cache::checker(const json &description) const {
+    std::ifstream meta(path(description, ".json"));
+    const std::vector<std::uint64_t> sums = json::parse(meta).at("checksums");
+    return block_checker(sums, size(description));
+}
+
+std::uint64_t dataset_cache::valid_prefix(const json &description, const std::uint64_t size) const {
+    if (size == 0)
+        return 0;
+    block_checker blocks = checker(description);
+    std::ifstream in(path(description, ".bin"), std::ios::binary);
+    std::vector<char> data(block_size);
+    std::uint64_t valid = 0;
+    for (std::size_t block = 0; valid < size; ++block) {
+        in.read(data.data(), std::streamsize(data.size()));
+        if (in.gcount() == 0 || !blocks.check_block(block, data.data()))
+            break;
+        valid += std::uint64_t(in.gcount());
+    }
+    return std::min(valid, size);
+}
+
+void dataset_cache::provide(const json &description,
+                            const std::string &name,
+                            const std::uint64_t size) const {
+    const std::string data = path(description, ".bin");
+    std::remove(name.c_str());
+    if (size == this->size(description) && ::link(data.c_str(), name.c_str()) == 0)
+        return;
+    copy_prefix(data, name, size);
+}
+
+std::string dataset_cache::begin_update(const json &description, const std::uint64_t keep) const {
+    const std::string update = path(description, ".bin" + temporary_suffix());
+    if (keep == 0)
+        std::ofstream(update, std::ios::binary);
+    else
+        copy_prefix(path(description, ".bin"), update, keep);
+    return update;
+}
+
+void dataset_cache::commit_update(const json &description) const {
+    const std::string meta = path(description, ".json");
+    const std::string suffix = temporary_suffix();
+    {
+        json sums = json::array();
+        checksums(path(description, ".bin") + suffix,
+                  [&sums](const std::uint64_t checksum) { sums.push_back(checksum); });
+
+        std::ofstream file(meta + suffix);
+        file << json{{"description", description}, {"checksums", sums}}.dump(4) << std::endl;
+        if (!file)
+            throw std::runtime_error("can't write cache entry " + meta);
+    }
+    // the data first, a description without matching data is never visible
+    if (std::rename((path(description, ".bin") + suffix).c_str(),
+                    path(description, ".bin").c_str()) != 0 ||
+        std::rename((meta + suffix).c_str(), meta.c_str()) != 0)
+        throw std::runtime_error("can't replace cache entry " + meta);
+}
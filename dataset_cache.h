@@ -0,0 +1,122 @@
+#pragma once
+
+#include <eacirc-core/json.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Directory of generated files addressed by a hash of what determines their content
+ *
+ * An entry consists of <key>.bin with the data and <key>.json with the description it was
+ * generated from and FNV-1a checksums of the 1 MiB blocks of the data. The description holds the
+ * stream config, the seed, the size of one vector in the file, the index of the file among the
+ * files of the stream (one per round tap) and the generator version. Objects are compared with
+ * sorted keys, so the order of the config does not matter, and the stored description is compared
+ * on every lookup, so hash collisions only cost a regeneration.
+ *
+ * Entries are replaced by renaming a complete file over them, files provided from the cache
+ * before keep their content.
+ *
+ * The checksums are checked lazily, a block when it is first read (see block_checker), so a reader
+ * of a part of the data hashes only that part. Hardlinked files are not read and not checked.
+ */
+struct dataset_cache {
+    static constexpr std::size_t block_size = std::size_t(1) << 20;
+
+    /**
+     * @brief Counts of one generator run
+     */
+    struct statistics {
+        std::uint64_t hits = 0;     // files served from the cache
+        std::uint64_t extended = 0; // files extending a shorter cached prefix
+        std::uint64_t misses = 0;   // files generated from the start
+        std::uint64_t reused_bytes = 0;
+        std::uint64_t generated_bytes = 0;
+    };
+
+    /**
+     * @brief Checks the blocks of the data of an entry against its checksums, each one only once
+     */
+    class block_checker {
+    public:
+        block_checker() = default;
+        block_checker(std::vector<std::uint64_t> checksums, std::uint64_t size);
+
+        /**
+         * Checks the blocks overlapping the bytes [begin, end) which were not checked before
+         * @param data all data of the entry
+         * @return offset of the first block not matching its checksum, end when all match
+         */
+        std::uint64_t check(const char *data, std::uint64_t begin, std::uint64_t end);
+
+        /**
+         * @param data the bytes of the block, up to block_size of them
+         * @return true when the block matches its checksum
+         */
+        bool check_block(std::size_t block, const char *data);
+
+    private:
+        std::vector<std::uint64_t> _checksums;
+        std::uint64_t _size = 0;
+        std::vector<bool> _checked;
+    };
+
+    explicit dataset_cache(std::string dir);
+
+    static json description(const json &stream,
+                            const json &seed,
+                            std::size_t tv_size,
+                            std::size_t file_index);
+
+    /**
+     * @return size of the cached data of the description, 0 without an entry
+     */
+    std::uint64_t size(const json &description) const;
+
+    /**
+     * @brief Checker of the data of an entry, which has to exist
+     */
+    block_checker checker(const json &description) const;
+
+    /**
+     * @brief Reads and checks the blocks of the first size bytes of the data of an entry, which
+     * has to exist unless size is 0
+     * @return length of the leading matching blocks, at most size
+     */
+    std::uint64_t valid_prefix(const json &description, std::uint64_t size) const;
+
+    /**
+     * @return path of the data of the entry
+     */
+    std::string data_path(const json &description) const { return path(description, ".bin"); }
+
+    /**
+     * @brief Makes the first size bytes of the entry available as the file name
+     *
+     * The whole entry is hardlinked, with a copy as the fallback, a prefix is copied. Writers of
+     * the file have to replace it rather than write it in place (see generator).
+     */
+    void provide(const json &description, const std::string &name, std::uint64_t size) const;
+
+    /**
+     * @brief Starts a new version of the entry with the first keep bytes of the current one
+     * @return path of the file to append the rest of the data to
+     */
+    std::string begin_update(const json &description, std::uint64_t keep) const;
+
+    /**
+     * @brief Replaces the entry with the file returned by begin_update
+     */
+    void commit_update(const json &description) const;
+
+private:
+    std::string path(const json &description, const std::string &suffix) const;
+
+    /**
+     * Feeds the checksums of the blocks of the file to f
+     */
+    template <typename F> static void checksums(const std::string &file, F &&f);
+
+    const std::string _dir;
+};
@@ -0,0 +1,58 @@
+#include "fd_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+fd_reader::fd_reader(const int fd, std::string name, const std::size_t buffer_size)
+    : _fd(fd)
+    , _name(std::move(name))
+    , _buffer(buffer_size)
+    , _pos(0)
+    , _end(0) {
+    if (buffer_size == 0)
+        throw std::runtime_error("buffer of " + _name + " has to hold at least 1 byte");
+}
+
+std::size_t fd_reader::read_some(std::uint8_t *out, const std::size_t size) {
+    for (;;) {
+        const ssize_t got = ::read(_fd, out, size);
+        if (got >= 0)
+            return std::size_t(got);
+        if (errno != EINTR)
+            throw std::runtime_error("I/O error while reading " + _name + ": " +
+                                     std::strerror(errno));
+    }
+}
+
+void fd_reader::read(std::uint8_t *out, std::uint64_t n) {
+    while (n != 0) {
+        if (_pos == _end) {
+            if (out && n >= _buffer.size()) {
+                const std::size_t got =
+                    read_some(out, std::size_t(std::min<std::uint64_t>(n, std::uint64_t(1) << 30)));
+                if (got == 0)
+                    throw std::runtime_error("end of " + _name + " reached, not enough data!");
+                out += got;
+                n -= got;
+                continue;
+            }
+            if (!out && ::lseek(_fd, off_t(n), SEEK_CUR) != -1)
+                return;
+
+            _pos = 0;
+            _end = read_some(_buffer.data(), _buffer.size());
+            if (_end == 0)
+                throw std::runtime_error("end of " + _name + " reached, not enough data!");
+        }
+
+        const auto chunk = std::size_t(std::min<std::uint64_t>(n, _end - _pos));
+        if (out) {
+            std::memcpy(out, _buffer.data() + _pos, chunk);
+            out += chunk;
+        }
+        _pos += chunk;
+        n -= chunk;
+    }
+}
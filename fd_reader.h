@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads a file descriptor, such as a pipe or a device, through a large buffer
+ *
+ * Each refill is one read(2) of up to the buffer size. Requests of at least the buffer size which
+ * start with an empty buffer are read straight into the destination, so batches of vectors are
+ * copied only once. Discarded data are skipped with lseek when the descriptor supports it.
+ */
+struct fd_reader {
+    /**
+     * @param name describes the descriptor in errors
+     */
+    fd_reader(int fd, std::string name, std::size_t buffer_size = std::size_t(1) << 22);
+
+    /**
+     * @brief Reads exactly n bytes, out may be null to discard them
+     *
+     * Throws at the end of the data.
+     */
+    void read(std::uint8_t *out, std::uint64_t n);
+
+private:
+    /**
+     * One read(2) of at most size bytes
+     * @return number of bytes read, 0 at the end of the data
+     */
+    std::size_t read_some(std::uint8_t *out, std::size_t size);
+
+    const int _fd;
+    const std::string _name;
+    std::vector<std::uint8_t> _buffer;
+    std::size_t _pos;
+    std::size_t _end;
+};
@@ -0,0 +1,238 @@
+#include "fd_writer.h"
+#include <eacirc-core/logger.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(F_SETPIPE_SZ) && defined(F_GETPIPE_SZ)
+#define STREAMS_VMSPLICE 1
+#endif
+
+fd_writer::fd_writer(const int fd,
+                     std::string name,
+                     std::size_t buffer_size,
+                     const bool splice)
+    : _fd(fd)
+    , _name(std::move(name))
+    , _page_size(std::size_t(::sysconf(_SC_PAGESIZE)))
+    , _splice(false)
+    , _pipe_pages(0)
+    , _buffer_size(0)
+    , _memory(nullptr)
+    , _current(0)
+    , _full(buffers)
+    , _free(buffers)
+    , _spliced_pages(0)
+    , _spliced_bytes(0)
+    , _written_bytes(0) {
+    if (buffer_size == 0)
+        throw std::runtime_error("buffer of " + _name + " has to hold at least 1 byte");
+
+#ifdef STREAMS_VMSPLICE
+    struct stat info;
+    if (splice && ::fstat(_fd, &info) == 0 && S_ISFIFO(info.st_mode)) {
+        // beyond /proc/sys/fs/pipe-max-size only allowed to privileged processes, the pipe then
+        // keeps its size
+        ::fcntl(_fd, F_SETPIPE_SZ, int(std::min<std::size_t>(buffer_size, INT_MAX)));
+        const int capacity = ::fcntl(_fd, F_GETPIPE_SZ);
+        if (capacity > 0) {
+            _splice = true;
+            _pipe_pages = (std::size_t(capacity) + _page_size - 1) / _page_size;
+            buffer_size = std::max(buffer_size, _pipe_pages * _page_size);
+        }
+    }
+#else
+    (void)splice;
+#endif
+    _buffer_size = (buffer_size + _page_size - 1) / _page_size * _page_size;
+    if (_buffer_size > std::size_t(INT_MAX))
+        throw std::runtime_error("buffer of " + _name + " has to be smaller than 2 GiB");
+
+    // mapped, so the pages still referenced by the pipe are not reused after the destruction
+    void *memory = ::mmap(nullptr,
+                          buffers * _buffer_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1,
+                          0);
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("can't allocate the buffers of " + _name);
+    _memory = static_cast<char *>(memory);
+
+    for (std::size_t i = 1; i < buffers; ++i)
+        release(i);
+    setp(buffer(0), buffer(0) + _buffer_size);
+    _worker = std::thread(&fd_writer::write_out, this);
+}
+
+fd_writer::~fd_writer() {
+    if (_worker.joinable()) {
+        submit(false);
+        _full.close();
+        _worker.join();
+    }
+    ::munmap(_memory, buffers * _buffer_size);
+}
+
+void fd_writer::close() {
+    if (!_worker.joinable())
+        return;
+
+    submit(false);
+    _full.close();
+    _worker.join();
+    if (_error)
+        std::rethrow_exception(_error);
+
+    logger::info() << _name << ": " << _spliced_bytes << " bytes moved with vmsplice, "
+                   << _written_bytes << " bytes written" << std::endl;
+}
+
+bool fd_writer::submit(const bool next) {
+    // only closed by the writer thread, after storing its exception
+    if (_free.closed())
+        return false;
+
+    const auto size = std::size_t(pptr() - pbase());
+    if (size != 0) {
+        chunk *slot = _full.acquire_write();
+        if (slot == nullptr)
+            return false;
+        *slot = {_current, size};
+        _full.commit_write();
+
+        if (!next)
+            return true;
+        const std::size_t *free = _free.acquire_read();
+        if (free == nullptr)
+            return false;
+        _current = *free;
+        _free.release_read();
+    }
+    setp(buffer(_current), buffer(_current) + _buffer_size);
+    return true;
+}
+
+fd_writer::int_type fd_writer::overflow(const int_type ch) {
+    if (!submit(true))
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize fd_writer::xsputn(const char *s, const std::streamsize n) {
+    std::streamsize done = 0;
+    while (done != n) {
+        if (pptr() == epptr() && !submit(true))
+            break;
+        const auto chunk = std::min(n - done, std::streamsize(epptr() - pptr()));
+        std::memcpy(pptr(), s + done, std::size_t(chunk));
+        pbump(int(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+int fd_writer::sync() {
+    return submit(true) ? 0 : -1;
+}
+
+void fd_writer::release(const std::size_t buffer) {
+    // never waits, the ring has a slot for every buffer
+    std::size_t *slot = _free.acquire_write();
+    if (slot == nullptr)
+        return;
+    *slot = buffer;
+    _free.commit_write();
+}
+
+void fd_writer::write_out() {
+    try {
+        for (;;) {
+            const chunk *slot = _full.acquire_read();
+            if (slot == nullptr)
+                return;
+            const chunk current = *slot;
+            _full.release_read();
+
+            const char *data = buffer(current.buffer);
+            // partial buffers would not push the pages of the previous ones out of the pipe
+            const std::size_t moved =
+                _splice && current.size == _buffer_size ? splice(data, current.size) : 0;
+            if (moved == 0) {
+                write(data, current.size);
+                release(current.buffer);
+            } else {
+                write(data + moved, current.size - moved);
+                _in_pipe.emplace_back(current.buffer, _spliced_pages);
+            }
+
+            // the pipe holds at most _pipe_pages pages, the later ones
+            while (!_in_pipe.empty() && _spliced_pages - _in_pipe.front().second >= _pipe_pages) {
+                release(_in_pipe.front().first);
+                _in_pipe.pop_front();
+            }
+        }
+    } catch (...) {
+        _error = std::current_exception();
+        _free.close();
+        _full.close();
+    }
+}
+
+std::size_t fd_writer::splice(const char *data, const std::size_t size) {
+    std::size_t moved = 0;
+#ifdef STREAMS_VMSPLICE
+    while (moved != size) {
+        iovec part = {const_cast<char *>(data + moved), size - moved};
+        const ssize_t got = ::vmsplice(_fd, &part, 1, 0);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EINVAL || errno == ENOSYS || errno == EBADF) {
+                // the rest goes through write(2)
+                _splice = false;
+                break;
+            }
+            throw std::runtime_error("I/O error while writing " + _name + ": " +
+                                     std::strerror(errno));
+        }
+
+        // every call takes a pipe slot for each page it touches
+        const std::size_t offset = std::size_t(data + moved - _memory) % _page_size;
+        _spliced_pages += (offset + std::size_t(got) + _page_size - 1) / _page_size;
+        _spliced_bytes += std::uint64_t(got);
+        moved += std::size_t(got);
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+    return moved;
+}
+
+void fd_writer::write(const char *data, std::size_t size) {
+    while (size != 0) {
+        const ssize_t written =
+            ::write(_fd, data, std::min<std::size_t>(size, std::size_t(1) << 30));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("I/O error while writing " + _name + ": " +
+                                     std::strerror(errno));
+        }
+        data += written;
+        size -= std::size_t(written);
+        _written_bytes += std::uint64_t(written);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "spsc_ring.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Writes a file descriptor, such as the standard output, from a writer thread
+ *
+ * The output is collected in page aligned buffers which a writer thread hands to the descriptor
+ * while the following buffer is filled. A pipe is enlarged to the buffer size, when the system
+ * allows it, and full buffers are moved to it with vmsplice(2), so the consumer reads the pages of
+ * the buffer without another copy. The pipe references the pages until they are read, so a buffer
+ * is refilled only after as many pages as the pipe holds were moved to it after the buffer. Other
+ * descriptors, partial buffers and systems without vmsplice are written with write(2).
+ *
+ * A consumer which splices the pages further (e.g. to another pipe) may still reference them when
+ * they are refilled, such consumers need splicing disabled.
+ *
+ * Errors of the writer thread are thrown by the following write or by close().
+ */
+struct fd_writer : std::streambuf {
+    /**
+     * @param name describes the descriptor in errors
+     * @param buffer_size rounded up to whole pages and to the capacity of a pipe
+     */
+    fd_writer(int fd,
+              std::string name,
+              std::size_t buffer_size = std::size_t(1) << 20,
+              bool splice = true);
+
+    /**
+     * Writes the remaining output, errors are only reported by close()
+     */
+    ~fd_writer() override;
+
+    fd_writer(const fd_writer &) = delete;
+    fd_writer &operator=(const fd_writer &) = delete;
+
+    /**
+     * @brief Writes the remaining output and waits for the writer thread
+     */
+    void close();
+
+    std::size_t buffer_size() const { return _buffer_size; }
+
+protected:
+    int_type overflow(int_type ch) override;
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+    int sync() override;
+
+private:
+    struct chunk {
+        std::size_t buffer;
+        std::size_t size;
+    };
+
+    /**
+     * Hands the filled part of the current buffer to the writer thread, with next, waits for a free
+     * buffer to continue
+     * @return false after an error of the writer thread
+     */
+    bool submit(bool next);
+
+    void write_out();
+
+    /**
+     * Moves the data to the pipe until vmsplice fails as not supported for the descriptor
+     * @return number of bytes moved
+     */
+    std::size_t splice(const char *data, std::size_t size);
+
+    void release(std::size_t buffer);
+
+    void write(const char *data, std::size_t size);
+
+    char *buffer(std::size_t i) { return _memory + i * _buffer_size; }
+
+    // one being filled, one being written and one waiting for the pages of the next to be written
+    static constexpr std::size_t buffers = 4;
+
+    const int _fd;
+    const std::string _name;
+    std::size_t _page_size;
+    bool _splice;
+    std::size_t _pipe_pages; // capacity of the pipe
+    std::size_t _buffer_size;
+    char *_memory;
+
+    std::size_t _current; // buffer being filled
+    spsc_ring<chunk> _full;
+    spsc_ring<std::size_t> _free;
+
+    std::uint64_t _spliced_pages; // pages moved to the pipe so far, each one a pipe slot
+    std::deque<std::pair<std::size_t, std::uint64_t>> _in_pipe; // buffer, pages spliced after it
+
+    std::uint64_t _spliced_bytes;
+    std::uint64_t _written_bytes;
+
+    std::exception_ptr _error;
+    std::thread _worker;
+};
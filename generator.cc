@@ -1,13 +1,20 @@
 #include "generator.h"
+#include "fd_writer.h"
 #include "streams.h"
 
 #include <eacirc-core/logger.h>
 #include <eacirc-core/random.h>
 #include <pcg/pcg_random.hpp>
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
+#include <set>
 #include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 static std::ifstream open_config_file(const std::string path) {
     std::ifstream file(path);
@@ -16,10 +23,24 @@ static std::ifstream open_config_file(const std::string path) {
     return file;
 }
 
-static std::string out_name(json const &config) {
+static std::string round_suffix(const int round) {
+    std::stringstream ss;
+    ss << "_r" << std::setw(2) << std::setfill('0') << round;
+    return ss.str();
+}
+
+/**
+ * @param tap_round the round of a round tap, -1 for the configured round
+ */
+static std::string out_name(json const &config, const int tap_round = -1) {
     auto fname_it = config.find("file_name");
     if (fname_it != config.end()) {
-        return *fname_it;
+        std::string name = *fname_it;
+        if (tap_round != -1) {
+            const auto dot = name.rfind('.');
+            name.insert(dot == std::string::npos ? name.size() : dot, round_suffix(tap_round));
+        }
+        return name;
     }
 
     std::stringstream ss;
@@ -32,10 +53,9 @@ static std::string out_name(json const &config) {
 
     ss << a;
 
-    auto round = config_ref.value("round", -1);
+    auto round = tap_round != -1 ? tap_round : config_ref.value("round", -1);
     if (round != -1) {
-        ss << "_r";
-        ss << std::setw(2) << std::setfill('0') << round;
+        ss << round_suffix(round);
     }
 
     auto block_size = config_ref.value("block_size", -1);
@@ -47,36 +67,359 @@ static std::string out_name(json const &config) {
     return ss.str();
 }
 
+/**
+ * @brief Cuts the file to its first size bytes, to append to it
+ *
+ * A file linked from a dataset_cache shares its data with the cache entry, it is replaced by a copy
+ * of the prefix instead of being truncated.
+ */
+static void keep_prefix(const std::string &name, const std::uint64_t size) {
+    struct stat info;
+    if (::stat(name.c_str(), &info) != 0 || std::uint64_t(info.st_size) < size)
+        throw std::runtime_error("file " + name + " is shorter than its checkpoint");
+    if (info.st_nlink == 1) {
+        if (::truncate(name.c_str(), off_t(size)) != 0)
+            throw std::runtime_error("can't truncate file " + name);
+        return;
+    }
+
+    // the open file keeps the linked data readable after its name is removed
+    std::ifstream in(name, std::ios::binary);
+    std::remove(name.c_str());
+    std::ofstream out(name, std::ios::binary);
+    std::vector<char> buffer(std::size_t(1) << 20);
+    for (std::uint64_t left = size; left != 0;) {
+        const auto chunk = std::streamsize(std::min<std::uint64_t>(left, buffer.size()));
+        if (!in.read(buffer.data(), chunk))
+            throw std::runtime_error("can't read file " + name);
+        out.write(buffer.data(), chunk);
+        left -= std::uint64_t(chunk);
+    }
+    if (!out)
+        throw std::runtime_error("can't write file " + name);
+}
+
+/**
+ * @return the files of the sink, one per round tap (all produced by one stream) or a single one
+ */
+static std::vector<std::string> sink_names(json const &config) {
+    std::vector<std::string> names;
+    for (std::size_t tap : round_taps(config.at("stream")))
+        names.push_back(out_name(config, int(tap)));
+    if (names.empty())
+        names.push_back(out_name(config));
+    return names;
+}
+
+std::vector<std::string> generator::output_names(json const &config) {
+    if (config.value("stdout", false))
+        return {};
+    auto sinks_it = config.find("sinks");
+    if (sinks_it == config.end())
+        return sink_names(config);
+
+    std::vector<std::string> names;
+    for (const json &sink_config : *sinks_it) {
+        const std::vector<std::string> sink = sink_names(sink_config);
+        names.insert(names.end(), sink.begin(), sink.end());
+    }
+    return names;
+}
+
 generator::generator(const std::string config)
     : generator(open_config_file(config)) {}
 
 generator::generator(json const &config)
     : _config(config)
-    , _seed(seed::create(config.at("seed")))
-    , _tv_count(config.at("tv_count"))
-    , _o_file_name(out_name(config)) {
+    , _seed(seed::create(config.at("seed"))) {
     seed_seq_from<pcg32> main_seeder(_seed);
     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
 
-    _stream_a = make_stream(config.at("stream"), main_seeder, map, std::size_t(config.at("tv_size")));
+    const aligned_buffer::huge_pages_scope huge_pages(config.value("huge_pages", false));
+    // the buffers of all trees, which may share pipes, in one arena
+    const aligned_buffer::arena_scope arena;
+
+    auto sinks_it = config.find("sinks");
+    if (sinks_it == config.end()) {
+        add_sink(config, main_seeder, map);
+        return;
+    }
+    if (config.find("stream") != config.end())
+        throw std::runtime_error("config has both \"stream\" and \"sinks\"");
+    if (config.value("stdout", false))
+        throw std::runtime_error("sinks are written to files, not to the standard output");
+
+    for (json sink_config : *sinks_it) {
+        for (const char *inherited : {"tv_size", "tv_count"}) {
+            if (sink_config.find(inherited) == sink_config.end())
+                sink_config[inherited] = config.at(inherited);
+        }
+        add_sink(sink_config, main_seeder, map);
+    }
+}
+
+void generator::add_sink(
+    json const &config,
+    default_seed_source &seeder,
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes) {
+    sink s;
+    s.tv_count = config.at("tv_count");
+    s.file_names = sink_names(config);
+
+    std::set<std::string> pipes_in;
+    std::set<std::string> pipes_out;
+    collect_pipe_ids(config.at("stream"), pipes_in, pipes_out);
+    _piped = _piped || !pipes_in.empty() || !pipes_out.empty();
+
+    s.stream_config = config.at("stream");
+    s.tv_size = config.at("tv_size");
+    s.source = make_stream(config.at("stream"), seeder, pipes, s.tv_size * s.file_names.size());
+    _sinks.push_back(std::move(s));
+}
+
+std::vector<std::string> generator::outputs() const {
+    std::vector<std::string> names;
+    if (_config.value("stdout", false))
+        return names;
+    for (const sink &s : _sinks)
+        names.insert(names.end(), s.file_names.begin(), s.file_names.end());
+    return names;
+}
+
+json generator::checkpoint_config() const {
+    json config = _config;
+    config.erase("tv_count");
+    config.erase("checkpoint_interval");
+    auto sinks_it = config.find("sinks");
+    if (sinks_it != config.end()) {
+        for (json &sink_config : *sinks_it)
+            sink_config.erase("tv_count");
+    }
+    return config;
 }
 
-void generator::generate() {
+bool generator::load_checkpoint(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
 
-    auto stdout_it = _config.find("stdout");
-    std::unique_ptr<std::ostream> ofstream_ptr;
-    std::ostream *o_file = nullptr;
+    const json checkpoint = json::parse(file);
+    if (checkpoint.at("config") != checkpoint_config())
+        throw std::runtime_error("checkpoint " + path + " was written for a different config");
+    if (checkpoint.at("sinks").size() != _sinks.size())
+        throw std::runtime_error("checkpoint " + path + " has a different number of sinks");
+
+    for (std::size_t k = 0; k < _sinks.size(); ++k) {
+        sink &s = _sinks[k];
+        // a smaller tv_count than before leaves only its vectors in the files
+        s.start = std::min(std::uint64_t(checkpoint.at("sinks")[k].at("written")), s.tv_count);
+    }
+    return true;
+}
+
+void generator::save_checkpoint(const std::string &path) const {
+    json sinks = json::array();
+    for (const sink &s : _sinks)
+        sinks.push_back({{"written", std::max(s.position, s.start)}});
+
+    // the old checkpoint stays valid until the new one is complete
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp);
+        file << json{{"config", checkpoint_config()}, {"sinks", sinks}}.dump(4) << std::endl;
+        if (!file)
+            throw std::runtime_error("can't write checkpoint " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("can't replace checkpoint " + path);
+}
+
+void generator::open_cached(sink &s,
+                            const dataset_cache &cache,
+                            std::vector<std::unique_ptr<std::ostream>> &files) {
+    std::uint64_t cached = s.tv_count; // vectors in all files of the sink
+    bool linked = true;                 // whole entries are provided without reading them
+    std::vector<json> entries;
+    for (std::size_t j = 0; j < s.file_names.size(); ++j) {
+        entries.push_back(
+            dataset_cache::description(s.stream_config, _config.at("seed"), s.tv_size, j));
+        const std::uint64_t size = cache.size(entries.back());
+        cached = std::min(cached, size / s.tv_size);
+        linked = linked && size == s.tv_count * s.tv_size;
+    }
+
+    // only the copied prefixes are checked
+    for (std::size_t j = 0; j < s.file_names.size() && !linked; ++j) {
+        const std::uint64_t valid = cache.valid_prefix(entries[j], cached * s.tv_size);
+        if (valid != cached * s.tv_size) {
+            logger::warning() << "cached data of " << s.file_names[j] << " are corrupted from "
+                              << valid << " bytes, they are generated again from there"
+                              << std::endl;
+            cached = valid / s.tv_size;
+        }
+    }
+
+    const std::uint64_t files_count = s.file_names.size();
+    _cache_statistics.reused_bytes += cached * s.tv_size * files_count;
+    if (cached == s.tv_count) {
+        for (std::size_t j = 0; j < s.file_names.size(); ++j)
+            cache.provide(entries[j], s.file_names[j], s.tv_count * s.tv_size);
+        _cache_statistics.hits += files_count;
+        s.start = s.end = 0; // nothing to generate
+        return;
+    }
+
+    (cached == 0 ? _cache_statistics.misses : _cache_statistics.extended) += files_count;
+    _cache_statistics.generated_bytes += (s.end - cached) * s.tv_size * files_count;
+    s.start = cached;
+    for (const json &entry : entries)
+        files.push_back(std::make_unique<std::ofstream>(
+            cache.begin_update(entry, cached * s.tv_size), std::ios::binary | std::ios::app));
+    s.cache_entries = std::move(entries);
+}
+
+void generator::generate(const std::uint64_t start, const std::uint64_t count) {
+    const bool to_stdout = _config.value("stdout", false);
+    const std::string checkpoint = _config.value("checkpoint", "");
+    const std::uint64_t interval = _config.value("checkpoint_interval", std::uint64_t(65536));
+
+    const std::uint64_t end =
+        start + std::min(count, std::numeric_limits<std::uint64_t>::max() - start);
+    for (sink &s : _sinks) {
+        s.start = std::min(start, s.tv_count);
+        s.end = std::min(end, s.tv_count);
+    }
+
+    bool resume = false;
+    if (!checkpoint.empty()) {
+        if (to_stdout)
+            throw std::runtime_error("checkpoints need output files, not the standard output");
+        if (start != 0 || end != std::numeric_limits<std::uint64_t>::max())
+            throw std::runtime_error("a checkpoint cannot be combined with a range");
+        if (interval == 0)
+            throw std::runtime_error("checkpoint interval has to be at least 1");
+        resume = load_checkpoint(checkpoint);
+        for (const sink &s : _sinks) {
+            // still the same output, only slower
+            if (resume && s.start != 0 && (_piped || !s.source->seekable()))
+                logger::warning() << "the streams of " << s.file_names.front()
+                                  << " cannot jump, the " << s.start
+                                  << " vectors written before the checkpoint are generated again"
+                                  << std::endl;
+        }
+    }
+
+    std::unique_ptr<dataset_cache> cache;
+    const std::string cache_dir = _config.value("cache", "");
+    if (!cache_dir.empty()) {
+        if (to_stdout)
+            throw std::runtime_error("the cache is used with files, not the standard output");
+        if (!checkpoint.empty() || start != 0 || end != std::numeric_limits<std::uint64_t>::max())
+            throw std::runtime_error("the cache cannot be combined with a checkpoint or a range");
+        if (_piped)
+            logger::warning() << "configs with pipes are not cached" << std::endl;
+        else
+            cache = std::make_unique<dataset_cache>(cache_dir);
+    }
+
+    // outlives the streams writing to it
+    std::unique_ptr<fd_writer> stdout_writer;
+    std::vector<std::vector<std::unique_ptr<std::ostream>>> files;
+    for (sink &s : _sinks) {
+        files.emplace_back();
+        if (cache) {
+            open_cached(s, *cache, files.back());
+            continue;
+        }
+        if (to_stdout) {
+            if (s.file_names.size() != 1)
+                throw std::runtime_error(
+                    "round taps are written to files, not to the standard output");
+            std::cout.flush();
+            stdout_writer = std::make_unique<fd_writer>(
+                STDOUT_FILENO,
+                "the standard output",
+                _config.value("stdout_buffer_size", std::size_t(1) << 20),
+                _config.value("stdout_vmsplice", true));
+            files.back().push_back(std::make_unique<std::ostream>(stdout_writer.get()));
+            continue;
+        }
+        for (const std::string &name : s.file_names) {
+            const std::uint64_t size = s.start * s.tv_size;
+            if (!resume || size == 0) {
+                // a new file, the old one may be linked from a dataset_cache
+                std::remove(name.c_str());
+                files.back().push_back(std::make_unique<std::ofstream>(name, std::ios::binary));
+                continue;
+            }
+            // drops vectors written after the checkpoint
+            keep_prefix(name, size);
+            files.back().push_back(
+                std::make_unique<std::ofstream>(name, std::ios::binary | std::ios::app));
+        }
+    }
+
+    if (!_piped) {
+        for (sink &s : _sinks) {
+            s.source->skip(s.start);
+            s.position = s.start;
+        }
+    }
+
+    for (std::uint64_t turn = 1;; ++turn) {
+        bool running = false;
+        for (std::size_t k = 0; k < _sinks.size(); ++k) {
+            sink &s = _sinks[k];
+            if (!s.source)
+                continue;
+            if (s.position >= s.end) {
+                s.source.reset();
+                continue;
+            }
+            running = true;
+
+            vec_cview n = s.source->next();
+            if (s.position++ < s.start)
+                continue;
+
+            const std::size_t part = n.size() / files[k].size();
+            for (std::size_t j = 0; j < files[k].size(); ++j)
+                files[k][j]->write(reinterpret_cast<const char *>(&*n.begin()) + j * part,
+                                   std::streamsize(part));
+        }
+        if (!running)
+            break;
+
+        if (!checkpoint.empty() && turn % interval == 0) {
+            // the files hold at least the saved vectors
+            for (auto &sink_files : files)
+                for (auto &file : sink_files)
+                    file->flush();
+            save_checkpoint(checkpoint);
+        }
+    }
+
+    if (stdout_writer) {
+        files.clear();
+        stdout_writer->close();
+    }
 
-    if (stdout_it == _config.end() || stdout_it->get<bool>() == false) {
-        ofstream_ptr = std::make_unique<std::ofstream>(_o_file_name, std::ios::binary);
-        o_file = ofstream_ptr.get();
-    } else {
-        o_file = &(std::cout);
+    if (!checkpoint.empty()) {
+        files.clear();
+        save_checkpoint(checkpoint);
     }
 
-    for (std::size_t i = 0; i < _tv_count; ++i) {
-        vec_cview n = _stream_a->next();
-        for (auto o : n)
-            *o_file << o;
+    if (cache) {
+        files.clear();
+        for (const sink &s : _sinks) {
+            for (std::size_t j = 0; j < s.cache_entries.size(); ++j) {
+                cache->commit_update(s.cache_entries[j]);
+                cache->provide(s.cache_entries[j], s.file_names[j], s.tv_count * s.tv_size);
+            }
+        }
+        logger::info() << "cache: " << _cache_statistics.hits << " hits, "
+                       << _cache_statistics.extended << " extended, " << _cache_statistics.misses
+                       << " misses, " << _cache_statistics.reused_bytes << " bytes reused, "
+                       << _cache_statistics.generated_bytes << " bytes generated" << std::endl;
     }
 }
@@ -1,12 +1,45 @@
 #pragma once
 
+#include "dataset_cache.h"
 #include "stream.h"
 #include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
 #include <eacirc-core/seed.h>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <vector>
 
+/**
+ * @brief Writes the test vectors of the configured "stream", or of every stream in "sinks"
+ *
+ * Sinks are objects with their own "stream", "file_name", "tv_size" and "tv_count" (the latter two
+ * default to the top level values). They are built with one seeder and one pipes table, so a sink
+ * reading a pipe_out_stream gets the vectors of a pipe_in_stream of another sink and the shared
+ * subtree is evaluated once. Sinks are written in turns, one vector each, a sink which has written
+ * all its vectors is destroyed and stops holding back the ordered pipes it reads (see pipe_buffer).
+ *
+ * With "checkpoint" (a file name) the number of vectors written by each sink is saved to that file
+ * every "checkpoint_interval" turns (default 65536) and at the end. A run of the same config
+ * finding the checkpoint truncates the files to the saved vectors and appends the rest, so a run
+ * which was interrupted, or which is repeated with larger "tv_count"s, writes the same files as a
+ * fresh run.
+ * The streams are rebuilt from the seed and skip the written vectors (see stream::skip), no state
+ * beyond the counts is stored. Seekable trees (see stream::seekable) jump over the written
+ * vectors; trees with pipes or with streams which cannot jump, such as the estream ciphers,
+ * generate them again and discard them, which is reported as a warning.
+ *
+ * With "cache" (a directory) the files are looked up in a dataset_cache first. A file cached with
+ * enough vectors is linked or copied from it, a shorter one is extended, and the generated files
+ * are stored to the cache. Configs with pipes are not cached. Output files are never overwritten
+ * in place, a file linked from the cache is replaced, so the cached data stay intact. Only the
+ * parts copied from the cache are checked against its checksums, whole files are linked unread.
+ *
+ * With "stdout" the vectors are written to the standard output by an fd_writer with buffers of
+ * "stdout_buffer_size" bytes (default 1 MiB), moved to a pipe with vmsplice unless
+ * "stdout_vmsplice" is false.
+ */
 struct generator {
     generator(const std::string cofig);
 
@@ -21,15 +54,77 @@ struct generator {
 
     generator(json const &config);
 
-    void generate();
+    /**
+     * @brief Writes the test vectors start, ..., start + count - 1 of every sink
+     *
+     * The streams skip the vectors before start (see stream::skip), so files written for
+     * consecutive ranges concatenate to the output of the whole run. Configs with pipes generate
+     * the skipped vectors in turns as the whole run does, to keep the pipes in step. A range cannot
+     * be combined with a checkpoint.
+     */
+    void generate(std::uint64_t start = 0,
+                  std::uint64_t count = std::numeric_limits<std::uint64_t>::max());
+
+    /**
+     * @return names of the files written by generate, none when writing to the standard output
+     */
+    std::vector<std::string> outputs() const;
+
+    /**
+     * @return names of the files the generator of the config writes, without building its streams
+     */
+    static std::vector<std::string> output_names(json const &config);
+
+    /**
+     * @return use of the cache by generate
+     */
+    const dataset_cache::statistics &cache_statistics() const { return _cache_statistics; }
 
 private:
-    const json _config;
-    const seed _seed;
+    /**
+     * @brief Stream written to its own files, one per round tap or a single one
+     */
+    struct sink {
+        std::unique_ptr<stream> source;
+        std::uint64_t tv_count;
+        std::size_t tv_size; // bytes of one vector in each file
+        std::vector<std::string> file_names;
+        json stream_config;
+        std::vector<json> cache_entries; // descriptions of the files written to the cache
+
+        std::uint64_t start = 0;    // first written vector
+        std::uint64_t end = 0;      // vectors from end on are not generated
+        std::uint64_t position = 0; // vectors generated or skipped
+    };
 
-    const std::uint64_t _tv_count;
+    void add_sink(json const &config,
+                  default_seed_source &seeder,
+                  std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes);
 
-    std::unique_ptr<stream> _stream_a;
+    /**
+     * Sets the start of each sink from the checkpoint file, if it exists
+     * @return true when resuming from the checkpoint
+     */
+    bool load_checkpoint(const std::string &path);
+
+    void save_checkpoint(const std::string &path) const;
+
+    /**
+     * @return the config without the values which may change between resumed runs
+     */
+    json checkpoint_config() const;
+
+    /**
+     * Provides the files of the sink from the cache, or opens the cache files to generate
+     */
+    void open_cached(sink &s,
+                     const dataset_cache &cache,
+                     std::vector<std::unique_ptr<std::ostream>> &files);
+
+    const json _config;
+    const seed _seed;
 
-    std::string _o_file_name;
+    std::vector<sink> _sinks;
+    bool _piped = false; // a sink reads or writes a pipe
+    dataset_cache::statistics _cache_statistics;
 };
@@ -1,3 +1,4 @@
+#include "campaign.h"
 #include "generator.h"
 #include <eacirc-core/cmd.h>
 #include <eacirc-core/logger.h>
@@ -15,11 +16,31 @@ struct config {
     bool help = false;
     bool version = false;
     std::string config = "generator.json";
+    std::string campaign;
+    std::string range;
 };
 
 static cmd<config> options{{"-h", "--help", "display help message", &config::help},
                            {"-v", "--version", "display program version", &config::version},
-                           {"-c", "--config", "specify the config file to load", &config::config}};
+                           {"-c", "--config", "specify the config file to load", &config::config},
+                           {"-C",
+                            "--campaign",
+                            "run all generator configs of the campaign file",
+                            &config::campaign},
+                           {"-r",
+                            "--range",
+                            "write only the test vectors start, ..., start + count - 1",
+                            &config::range}};
+
+/**
+ * @return start and count of the range given as start:count
+ */
+static std::pair<std::uint64_t, std::uint64_t> parse_range(const std::string &range) {
+    const auto colon = range.find(':');
+    if (colon == std::string::npos)
+        throw std::runtime_error("range has to be given as start:count");
+    return {std::stoull(range.substr(0, colon)), std::stoull(range.substr(colon + 1))};
+}
 
 int main(const int argc, const char **argv) try {
     auto cfg = options.parse(make_view(argv, argc));
@@ -33,8 +54,18 @@ int main(const int argc, const char **argv) try {
     } else {
         test_environment();
 
-        generator app(cfg.config);
-        app.generate();
+        if (!cfg.campaign.empty()) {
+            if (!cfg.range.empty())
+                throw std::runtime_error("range cannot be used with a campaign");
+            campaign(cfg.campaign).run();
+        } else if (!cfg.range.empty()) {
+            const auto range = parse_range(cfg.range);
+            generator app(cfg.config);
+            app.generate(range.first, range.second);
+        } else {
+            generator app(cfg.config);
+            app.generate();
+        }
     }
 
     return 0;
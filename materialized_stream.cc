@@ -0,0 +1,141 @@
+#include "materialized_stream.h"
+#include "streams.h"
+#include <algorithm>
+#include <array>
+#include <eacirc-core/logger.h>
+#include <fcntl.h>
+#include <set>
+#include <sys/mman.h>
+#include <unistd.h>
+
+materialized_stream::materialized_stream(
+    const json &config,
+    default_seed_source &seeder,
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+    const std::size_t osize)
+    : stream(osize)
+    , _cache(config.value("dir", std::string("materialized")))
+    , _mapped(nullptr)
+    , _mapped_size(0)
+    , _stored(0)
+    , _position(0) {
+    std::set<std::string> pipes_in;
+    std::set<std::string> pipes_out;
+    collect_pipe_ids(config.at("source"), pipes_in, pipes_out);
+    if (!pipes_in.empty() || !pipes_out.empty())
+        throw std::runtime_error("materialized stream cannot contain pipes");
+
+    // the following outputs of a copy of the seeder identify the seeds the subtree gets
+    default_seed_source fingerprint_source(static_cast<const default_seed_source &>(seeder));
+    std::array<std::uint32_t, 2> fingerprint;
+    fingerprint_source.generate(fingerprint.begin(), fingerprint.end());
+
+    _entry = dataset_cache::description(
+        config.at("source"), {fingerprint[0], fingerprint[1]}, osize, 0);
+    _source = make_stream(config.at("source"), seeder, pipes, osize);
+    map();
+}
+
+materialized_stream::~materialized_stream() {
+    if (_update) {
+        _update->flush();
+        const bool written = bool(*_update);
+        _update.reset();
+        try {
+            if (!written)
+                throw std::runtime_error("write failed");
+            _cache.commit_update(_entry);
+        } catch (std::exception &e) {
+            logger::error(std::string("materialized stream was not stored: ") + e.what());
+        }
+    }
+    if (_mapped)
+        ::munmap(const_cast<value_type *>(_mapped), _mapped_size);
+}
+
+void materialized_stream::map() {
+    const std::uint64_t size = _cache.size(_entry);
+    if (size < osize())
+        return;
+
+    // whole, the checksums cover the blocks up to the end of the file
+    _stored = size / osize();
+    _mapped_size = std::size_t(size);
+    _checker = _cache.checker(_entry);
+
+    const int fd = ::open(_cache.data_path(_entry).c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("can't open materialized file " + _cache.data_path(_entry));
+    void *mapped = ::mmap(nullptr, _mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        throw std::runtime_error("can't map materialized file " + _cache.data_path(_entry));
+
+    // the vectors are read once from the start
+    ::madvise(mapped, _mapped_size, MADV_SEQUENTIAL);
+    ::madvise(mapped, _mapped_size, MADV_WILLNEED);
+    _mapped = static_cast<const value_type *>(mapped);
+}
+
+vec_cview materialized_stream::next() {
+    next_batch(_data.data(), 1);
+    return make_cview(_data);
+}
+
+void materialized_stream::check(const std::uint64_t begin, const std::uint64_t end) {
+    const char *data = reinterpret_cast<const char *>(_mapped);
+    const std::uint64_t valid = _checker.check(data, begin, end);
+    if (valid == end)
+        return;
+
+    logger::warning() << "materialized file " << _cache.data_path(_entry) << " is corrupted from "
+                      << valid << " bytes, it is written again from there" << std::endl;
+    _stored = valid / osize();
+}
+
+void materialized_stream::next_batch(value_type *out, std::size_t count) {
+    if (_position < _stored)
+        check(_position * osize(), std::min(_position + count, _stored) * osize());
+
+    const auto stored =
+        std::size_t(std::min<std::uint64_t>(count, _stored - std::min(_position, _stored)));
+    if (stored != 0) {
+        std::copy_n(_mapped + _position * osize(), stored * osize(), out);
+        _position += stored;
+        out += stored * osize();
+        count -= stored;
+    }
+    if (count == 0)
+        return;
+
+    if (!_update) {
+        // the kept vectors include the skipped ones, which were not checked yet
+        check(0, _stored * osize());
+        _update = std::make_unique<std::ofstream>(
+            _cache.begin_update(_entry, _stored * osize()), std::ios::binary | std::ios::app);
+        _source->skip(_stored);
+
+        // skipped after a corrupted block, the file stays contiguous
+        std::vector<value_type> skipped(osize());
+        for (std::uint64_t i = _stored; i < _position; ++i) {
+            _source->next_batch(skipped.data(), 1);
+            _update->write(reinterpret_cast<const char *>(skipped.data()),
+                           std::streamsize(osize()));
+        }
+    }
+    _source->next_batch(out, count);
+    _update->write(reinterpret_cast<const char *>(out), std::streamsize(count * osize()));
+    _position += count;
+}
+
+void materialized_stream::skip(std::uint64_t count) {
+    const std::uint64_t stored = std::min(count, _stored - std::min(_position, _stored));
+    _position += stored;
+    count -= stored;
+
+    // the file has to stay contiguous, so the vectors after the stored ones are generated
+    const std::size_t batch = 1024;
+    std::vector<value_type> discarded(std::size_t(std::min<std::uint64_t>(count, batch)) * osize());
+    for (; count != 0; count -= std::min<std::uint64_t>(count, batch))
+        next_batch(discarded.data(), std::size_t(std::min<std::uint64_t>(count, batch)));
+}
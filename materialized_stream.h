@@ -0,0 +1,58 @@
+#pragma once
+
+#include "dataset_cache.h"
+#include "stream.h"
+#include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
+#include <fstream>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Replays the output of its source subtree from a file written by an earlier run
+ *
+ * The vectors are stored in a dataset_cache in "dir" ("materialized" by default), keyed by the
+ * source config, the output size and the state of the seeder, so the same subtree of different
+ * configs (such as the key stream of a sweep over rounds) shares one file. The subtree is built
+ * with the seeder as without the node and the output is identical to it. Vectors present in the
+ * file are copied from its memory mapping, the following ones are generated by the subtree (which
+ * skips the stored ones first) and appended to the file when the stream is destroyed. Each block
+ * of the file is checked against its checksum when it is first read, from the first block not
+ * matching it the vectors are generated and the file is written again. Pipes cannot be used in the
+ * subtree.
+ */
+struct materialized_stream : stream {
+    materialized_stream(
+        const json &config,
+        default_seed_source &seeder,
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+        const std::size_t osize);
+    ~materialized_stream() override;
+
+    vec_cview next() override;
+
+    void next_batch(value_type *out, std::size_t count) override;
+
+    void skip(std::uint64_t count) override;
+
+private:
+    void map();
+
+    /**
+     * Checks the stored bytes [begin, end), the vectors from the first corrupted block on are no
+     * longer read from the file
+     */
+    void check(std::uint64_t begin, std::uint64_t end);
+
+    const dataset_cache _cache;
+    json _entry;
+    std::unique_ptr<stream> _source;
+
+    const value_type *_mapped;
+    std::size_t _mapped_size;
+    dataset_cache::block_checker _checker;
+    std::uint64_t _stored;   // vectors used from the mapped file
+    std::uint64_t _position; // vectors read
+
+    std::unique_ptr<std::ofstream> _update; // vectors after the stored ones
+};
@@ -0,0 +1,166 @@
+#include "pcg32x8.h"
+#include "simd.h"
+#include <algorithm>
+
+namespace {
+
+constexpr std::uint64_t pcg_multiplier = 6364136223846793005ULL;
+
+inline std::uint32_t pcg_output(const std::uint64_t state) {
+    const auto xorshifted = std::uint32_t(((state >> 18u) ^ state) >> 27u);
+    const auto rot = std::uint32_t(state >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
+
+void generate_blocks_scalar(std::uint64_t *state,
+                            const std::uint64_t *inc,
+                            std::uint8_t *out,
+                            std::size_t count) {
+    for (; count != 0; --count) {
+        for (std::size_t lane = 0; lane < pcg32x8::lanes; ++lane, out += 4) {
+            const std::uint64_t old = state[lane];
+            state[lane] = old * pcg_multiplier + inc[lane];
+
+            const std::uint32_t value = pcg_output(old);
+            out[0] = std::uint8_t(value);
+            out[1] = std::uint8_t(value >> 8);
+            out[2] = std::uint8_t(value >> 16);
+            out[3] = std::uint8_t(value >> 24);
+        }
+    }
+}
+
+#ifdef STREAMS_X86_DISPATCH
+
+// low 64 bits of a 64x64 multiplication, AVX2 has only 32x32->64 multiplies
+STREAMS_TARGET("avx2") inline __m256i mul64(const __m256i a, const __m256i b_lo, const __m256i b_hi) {
+    const __m256i lo = _mm256_mul_epu32(a, b_lo);
+    const __m256i cross =
+        _mm256_add_epi64(_mm256_mul_epu32(a, b_hi), _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b_lo));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+// XSH-RR output of four states, result in the low dword of each 64-bit lane
+STREAMS_TARGET("avx2") inline __m256i output4(const __m256i state) {
+    const __m256i xorshifted =
+        _mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(state, 18), state), 27);
+    const __m256i rot = _mm256_srli_epi64(state, 59);
+    const __m256i lrot = _mm256_sub_epi32(_mm256_set1_epi64x(32), rot);
+    return _mm256_or_si256(_mm256_srlv_epi32(xorshifted, rot),
+                           _mm256_sllv_epi32(xorshifted, lrot));
+}
+
+STREAMS_TARGET("avx2")
+void generate_blocks_avx2(std::uint64_t *state,
+                          const std::uint64_t *inc,
+                          std::uint8_t *out,
+                          std::size_t count) {
+    const __m256i mult_lo = _mm256_set1_epi64x(std::int64_t(pcg_multiplier & 0xFFFFFFFFu));
+    const __m256i mult_hi = _mm256_set1_epi64x(std::int64_t(pcg_multiplier >> 32));
+    const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state));
+    __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 4));
+    const __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inc));
+    const __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inc + 4));
+
+    for (; count != 0; --count, out += pcg32x8::block_size) {
+        const __m256i o0 = output4(s0);
+        const __m256i o1 = output4(s1);
+
+        s0 = _mm256_add_epi64(mul64(s0, mult_lo, mult_hi), i0);
+        s1 = _mm256_add_epi64(mul64(s1, mult_lo, mult_hi), i1);
+
+        // dwords: lane0, lane4, lane1, lane5, ... -> lane0 .. lane7
+        const __m256i mixed = _mm256_blend_epi32(o0, _mm256_slli_epi64(o1, 32), 0xAA);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                            _mm256_permutevar8x32_epi32(mixed, order));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state), s0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 4), s1);
+}
+
+#endif
+
+// state after delta steps of state' = state * mult + inc, see Brown: Random number generation
+// with arbitrary strides
+std::uint64_t advance(std::uint64_t state, std::uint64_t delta, const std::uint64_t inc) {
+    std::uint64_t mult = pcg_multiplier;
+    std::uint64_t plus = inc;
+    std::uint64_t acc_mult = 1;
+    std::uint64_t acc_plus = 0;
+    for (; delta != 0; delta >>= 1) {
+        if (delta & 1) {
+            acc_mult *= mult;
+            acc_plus = acc_plus * mult + plus;
+        }
+        plus = (mult + 1) * plus;
+        mult *= mult;
+    }
+    return acc_mult * state + acc_plus;
+}
+
+} // namespace
+
+pcg32x8::pcg32x8(const std::array<std::uint64_t, lanes> &initstate,
+                 const std::array<std::uint64_t, lanes> &initseq) {
+    seed(initstate, initseq);
+}
+
+void pcg32x8::seed(const std::array<std::uint64_t, lanes> &initstate,
+                   const std::array<std::uint64_t, lanes> &initseq) {
+    // same initialization as pcg32(initstate, initseq)
+    for (std::size_t i = 0; i < lanes; ++i) {
+        _inc[i] = (initseq[i] << 1u) | 1u;
+        _state[i] = (_inc[i] + initstate[i]) * pcg_multiplier + _inc[i];
+    }
+    _spare_pos = block_size;
+}
+
+void pcg32x8::generate_blocks(std::uint8_t *out, std::size_t count, bool use_simd) {
+#ifdef STREAMS_X86_DISPATCH
+    if (use_simd && simd::has_avx2()) {
+        generate_blocks_avx2(_state.data(), _inc.data(), out, count);
+        return;
+    }
+#else
+    (void)use_simd;
+#endif
+    generate_blocks_scalar(_state.data(), _inc.data(), out, count);
+}
+
+void pcg32x8::fill(std::uint8_t *out, std::size_t n) {
+    const std::size_t carried = std::min(n, block_size - _spare_pos);
+    out = std::copy_n(_spare.begin() + _spare_pos, carried, out);
+    _spare_pos += carried;
+    n -= carried;
+
+    const std::size_t blocks = n / block_size;
+    generate_blocks(out, blocks);
+    out += blocks * block_size;
+    n -= blocks * block_size;
+
+    if (n != 0) {
+        generate_blocks(_spare.data(), 1);
+        std::copy_n(_spare.begin(), n, out);
+        _spare_pos = n;
+    }
+}
+
+void pcg32x8::skip(std::uint64_t n) {
+    const std::uint64_t carried = std::min<std::uint64_t>(n, block_size - _spare_pos);
+    _spare_pos += std::size_t(carried);
+    n -= carried;
+
+    const std::uint64_t blocks = n / block_size;
+    for (std::size_t i = 0; i < lanes; ++i) {
+        _state[i] = advance(_state[i], blocks, _inc[i]);
+    }
+    n %= block_size;
+
+    if (n != 0) {
+        generate_blocks(_spare.data(), 1);
+        _spare_pos = std::size_t(n);
+    }
+}
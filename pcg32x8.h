@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Eight independent PCG32 (XSH-RR 64/32) generators advanced in lockstep
+ *
+ * Each lane is an ordinary pcg32 with its own state and stream. One block consists of one output
+ * of every lane, lane 0 first, each output stored as 4 little-endian bytes. The AVX2 kernel keeps
+ * all eight states in two registers; the scalar kernel produces the same bytes.
+ */
+struct pcg32x8 {
+    static constexpr std::size_t lanes = 8;
+    static constexpr std::size_t block_size = lanes * sizeof(std::uint32_t);
+
+    pcg32x8(const std::array<std::uint64_t, lanes> &initstate,
+            const std::array<std::uint64_t, lanes> &initseq);
+
+    template <typename Seeder> explicit pcg32x8(Seeder &&seeder) {
+        std::array<std::uint64_t, lanes> initstate;
+        std::array<std::uint64_t, lanes> initseq;
+        for (std::size_t i = 0; i < lanes; ++i) {
+            std::array<std::uint32_t, 4> words;
+            seeder.generate(words.begin(), words.end());
+            initstate[i] = (std::uint64_t(words[1]) << 32) | words[0];
+            initseq[i] = (std::uint64_t(words[3]) << 32) | words[2];
+        }
+        seed(initstate, initseq);
+    }
+
+    /**
+     * Fills n bytes, keeping the unused part of the last block for the following call
+     */
+    void fill(std::uint8_t *out, std::size_t n);
+
+    /**
+     * Writes count whole blocks, bypassing the carried bytes
+     * @param use_simd selects the AVX2 kernel when the CPU has it
+     */
+    void generate_blocks(std::uint8_t *out, std::size_t count, bool use_simd = true);
+
+    /**
+     * Moves over n bytes as fill would, every lane jumps ahead in O(log n) steps
+     */
+    void skip(std::uint64_t n);
+
+private:
+    void seed(const std::array<std::uint64_t, lanes> &initstate,
+              const std::array<std::uint64_t, lanes> &initseq);
+
+    std::array<std::uint64_t, lanes> _state;
+    std::array<std::uint64_t, lanes> _inc;
+
+    std::array<std::uint8_t, block_size> _spare;
+    std::size_t _spare_pos;
+};
@@ -0,0 +1,147 @@
+#include "pipe_buffer.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+constexpr std::size_t pipe_buffer::default_capacity;
+
+pipe_buffer::pipe_buffer(std::string id)
+    : stream(0)
+    , _id(std::move(id))
+    , _ordered(false)
+    , _capacity(default_capacity)
+    , _in_consumer(std::numeric_limits<std::size_t>::max())
+    , _first(0)
+    , _produced(0)
+    , _producing(false) {}
+
+vec_cview pipe_buffer::next() {
+    throw std::runtime_error("pipe \"" + _id + "\" can be read only by pipe streams");
+}
+
+std::size_t pipe_buffer::set_source(std::unique_ptr<stream> source,
+                                    const bool ordered,
+                                    const std::size_t capacity) {
+    if (capacity == 0)
+        throw std::runtime_error("pipe \"" + _id + "\" needs non-zero capacity");
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_source)
+            throw std::runtime_error("pipe \"" + _id + "\" has more than one pipe_in_stream");
+        _source = std::move(source);
+        _ordered = ordered;
+        _capacity = capacity;
+        // the vectors waiting for the slowest consumer and the one it has last read
+        if (ordered)
+            _slots.resize(capacity + 1);
+    }
+    _in_consumer = add_consumer();
+    return _in_consumer;
+}
+
+std::size_t pipe_buffer::add_consumer() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_produced != 0)
+        throw std::runtime_error("pipe \"" + _id + "\" got a consumer after it was read");
+    _cursors.push_back(0);
+    _readers.emplace_back();
+    return _cursors.size() - 1;
+}
+
+void pipe_buffer::remove_consumer(std::size_t consumer) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cursors[consumer] = std::numeric_limits<std::size_t>::max();
+    _readers[consumer] = std::thread::id();
+    _changed.notify_all();
+}
+
+std::size_t pipe_buffer::buffered() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _produced - _first;
+}
+
+std::size_t pipe_buffer::slowest_cursor() const {
+    return *std::min_element(_cursors.begin(), _cursors.end());
+}
+
+void pipe_buffer::wait_for_consumers(std::unique_lock<std::mutex> &lock) {
+    const std::size_t slowest = slowest_cursor();
+    for (std::size_t i = 0; i < _cursors.size(); ++i) {
+        if (_cursors[i] == slowest && _readers[i] != std::thread::id() &&
+            _readers[i] != std::this_thread::get_id()) {
+            _changed.wait(lock);
+            return;
+        }
+    }
+    throw std::runtime_error("pipe \"" + _id + "\" overflows, one of its consumers is read " +
+                             "less often than the others");
+}
+
+vec_cview pipe_buffer::read(std::size_t consumer) {
+    if (!_ordered) {
+        // both ends run on one thread, threaded_stream and tuple_stream keep pipes together
+        if (!_source)
+            throw std::runtime_error("pipe \"" + _id + "\" has no pipe_in_stream");
+        return consumer == _in_consumer ? _source->next() : _source->get_data();
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    const std::size_t index = _cursors[consumer];
+    while (index >= _produced) {
+        if (!_source)
+            throw std::runtime_error("pipe \"" + _id + "\" has no pipe_in_stream");
+        if (_producing && _producer == std::this_thread::get_id()) {
+            // feedback from inside of the source, it gets the vector produced before this one
+            _cursors[consumer] = index + 1;
+            _readers[consumer] = _producer;
+            return _source->get_data();
+        } else if (_producing) {
+            _changed.wait(lock);
+        } else if (_produced - slowest_cursor() >= _capacity) {
+            wait_for_consumers(lock);
+        } else {
+            // the source runs without the lock, so the other consumers may read meanwhile and
+            // the source itself may read the pipe
+            _producing = true;
+            _producer = std::this_thread::get_id();
+            // nobody reads the slot of the new vector, it is past the released ones
+            std::vector<value_type> &slot = _slots[_produced % _slots.size()];
+            lock.unlock();
+            try {
+                vec_cview v = _source->next();
+                slot.assign(v.begin(), v.end());
+                lock.lock();
+                ++_produced;
+            } catch (...) {
+                lock.lock();
+                _producing = false;
+                _changed.notify_all();
+                throw;
+            }
+            _producing = false;
+            _changed.notify_all();
+        }
+    }
+
+    const std::vector<value_type> &vector = _slots[index % _slots.size()];
+    _cursors[consumer] = index + 1;
+    _readers[consumer] = std::this_thread::get_id();
+
+    // the last vector returned to each consumer stays valid until its next read
+    const std::size_t slowest = slowest_cursor();
+    _first = std::max(_first, slowest == 0 ? 0 : slowest - 1);
+    _changed.notify_all();
+
+    return vec_cview(vector.data(), vector.data() + vector.size());
+}
+
+std::shared_ptr<std::unique_ptr<stream>>
+pipe_buffer::find(std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                  const std::string &id) {
+    auto &entry = pipes[id];
+    if (!entry)
+        entry = std::make_shared<std::unique_ptr<stream>>(std::make_unique<pipe_buffer>(id));
+    return entry;
+}
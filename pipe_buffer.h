@@ -0,0 +1,89 @@
+#pragma once
+
+#include "stream.h"
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Shared state of a pipe, read by the pipe_in_stream and every pipe_out_stream of one id
+ *
+ * By default a pipe_out_stream returns the vector the piped source produced last, the initial
+ * content of the source before its first vector. Reading the pipe_in_stream produces the next one.
+ *
+ * With "ordered" on the pipe_in_stream, the pipe is a bounded buffer read through per-consumer
+ * cursors. Each consumer reads the k-th vector of the piped source on its k-th call, no matter
+ * which of them is called first; the consumer reaching the end of the buffer produces the following
+ * vector. A consumer inside of the piped source is a feedback loop and gets the previously produced
+ * vector (the initial content of the source for the first one) instead. Vectors are released once
+ * every consumer has passed them, only the last vector returned to each consumer is kept until its
+ * next call. At most "capacity" vectors may be waiting for the slowest consumer. A consumer running
+ * further ahead waits for the others when they are read on other threads, otherwise it throws,
+ * because waiting would never end.
+ *
+ * The buffer is stored in the pipes table as a stream, so that the table keeps its type; reading
+ * it directly is an error.
+ */
+struct pipe_buffer : stream {
+    static constexpr std::size_t default_capacity = 256;
+
+    explicit pipe_buffer(std::string id);
+
+    vec_cview next() override;
+
+    /**
+     * @brief Sets the piped stream, this is done by the pipe_in_stream
+     * @return handle of the pipe_in_stream as a consumer
+     */
+    std::size_t set_source(std::unique_ptr<stream> source, bool ordered, std::size_t capacity);
+
+    /**
+     * @return handle of a new consumer starting at the first vector of the pipe
+     */
+    std::size_t add_consumer();
+
+    vec_cview read(std::size_t consumer);
+
+    /**
+     * @brief Detaches a destroyed consumer, the buffer no longer keeps vectors for it
+     */
+    void remove_consumer(std::size_t consumer);
+
+    /**
+     * @return number of vectors held by the buffer
+     */
+    std::size_t buffered() const;
+
+    /**
+     * @brief Finds or creates the buffer of the pipe in the pipes table
+     */
+    static std::shared_ptr<std::unique_ptr<stream>>
+    find(std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+         const std::string &id);
+
+private:
+    std::size_t slowest_cursor() const;
+    void wait_for_consumers(std::unique_lock<std::mutex> &lock);
+
+    const std::string _id;
+    std::unique_ptr<stream> _source;
+    bool _ordered;
+    std::size_t _capacity;
+    std::size_t _in_consumer; // the pipe_in_stream
+
+    std::vector<std::vector<value_type>> _slots; // ring of vectors, reused once released
+    std::size_t _first;                          // oldest vector still held
+    std::size_t _produced;
+    bool _producing;
+    std::thread::id _producer;
+
+    std::vector<std::size_t> _cursors;
+    std::vector<std::thread::id> _readers;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+};
@@ -0,0 +1,82 @@
+#include "samplers.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace sampler {
+
+bernoulli_words::bernoulli_words(const double p)
+    : _threshold(0)
+    , _all_ones(p >= 1.0)
+    , _spare(0)
+    , _spare_bytes(0) {
+    if (!(p >= 0.0 && p <= 1.0))
+        throw std::runtime_error("Probability p has to be in range [0, 1].");
+
+    // binary expansion of p, 64 digits
+    double rest = p;
+    for (int digit = 63; digit >= 0 && rest > 0.0 && !_all_ones; --digit) {
+        rest *= 2.0;
+        if (rest >= 1.0) {
+            _threshold |= std::uint64_t(1) << digit;
+            rest -= 1.0;
+        }
+    }
+}
+
+byte_alias_table::byte_alias_table(const std::array<double, 256> &weights) {
+    double sum = 0.0;
+    for (double weight : weights) {
+        if (!(weight >= 0.0))
+            throw std::runtime_error("Weights of the alias table have to be non-negative.");
+        sum += weight;
+    }
+    if (!(sum > 0.0))
+        throw std::runtime_error("At least one weight of the alias table has to be positive.");
+
+    // Vose's method: columns with scaled probability below one are filled up by larger ones
+    std::array<double, 256> scaled;
+    std::vector<std::size_t> small;
+    std::vector<std::size_t> large;
+    for (std::size_t i = 0; i < 256; ++i) {
+        scaled[i] = weights[i] * 256.0 / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+        _alias[i] = std::uint8_t(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const std::size_t less = small.back();
+        const std::size_t more = large.back();
+        small.pop_back();
+
+        _threshold[less] = std::uint32_t(std::lround(scaled[less] * double(1u << 24)));
+        _alias[less] = std::uint8_t(more);
+
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // remaining columns are full up to rounding errors
+    for (std::size_t i : small) {
+        _threshold[i] = 1u << 24;
+    }
+    for (std::size_t i : large) {
+        _threshold[i] = 1u << 24;
+    }
+}
+
+double byte_alias_table::probability(const std::uint8_t value) const {
+    double probability = 0.0;
+    for (std::size_t i = 0; i < 256; ++i) {
+        const double own = double(_threshold[i]) / double(1u << 24);
+        if (i == value)
+            probability += own;
+        if (_alias[i] == value)
+            probability += 1.0 - own;
+    }
+    return probability / 256.0;
+}
+
+} // namespace sampler
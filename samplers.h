@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Fast samplers for the distribution streams. They consume generator words directly instead of
+ * going through the std distributions, so their output differs from the std based streams and they
+ * are only used when selected in the config.
+ */
+namespace sampler {
+
+/**
+ * @brief 64 random bits from a generator with 32 or 64 bit outputs
+ */
+template <typename Generator> std::uint64_t random_u64(Generator &rng) {
+    static_assert(Generator::min() == 0, "generator has to produce values from zero");
+    static_assert(Generator::max() == 0xFFFFFFFFu ||
+                      Generator::max() == std::numeric_limits<std::uint64_t>::max(),
+                  "generator has to produce 32 or 64 bit values");
+
+    if (Generator::max() == 0xFFFFFFFFu) {
+        const auto lo = std::uint64_t(rng());
+        return lo | (std::uint64_t(rng()) << 32);
+    }
+    return std::uint64_t(rng());
+}
+
+/**
+ * @brief Bit-parallel Bernoulli generator
+ *
+ * Each of the 64 bits of a word is an independent comparison U < p of a uniform number U with p.
+ * Binary digits of all 64 numbers U are drawn at once (one random word per digit) and compared
+ * with the binary expansion of p from the most significant digit until every comparison is
+ * decided, which takes about 8 random words per 64 output bits. The expansion of p is truncated
+ * to 64 digits, so the probability of one differs from p by less than 2^-64.
+ */
+struct bernoulli_words {
+    explicit bernoulli_words(double p);
+
+    template <typename Generator> std::uint64_t operator()(Generator &rng) const {
+        if (_all_ones) {
+            return ~std::uint64_t(0);
+        }
+        if (_threshold == 0) {
+            return 0;
+        }
+
+        std::uint64_t ones = 0;
+        std::uint64_t undecided = ~std::uint64_t(0);
+        for (int digit = 63; digit >= 0 && undecided != 0; --digit) {
+            const std::uint64_t p_digit = ((_threshold >> digit) & 1) ? ~std::uint64_t(0) : 0;
+            const std::uint64_t u_digit = random_u64(rng);
+
+            ones |= undecided & p_digit & ~u_digit;
+            undecided &= ~(p_digit ^ u_digit);
+        }
+        return ones;
+    }
+
+    /**
+     * Fills n bytes, bit i of byte j is the (8 * j + i)-th Bernoulli trial. Trials of the last word
+     * which do not fit are kept for the following call.
+     */
+    template <typename Generator> void fill(Generator &rng, std::uint8_t *out, std::size_t n) {
+        for (; n != 0 && _spare_bytes != 0; --n, --_spare_bytes, _spare >>= 8) {
+            *out++ = std::uint8_t(_spare);
+        }
+        for (; n >= 8; n -= 8, out += 8) {
+            const std::uint64_t word = (*this)(rng);
+            for (unsigned i = 0; i < 8; ++i) {
+                out[i] = std::uint8_t(word >> (8 * i));
+            }
+        }
+        if (n != 0) {
+            _spare = (*this)(rng);
+            _spare_bytes = 8 - unsigned(n);
+            for (; n != 0; --n, _spare >>= 8) {
+                *out++ = std::uint8_t(_spare);
+            }
+        }
+    }
+
+private:
+    std::uint64_t _threshold; // p in 0.64 fixed point
+    bool _all_ones;
+
+    std::uint64_t _spare;
+    unsigned _spare_bytes;
+};
+
+/**
+ * @brief Walker's alias table over the 256 byte values
+ *
+ * Sampling takes one 32 bit word: the top 8 bits select a column and the low 24 bits are compared
+ * with the column threshold. Thresholds are rounded to 24 bits, so the probability of each value
+ * differs from the requested one by less than 2^-25.
+ */
+struct byte_alias_table {
+    /**
+     * @param weights non-negative weights of the byte values, need not be normalized
+     */
+    explicit byte_alias_table(const std::array<double, 256> &weights);
+
+    std::uint8_t operator()(const std::uint32_t word) const {
+        const std::uint32_t column = word >> 24;
+        return (word & 0xFFFFFFu) < _threshold[column] ? std::uint8_t(column) : _alias[column];
+    }
+
+    /**
+     * Fills n bytes, one generator output per byte. The words are drawn first and the table
+     * lookups run as a separate branch free loop the compiler can vectorize.
+     */
+    template <typename Generator>
+    void fill(Generator &rng, std::uint8_t *out, std::size_t n) const {
+        std::array<std::uint32_t, batch_size> words;
+
+        while (n != 0) {
+            const std::size_t count = n < batch_size ? n : batch_size;
+            for (std::size_t i = 0; i < count; ++i) {
+                words[i] = std::uint32_t(rng());
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i] = (*this)(words[i]);
+            }
+            out += count;
+            n -= count;
+        }
+    }
+
+    /**
+     * @return probability of the value as represented by the table
+     */
+    double probability(std::uint8_t value) const;
+
+private:
+    static constexpr std::size_t batch_size = 256;
+
+    std::array<std::uint32_t, 256> _threshold;
+    std::array<std::uint8_t, 256> _alias;
+};
+
+} // namespace sampler
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * Helpers for the optional SIMD kernels.
+ *
+ * Kernels are compiled with per-function target attributes and selected at runtime, so the build
+ * does not need any -march flags and the binary still runs on machines without the extension.
+ * Every kernel has a portable fallback producing identical output.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STREAMS_X86_DISPATCH 1
+#define STREAMS_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+inline bool has_sse2() {
+#ifdef STREAMS_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("sse2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool has_avx2() {
+#ifdef STREAMS_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool has_bmi2() {
+#ifdef STREAMS_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("bmi2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace simd
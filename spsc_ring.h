@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free ring of slots between one producer and one consumer thread
+ *
+ * Slots are reused in place: the producer acquires a free slot, fills it and commits it, the
+ * consumer acquires the oldest committed slot, reads it and releases it. A full ring blocks the
+ * producer (backpressure), an empty ring blocks the consumer. Waiting spins briefly and then
+ * yields; close() wakes both sides up.
+ */
+template <typename T> class spsc_ring {
+public:
+    explicit spsc_ring(std::size_t capacity, const T &prototype = T())
+        : _slots(capacity, prototype)
+        , _head(0)
+        , _tail(0)
+        , _closed(false) {}
+
+    /**
+     * @return free slot for writing, nullptr if the ring was closed while waiting
+     */
+    T *acquire_write() {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (!wait([&] { return tail - _head.load(std::memory_order_acquire) < _slots.size(); }))
+            return nullptr;
+        return &_slots[tail % _slots.size()];
+    }
+
+    void commit_write() { _tail.fetch_add(1, std::memory_order_release); }
+
+    /**
+     * @return oldest committed slot, nullptr if the ring was closed while waiting
+     */
+    const T *acquire_read() {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (!wait([&] { return _tail.load(std::memory_order_acquire) != head; }))
+            return nullptr;
+        return &_slots[head % _slots.size()];
+    }
+
+    void release_read() { _head.fetch_add(1, std::memory_order_release); }
+
+    void close() { _closed.store(true, std::memory_order_release); }
+
+    bool closed() const { return _closed.load(std::memory_order_acquire); }
+
+private:
+    template <typename Ready> bool wait(Ready &&ready) const {
+        for (unsigned spins = 0; !ready(); ++spins) {
+            if (closed())
+                return false;
+            if (spins >= spin_limit)
+                std::this_thread::yield();
+        }
+        return true;
+    }
+
+    static constexpr unsigned spin_limit = 64;
+
+    std::vector<T> _slots;
+    // head and tail are on separate cache lines, each written by one side only
+    alignas(64) std::atomic<std::size_t> _head;
+    alignas(64) std::atomic<std::size_t> _tail;
+    alignas(64) std::atomic<bool> _closed;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "aligned_buffer.h"
 #include <eacirc-core/dataset.h>
 #include <eacirc-core/json.h>
 #include <eacirc-core/logger.h>
@@ -7,15 +8,47 @@
 #include <unordered_map>
 #include <vector>
 
-using value_type = std::uint8_t;
-using vec_cview = view<std::vector<value_type>::const_iterator>;
-using vec_view = view<std::vector<value_type>::iterator>;
+using vec_cview = view<const value_type *>;
+using vec_view = view<value_type *>;
 
 struct stream {
     virtual ~stream() = default;
 
     virtual vec_cview next() = 0;
 
+    /**
+     * @brief Writes the following count vectors one after another to out
+     *
+     * out has room for count * osize() bytes. Streams which can produce the vectors directly in
+     * place override this, by default they are copied from next().
+     */
+    virtual void next_batch(value_type *out, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            vec_cview vector = next();
+            out = std::copy(vector.begin(), vector.end(), out);
+        }
+    }
+
+    /**
+     * @brief Moves over the following count vectors without producing them
+     *
+     * The next call of next() returns the vector it would return after count more calls. Streams
+     * which can jump in their state override this, by default the vectors are generated and thrown
+     * away.
+     */
+    virtual void skip(std::uint64_t count) {
+        for (; count != 0; --count) {
+            next();
+        }
+    }
+
+    /**
+     * @brief Whether skip() jumps over the vectors instead of generating them
+     *
+     * Checkpoints resume by skipping the written vectors, which is fast only with such streams.
+     */
+    virtual bool seekable() const { return false; }
+
     vec_cview get_data() const { return make_cview(_data); }
 
     void set_data(vec_cview data) { std::copy(data.begin(), data.end(), _data.begin()); }
@@ -27,7 +60,9 @@ protected:
         : _data(osize)
         , _osize(osize) {}
 
-    std::vector<value_type> _data;
+    stream(stream &&) = default;
+
+    aligned_buffer _data; // in the arena of the tree, see aligned_buffer::arena_scope
 
 private:
     const std::size_t _osize;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "streams.h"
+#include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
+#include <string>
+
+/**
+ * @brief Type which cannot be further derived
+ *
+ * Calls of virtual functions on a sealed object, or through a reference to it, are resolved
+ * statically. Pipelines hold their ciphers, hash functions and leaf streams as sealed members.
+ */
+template <typename T> struct sealed final : T {
+    using T::T;
+};
+
+/**
+ * @brief Leaf stream which a compiled pipeline holds by value
+ *
+ * matches tells whether a stream config describes the stream, make builds it from the config and
+ * uses the seeder exactly as make_stream does.
+ */
+template <typename Stream> struct pipeline_leaf;
+
+template <> struct pipeline_leaf<counter> {
+    static bool matches(const json &config) { return config.at("type") == "counter"; }
+
+    static sealed<counter> make(const json &config, default_seed_source &, std::size_t osize) {
+        return sealed<counter>(config, osize);
+    }
+};
+
+template <> struct pipeline_leaf<pcg32_stream> {
+    static bool matches(const json &config) {
+        const std::string type = config.at("type");
+        return type == "pcg32_stream" || type == "random_stream";
+    }
+
+    static sealed<pcg32_stream>
+    make(const json &config, default_seed_source &seeder, std::size_t osize) {
+        return sealed<pcg32_stream>(seeder, osize, bool(config.value("bulk", false)));
+    }
+};
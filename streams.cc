@@ -1,23 +1,159 @@
 #include "streams.h"
+#include "bit_transpose.h"
+#include "combinators.h"
+#include "materialized_stream.h"
+#include "threaded_stream.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef BUILD_hash
+#include <streams/hash/hash_pipeline.h>
+#endif
+
+#ifdef BUILD_block
+#include <streams/block/block_pipeline.h>
+#endif
 
 file_stream::file_stream(const json &config, const std::size_t osize)
     : stream(osize)
     , _path(config.at("path").get<std::string>())
-    , _istream(_path, std::ios::binary) {}
+    , _offset(config.value("offset", std::uint64_t(0)))
+    , _stride(config.value("stride", std::uint64_t(osize)))
+    , _loop(config.value("loop", false))
+    , _fd(::open(_path.c_str(), O_RDONLY))
+    , _mapped(nullptr)
+    , _mapped_size(0)
+    , _vectors(0)
+    , _index(0) {
+    if (_fd == -1)
+        throw std::runtime_error("can't open file " + _path);
+    try {
+        open_file();
+    } catch (...) {
+        ::close(_fd);
+        throw;
+    }
+}
 
-vec_cview file_stream::next() {
-    _istream.read(reinterpret_cast<char *>(_data.data()), osize());
+void file_stream::open_file() {
+    if (_stride == 0)
+        throw std::runtime_error("stride of file " + _path + " has to be at least 1");
 
-    if (_istream.fail()) {
-        perror("stream failbit (or badbit). error state:");
+    struct stat info;
+    if (::fstat(_fd, &info) != 0)
         throw std::runtime_error("I/O error while reading a file " + _path);
+
+    if (!S_ISREG(info.st_mode)) {
+        if (_loop)
+            throw std::runtime_error("file " + _path + " is not a regular file and cannot loop");
+        if (_stride < osize())
+            throw std::runtime_error("stride of file " + _path +
+                                     " cannot be smaller than the output size");
+        _reader = std::make_unique<fd_reader>(_fd, "file " + _path);
+        _reader->read(nullptr, _offset);
+        return;
     }
-    if (_istream.eof())
-        throw std::runtime_error("end of file " + _path + " reached, not enough data!");
 
+    const auto size = std::uint64_t(info.st_size);
+    if (size >= _offset + osize())
+        _vectors = (size - _offset - osize()) / _stride + 1;
+    if (_loop && _vectors == 0)
+        throw std::runtime_error("file " + _path + " has no vector to loop over");
+    if (size == 0)
+        return;
+
+    _mapped_size = std::size_t(size);
+    void *mapped = ::mmap(nullptr, _mapped_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (mapped == MAP_FAILED)
+        throw std::runtime_error("can't map file " + _path);
+    ::madvise(mapped, _mapped_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    ::madvise(mapped, _mapped_size, MADV_HUGEPAGE);
+#endif
+    _mapped = static_cast<const value_type *>(mapped);
+}
+
+file_stream::~file_stream() {
+    if (_mapped)
+        ::munmap(const_cast<value_type *>(_mapped), _mapped_size);
+    if (_fd != -1)
+        ::close(_fd);
+}
+
+vec_cview file_stream::next() {
+    next_batch(_data.data(), 1);
     return make_cview(_data);
 }
 
+void file_stream::next_batch(value_type *out, std::size_t count) {
+    if (_reader && _stride == osize()) {
+        _reader->read(out, count * osize());
+        return;
+    }
+    for (; count != 0; --count, out += osize()) {
+        if (!_reader) {
+            copy_mapped(out);
+        } else {
+            _reader->read(out, osize());
+            _reader->read(nullptr, _stride - osize());
+        }
+    }
+}
+
+void file_stream::skip(std::uint64_t count) {
+    if (!_reader)
+        _index += count;
+    else
+        _reader->read(nullptr, count * _stride);
+}
+
+void file_stream::copy_mapped(value_type *out) {
+    if (_index >= _vectors) {
+        if (!_loop)
+            throw std::runtime_error("end of file " + _path + " reached, not enough data!");
+        _index %= _vectors;
+    }
+    std::memcpy(out, _mapped + _offset + _index * _stride, osize());
+    ++_index;
+}
+
+namespace {
+
+int stream_fd(const json &config) {
+    if (config.value("type", "") != "stdin_stream")
+        return config.value("fd", 0);
+    if (config.count("fd") != 0)
+        throw std::runtime_error("stdin_stream always reads the standard input, use fd_stream "
+                                 "for other descriptors");
+    return 0;
+}
+
+} // namespace
+
+fd_stream::fd_stream(const json &config, const std::size_t osize)
+    : stream(osize)
+    , _reader(stream_fd(config),
+              "file descriptor " + std::to_string(stream_fd(config)),
+              config.value("buffer_size", std::size_t(1) << 22)) {}
+
+vec_cview fd_stream::next() {
+    _reader.read(_data.data(), osize());
+    return make_cview(_data);
+}
+
+void fd_stream::next_batch(value_type *out, std::size_t count) {
+    _reader.read(out, count * osize());
+}
+
+void fd_stream::skip(std::uint64_t count) { _reader.read(nullptr, count * osize()); }
+
 single_value_stream::single_value_stream(
     const json &config,
     default_seed_source &seeder,
@@ -45,33 +181,113 @@ repeating_stream::repeating_stream(
 
 vec_cview repeating_stream::next() {
     if (_i % _period == 0) {
-        _data = _source->next().copy_to_vector();
+        set_data(_source->next());
     }
     ++_i;
     return make_cview(_data);
 }
 
 counter::counter(const std::size_t osize)
-    : stream(osize) {
-    std::fill(_data.begin(), _data.end(), std::numeric_limits<value_type>::min());
+    : counter(json::object(), osize) {}
+
+namespace {
+
+std::uint64_t counter_top_mask(const std::size_t width) {
+    const std::size_t top_bytes = width % 8;
+    return top_bytes == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (8 * top_bytes)) - 1;
 }
 
-vec_cview counter::next() {
-    for (value_type &value : _data) {
-        if (value != std::numeric_limits<value_type>::max()) {
-            ++value;
-            break;
+bool counter_big_endian(const json &config) {
+    const std::string endianness = config.value("endianness", "little");
+    if (endianness != "little" && endianness != "big")
+        throw std::runtime_error("counter endianness has to be \"little\" or \"big\"");
+    return endianness == "big";
+}
+
+} // namespace
+
+counter::counter(const json &config, const std::size_t osize)
+    : stream(osize)
+    , _width(config.value("width", osize))
+    , _big_endian(counter_big_endian(config))
+    , _stride(config.value("stride", std::uint64_t(1)))
+    , _top_mask(counter_top_mask(_width))
+    , _value((_width + 7) / 8, 0)
+    , _start(_value) {
+    if (_width > osize)
+        throw std::runtime_error("counter width is larger than its output size");
+    seek(config.value("offset", std::uint64_t(0)));
+}
+
+std::size_t counter::step() {
+    std::size_t i = 0;
+    if (_value.empty())
+        return i;
+
+    _value[0] += _stride;
+    bool carry = _value[0] < _stride;
+    while (carry && ++i < _value.size())
+        carry = ++_value[i] == 0;
+    i = std::min(i, _value.size() - 1);
+    _value.back() &= _top_mask;
+    return i;
+}
+
+void counter::store(value_type *out, const std::size_t first, const std::size_t last) const {
+    for (std::size_t w = first; w <= last && w < _value.size(); ++w) {
+        const std::size_t end = std::min(_width, 8 * w + 8);
+        for (std::size_t j = 8 * w; j < end; ++j) {
+            const auto byte = value_type(_value[w] >> (8 * (j - 8 * w)));
+            out[_big_endian ? _width - 1 - j : j] = byte;
         }
-        value = std::numeric_limits<value_type>::min();
     }
+}
+
+vec_cview counter::next() {
+    store(_data.data(), 0, step());
     return make_cview(_data);
 }
 
+void counter::next_batch(value_type *out, std::size_t count) {
+    for (; count != 0; --count, out += osize()) {
+        step();
+        store(out, 0, _value.size());
+        std::fill(out + _width, out + osize(), 0);
+    }
+}
+
+void counter::seek(const std::uint64_t n) { add(_start, n); }
+
+void counter::skip(const std::uint64_t count) { add(_value, count); }
+
+void counter::add(const std::vector<std::uint64_t> &base, const std::uint64_t n) {
+    // the product has at most two words
+    const auto product = static_cast<unsigned __int128>(n) * _stride;
+    unsigned __int128 carry = 0;
+    for (std::size_t i = 0; i < _value.size(); ++i) {
+        const std::uint64_t addend = i < 2 ? std::uint64_t(product >> (64 * i)) : 0;
+        const unsigned __int128 sum = carry + base[i] + addend;
+        _value[i] = std::uint64_t(sum);
+        carry = sum >> 64;
+    }
+    if (!_value.empty())
+        _value.back() &= _top_mask;
+    store(_data.data(), 0, _value.size());
+}
+
+void counter::set_start(vec_cview vector) {
+    std::fill(_start.begin(), _start.end(), 0);
+    for (std::size_t j = 0; j < _width; ++j) {
+        const value_type byte = vector.begin()[std::ptrdiff_t(_big_endian ? _width - 1 - j : j)];
+        _start[j / 8] |= std::uint64_t(byte) << (8 * (j % 8));
+    }
+    seek(0);
+}
+
 random_start_counter::random_start_counter(default_seed_source &seeder, const std::size_t osize)
     : counter(osize) {
     auto stream = std::make_unique<pcg32_stream>(seeder, osize);
-    vec_cview single_vector = stream->next();
-    std::copy(single_vector.begin(), single_vector.end(), _data.begin());
+    set_start(stream->next());
 }
 
 template <typename Seeder>
@@ -85,25 +301,15 @@ xor_stream::xor_stream(
 
 vec_cview xor_stream::next() {
     vec_cview in = _source->next();
-    auto first1 = in.begin();
-    const auto last = in.begin() + _data.size();
-    auto first2 = in.begin() + _data.size();
-    auto o_first = _data.begin();
-
-    while (first1 != last) {
-        *o_first++ = (*first1++ xor *first2++);
-    }
+    std::copy_n(in.begin(), _data.size(), _data.begin());
+    combine::accumulate(
+        combine::operation::xor_op, 1, _data.data(), &*in.begin() + _data.size(), _data.size());
 
     return make_cview(_data);
 }
 
 vec_cview hw_counter::next() {
-    std::copy_n(_origin_data.begin(), osize(), _data.begin());
-    for (const auto &pos : _cur_positions) {
-        _data[pos / 8] ^= (1 << (pos % 8));
-    }
-
-    if (!combination_next()) {
+    if (_started && !combination_next()) {
         if (_increase_hw) {
             _cur_hw += 1;
         } else if (_randomize_overflow) {
@@ -116,10 +322,141 @@ vec_cview hw_counter::next() {
 
         combination_init();
     }
+    _started = true;
 
     return make_cview(_data);
 }
 
+void hw_counter::seek(std::uint64_t index) {
+    const std::size_t bits = osize() * 8;
+
+    _cur_hw = _start_hw;
+    if (_increase_hw) {
+        // the weights follow each other up to all ones, then start again from one
+        for (std::uint64_t count = binomial(bits, _cur_hw); index >= count;
+             count = binomial(bits, _cur_hw)) {
+            index -= count;
+            _cur_hw = _cur_hw == bits ? 1 : _cur_hw + 1;
+        }
+    } else {
+        index %= binomial(bits, _cur_hw);
+    }
+
+    combination_set(unrank(index, bits, _cur_hw));
+}
+
+std::uint64_t hw_counter::binomial(std::size_t n, std::size_t k) {
+    if (k > n)
+        return 0;
+    k = std::min(k, n - k);
+
+    std::uint64_t result = 1;
+    for (std::size_t i = 1; i <= k; ++i) {
+        // binomial(n - k + i, i), the division is exact
+        const auto product = static_cast<unsigned __int128>(result) * (n - k + i) / i;
+        if (product > std::numeric_limits<std::uint64_t>::max())
+            return std::numeric_limits<std::uint64_t>::max();
+        result = static_cast<std::uint64_t>(product);
+    }
+    return result;
+}
+
+std::uint64_t hw_counter::rank(const std::vector<std::size_t> &positions, std::size_t bits) {
+    // the combinations before are those with a smaller position at the first differing place,
+    // binomial(bits - 1 - c, k - 1) of them for each smaller position c
+    const std::size_t hw = positions.size();
+    std::uint64_t index = 0;
+    std::size_t c = 0;
+    for (std::size_t i = 0; i < hw; ++i, ++c) {
+        for (; c < positions[i]; ++c) {
+            const std::uint64_t skipped = binomial(bits - 1 - c, hw - i - 1);
+            index = skipped > std::numeric_limits<std::uint64_t>::max() - index
+                        ? std::numeric_limits<std::uint64_t>::max()
+                        : index + skipped;
+        }
+    }
+    return index;
+}
+
+std::vector<std::size_t> hw_counter::unrank(std::uint64_t index, std::size_t bits, std::size_t hw) {
+    // a saturated count is larger than any index
+    const std::uint64_t count = binomial(bits, hw);
+    if (count != std::numeric_limits<std::uint64_t>::max() && index >= count)
+        throw std::runtime_error("hw_counter index is out of range");
+
+    // the positions only grow, so this takes at most bits binomials; saturated ones are larger
+    // than the index and end the search for their position
+    std::vector<std::size_t> positions(hw);
+    std::size_t c = 0;
+    for (std::size_t i = 0; i < hw; ++i, ++c) {
+        for (;; ++c) {
+            const std::uint64_t with_c = binomial(bits - 1 - c, hw - i - 1);
+            if (index < with_c)
+                break;
+            index -= with_c;
+        }
+        positions[i] = c;
+    }
+    return positions;
+}
+
+void hw_counter::combination_set(const std::vector<std::size_t> &positions) {
+    _mask.assign((osize() * 8 + 63) / 64, 0);
+    std::copy_n(_origin_data.begin(), osize(), _data.begin());
+    for (const std::size_t position : positions)
+        flip(position);
+    _top = positions.back();
+    _started = false;
+}
+
+void hw_counter::combination_init() {
+    std::vector<std::size_t> positions(_cur_hw);
+    std::iota(positions.begin(), positions.end(), 0);
+    combination_set(positions);
+}
+
+bool hw_counter::combination_next() {
+    const std::size_t bits = osize() * 8;
+
+    // common case, the last position moves by one
+    if (_top + 1 < bits) {
+        flip(_top);
+        flip(++_top);
+        return true;
+    }
+
+    // the last t positions are at the end, the position below them moves by one and they follow it
+    std::size_t tail = 0;
+    while (tail < _cur_hw && is_set(bits - 1 - tail))
+        ++tail;
+    if (tail == _cur_hw)
+        return false;
+
+    std::size_t p = bits - 1 - tail;
+    std::size_t word = p / 64;
+    std::uint64_t below = _mask[word] & (~std::uint64_t(0) >> (63 - p % 64));
+    while (below == 0)
+        below = _mask[--word];
+    p = 64 * word + 63 - std::size_t(__builtin_clzll(below));
+
+    flip(p);
+    for (std::size_t i = 0; i < tail; ++i)
+        flip(bits - 1 - i);
+    for (std::size_t i = 1; i <= tail + 1; ++i)
+        flip(p + i);
+    _top = p + tail + 1;
+    return true;
+}
+
+void hw_counter::flip(std::size_t position) {
+    _mask[position / 64] ^= std::uint64_t(1) << (position % 64);
+    _data[position / 8] ^= value_type(1 << (position % 8));
+}
+
+bool hw_counter::is_set(std::size_t position) const {
+    return (_mask[position / 64] >> (position % 64)) & 1;
+}
+
 column_stream::column_stream(
     const json &config,
     default_seed_source &seeder,
@@ -127,37 +464,90 @@ column_stream::column_stream(
     const std::size_t osize)
     : stream(osize)
     , _internal_bit_size(std::size_t(config.at("size")) * 8)
-    , _buf(_internal_bit_size)
+    , _input(_internal_bit_size * osize)
+    , _buf(_internal_bit_size * osize)
     , _position(0)
-    , _source(make_stream(config.at("source"), seeder, pipes, _internal_bit_size / 8)) {
-    for (auto &v : _buf)
-        v.resize(osize);
-}
+    , _source(make_stream(config.at("source"), seeder, pipes, _internal_bit_size / 8)) {}
 
 vec_cview column_stream::next() {
     // regenerate the buffer
     if ((_position % _internal_bit_size) == 0) {
         _position = 0;
 
-        // memset _buf to 0; change to STL?
-        for (auto &vec : _buf)
-            for (auto &val : vec)
-                val = 0;
+        const std::size_t row_bytes = _internal_bit_size / 8;
+        // streams producing in place write the rows directly, without a copy from next()
+        _source->next_batch(_input.data(), osize() * 8);
+        // column j of the collected vectors becomes row j of the buffer
+        bit_transpose::transpose(_input.data(), osize() * 8, row_bytes, _buf.data());
+    }
+
+    const value_type *row = _buf.data() + _position++ * osize(); // return and increment
+    std::copy(row, row + osize(), _data.begin());
+    return make_cview(_data);
+}
+
+columns_stream::columns_stream(
+    const json &config,
+    default_seed_source &seeder,
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+    const std::size_t osize)
+    : stream(osize)
+    , _internal_bit_size(std::size_t(config.at("size")) * 8)
+    , _positions(read_positions(config.at("positions"), _internal_bit_size))
+    , _interleaved(config.value("layout", "sequential") == "interleaved")
+    , _input(_internal_bit_size * osize)
+    , _columns(_internal_bit_size * osize)
+    , _output(_positions.size() * osize)
+    , _next(0)
+    , _source(make_stream(config.at("source"), seeder, pipes, _internal_bit_size / 8)) {
+    const std::string layout = config.value("layout", "sequential");
+    if (layout != "sequential" && layout != "interleaved")
+        throw std::runtime_error("requested columns layout \"" + layout + "\" does not exist");
+}
+
+std::vector<std::size_t> columns_stream::read_positions(const json &positions,
+                                                        const std::size_t bit_size) {
+    std::vector<std::size_t> result;
+    if (positions.is_array()) {
+        for (const json &position : positions)
+            result.push_back(std::size_t(position));
+    } else {
+        const std::size_t from = std::size_t(positions.at("from"));
+        const std::size_t count = std::size_t(positions.at("count"));
+        for (std::size_t i = 0; i < count; ++i)
+            result.push_back(from + i);
+    }
 
-        for (std::size_t i = 0; i < osize() * 8; ++i) {
-            auto vec = _source->next().data();
+    if (result.empty())
+        throw std::runtime_error("columns stream needs at least one position");
+    for (const std::size_t position : result)
+        if (position >= bit_size)
+            throw std::runtime_error("column position " + std::to_string(position) +
+                                     " is outside of the source vector");
+    return result;
+}
 
-            // something like matrix transposition
-            for (std::size_t j = 0; j < _internal_bit_size; ++j) {
-                // select current bit (&), move it as least significant (>>) and then move it to the
-                // position given by _i_ - which column you should store to
-                _buf[j][i / 8] |= ((vec[j / 8] & (0x1 << (7 - (j % 8)))) >> (7 - (j % 8)))
-                                  << (7 - (i % 8));
+vec_cview columns_stream::next() {
+    if (_next == 0) {
+        const std::size_t row_bytes = _internal_bit_size / 8;
+        _source->next_batch(_input.data(), osize() * 8);
+        bit_transpose::transpose(_input.data(), osize() * 8, row_bytes, _columns.data());
+
+        const std::size_t count = _positions.size();
+        for (std::size_t k = 0; k < count; ++k) {
+            const value_type *column = _columns.data() + _positions[k] * osize();
+            if (_interleaved) {
+                for (std::size_t b = 0; b < osize(); ++b)
+                    _output[b * count + k] = column[b];
+            } else {
+                std::copy_n(column, osize(), _output.data() + k * osize());
             }
         }
     }
 
-    return make_cview(_buf[_position++]); // return and increment
+    std::copy_n(_output.data() + _next * osize(), osize(), _data.begin());
+    _next = (_next + 1) % _positions.size();
+    return make_cview(_data);
 }
 
 column_fixed_position_stream::column_fixed_position_stream(
@@ -186,6 +576,92 @@ vec_cview column_fixed_position_stream::next() {
     return make_cview(_data); // return and increment
 }
 
+bool use_fast_sampler(const json &config, const std::string &fast_sampler) {
+    const std::string name = config.value("sampler", "std");
+    if (name == "std")
+        return false;
+    if (name == fast_sampler)
+        return true;
+    throw std::runtime_error("requested sampler \"" + name + "\" is not available for " +
+                             config.value("type", std::string("this distribution")));
+}
+
+std::array<double, 256> binomial_distribution_stream::binomial_weights(const unsigned trials,
+                                                                       const double p) {
+    if (!(p >= 0.0 && p <= 1.0))
+        throw std::runtime_error("Probability p has to be in range [0, 1].");
+
+    std::array<double, 256> weights;
+    weights.fill(0.0);
+    if (p == 0.0 || p == 1.0) {
+        weights[p == 0.0 ? 0 : trials] = 1.0;
+        return weights;
+    }
+
+    const double log_p = std::log(p);
+    const double log_q = std::log1p(-p);
+    for (unsigned k = 0; k <= trials; ++k) {
+        weights[k] = std::exp(std::lgamma(trials + 1.0) - std::lgamma(k + 1.0) -
+                              std::lgamma(trials - k + 1.0) + k * log_p + (trials - k) * log_q);
+    }
+    return weights;
+}
+
+std::array<double, 256> normal_distribution_stream::normal_weights(const double mean,
+                                                                   const double std_dev) {
+    if (!(std_dev > 0.0))
+        throw std::runtime_error("Standard deviation has to be positive.");
+
+    // upper tail probability of the unit normal distribution
+    const auto tail = [](double z) { return 0.5 * std::erfc(z / std::sqrt(2.0)); };
+    const double sigma_count = 4.0;
+    const double max = std::numeric_limits<uint8_t>::max();
+
+    // byte b is produced by values in [lo, hi), the cut at 4 standard deviations is around zero
+    std::array<double, 256> weights;
+    weights.fill(0.0);
+    for (unsigned b = 0; b < 255; ++b) {
+        const double lo = 2 * sigma_count * std_dev * (b / max - 0.5);
+        const double hi = 2 * sigma_count * std_dev * ((b + 1) / max - 0.5);
+        weights[b] = tail((lo - mean) / std_dev) - tail((hi - mean) / std_dev);
+    }
+
+    if (std::all_of(weights.begin(), weights.end(), [](double w) { return w <= 0.0; }))
+        throw std::runtime_error("Normal distribution has no mass within " +
+                                 std::to_string(int(sigma_count)) +
+                                 " standard deviations around zero.");
+    return weights;
+}
+
+std::array<double, 256> poisson_distribution_stream::poisson_weights(const double mean) {
+    if (!(mean > 0.0))
+        throw std::runtime_error("Mean of poisson distribution has to be positive.");
+
+    // std::poisson_distribution<uint8_t> rejects values above 255, so the distribution is truncated
+    std::array<double, 256> weights;
+    const double log_mean = std::log(mean);
+    for (unsigned k = 0; k < 256; ++k) {
+        weights[k] = std::exp(k * log_mean - mean - std::lgamma(k + 1.0));
+    }
+
+    if (std::all_of(weights.begin(), weights.end(), [](double w) { return w <= 0.0; }))
+        throw std::runtime_error("Poisson distribution has no mass below 256.");
+    return weights;
+}
+
+std::array<double, 256> exponential_distribution_stream::exponential_weights(const double lambda) {
+    if (!(lambda > 0.0))
+        throw std::runtime_error("Lambda of exponential distribution has to be positive.");
+
+    // P(floor(x) mod 256 == b) is proportional to exp(-lambda * b), the wrap of values above 255
+    // only scales all the weights by the same factor
+    std::array<double, 256> weights;
+    for (unsigned b = 0; b < 256; ++b) {
+        weights[b] = std::exp(-lambda * b);
+    }
+    return weights;
+}
+
 pipe_in_stream::pipe_in_stream(
     const nlohmann::json &config,
     default_seed_source &seeder,
@@ -195,19 +671,14 @@ pipe_in_stream::pipe_in_stream(
     std::string pipe_id = config.at("id");
 
     // substream has to be created in advance
-    // creating it separately in following if would cause inconsistances
+    // creating it separately after the lookup would cause inconsistances
     std::unique_ptr<stream> new_stream = make_stream(config.at("source"), seeder, pipes, osize);
 
-    auto search = pipes.find(pipe_id);
-    if (search == pipes.end()) {
-        // pipe_id is not yet in hashtable, create new entry
-        _source = std::make_shared<std::unique_ptr<stream>>(std::move(new_stream));
-        pipes[pipe_id] = _source;
-    } else {
-        // pipe_id is in hashtable, update the entry for pipe_out
-        *pipes[pipe_id] = std::move(new_stream);
-        _source = pipes[pipe_id];
-    }
+    _pipe = pipe_buffer::find(pipes, pipe_id);
+    _buffer = static_cast<pipe_buffer *>(_pipe->get());
+    _consumer = _buffer->set_source(std::move(new_stream),
+                                    config.value("ordered", false),
+                                    config.value("capacity", pipe_buffer::default_capacity));
 }
 
 tuple_stream::tuple_stream(
@@ -215,11 +686,114 @@ tuple_stream::tuple_stream(
     default_seed_source &seeder,
     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
     const std::size_t osize)
-    : stream(osize) {
+    : stream(osize)
+    , _parallel(config.value("parallel", false)) {
+    std::size_t offset = 0;
     for (const auto &stream_cfg : config.at("sources")) {
-        _sources.push_back(make_stream(
-            stream_cfg, seeder, pipes, std::size_t(stream_cfg.value("output_size", 0))));
+        const std::size_t size = std::size_t(stream_cfg.value("output_size", 0));
+        _sources.push_back(make_stream(stream_cfg, seeder, pipes, size));
+        _offsets.push_back(offset);
+        offset += size;
+    }
+    if (!_parallel)
+        return;
+    if (offset > osize)
+        throw std::runtime_error("sources of tuple_stream are longer than its output");
+
+    // sources sharing a pipe are merged into one group, groups keep the order of the sources
+    std::vector<std::set<std::string>> ids;
+    for (const auto &stream_cfg : config.at("sources")) {
+        std::set<std::string> in;
+        std::set<std::string> out;
+        collect_pipe_ids(stream_cfg, in, out);
+        in.insert(out.begin(), out.end());
+        ids.push_back(std::move(in));
+    }
+
+    std::vector<std::size_t> root(_sources.size());
+    for (std::size_t i = 0; i < _sources.size(); ++i) {
+        root[i] = i;
+        for (std::size_t j = 0; j < i; ++j) {
+            const bool shared = std::any_of(ids[i].begin(), ids[i].end(), [&](const std::string &id) {
+                return ids[j].count(id) != 0;
+            });
+            if (shared) {
+                // attach i's group to the earlier one, keeping the smallest index as the root
+                const std::size_t from = std::max(root[i], root[j]);
+                const std::size_t to = std::min(root[i], root[j]);
+                for (auto &r : root)
+                    if (r == from)
+                        r = to;
+            }
+        }
     }
+
+    std::vector<std::size_t> group_of(_sources.size());
+    for (std::size_t i = 0; i < _sources.size(); ++i) {
+        if (root[i] == i) {
+            group_of[i] = _groups.size();
+            _groups.emplace_back();
+        }
+        _groups[group_of[root[i]]].push_back(i);
+    }
+}
+
+void tuple_stream::next_parallel() {
+    work_stealing_pool::shared().parallel_for(_groups.size(), [this](std::size_t group) {
+        for (const std::size_t i : _groups[group]) {
+            vec_cview v = _sources[i]->next();
+            std::copy(v.begin(), v.end(), _data.begin() + std::ptrdiff_t(_offsets[i]));
+        }
+    });
+}
+
+void tuple_stream::skip(const std::uint64_t count) {
+    if (!seekable()) {
+        stream::skip(count);
+        return;
+    }
+    for (auto &source : _sources)
+        source->skip(count);
+}
+
+bool tuple_stream::seekable() const {
+    return std::all_of(_sources.begin(), _sources.end(), [](const std::unique_ptr<stream> &source) {
+        return source->seekable();
+    });
+}
+
+void collect_pipe_ids(const json &config, std::set<std::string> &in, std::set<std::string> &out) {
+    if (config.is_object()) {
+        const auto type = config.find("type");
+        if (type != config.end() && type->is_string()) {
+            if (*type == "pipe_in_stream")
+                in.insert(config.at("id").get<std::string>());
+            else if (*type == "pipe_out_stream")
+                out.insert(config.at("id").get<std::string>());
+        }
+    }
+    if (config.is_object() || config.is_array()) {
+        for (const json &child : config)
+            collect_pipe_ids(child, in, out);
+    }
+}
+
+std::vector<std::size_t> round_taps(const json &config) {
+    auto taps_it = config.find("round_taps");
+    if (taps_it == config.end())
+        return {};
+
+    std::vector<std::size_t> taps;
+    for (const json &tap : *taps_it) {
+        if (int(tap) < 0)
+            throw std::runtime_error("The least number of rounds is 0.");
+        if (!taps.empty() && std::size_t(tap) <= taps.back())
+            throw std::runtime_error("Round taps have to be in ascending order.");
+        taps.push_back(std::size_t(tap));
+    }
+    if (taps.empty())
+        throw std::runtime_error("Round taps need at least one round.");
+    return taps;
 }
 
 std::unique_ptr<stream>
@@ -238,26 +812,31 @@ make_stream(const json &config,
         return std::make_unique<dummy_stream>(osize);
     else if (type == "file_stream")
         return std::make_unique<file_stream>(config, osize);
+    else if (type == "fd_stream" or type == "stdin_stream")
+        return std::make_unique<fd_stream>(config, osize);
     else if (type == "true_stream")
         return std::make_unique<true_stream>(osize);
     else if (type == "false_stream")
         return std::make_unique<false_stream>(osize);
     else if (type == "mt19937_stream")
-        return std::make_unique<mt19937_stream>(seeder, osize);
+        return std::make_unique<mt19937_stream>(seeder, osize, bool(config.value("bulk", false)));
     else if (type == "pcg32_stream" or type == "random_stream")
-        return std::make_unique<pcg32_stream>(seeder, osize);
+        return std::make_unique<pcg32_stream>(seeder, osize, bool(config.value("bulk", false)));
+    else if (type == "pcg32x8_stream")
+        return std::make_unique<pcg32x8_stream>(seeder, osize);
 
     else if (type == "counter")
-        return std::make_unique<counter>(osize);
+        return std::make_unique<counter>(config, osize);
     else if (type == "random_start_counter")
         return std::make_unique<random_start_counter>(seeder, osize);
     else if (type == "sac")
-        return std::make_unique<sac_stream>(seeder, osize);
+        return std::make_unique<sac_stream>(seeder, osize, bool(config.value("bulk", false)));
     else if (type == "sac_fixed_position") {
         const std::size_t pos = std::size_t(config.at("position"));
-        return std::make_unique<sac_fixed_pos_stream>(seeder, osize, pos);
+        return std::make_unique<sac_fixed_pos_stream>(
+            seeder, osize, pos, bool(config.value("bulk", false)));
     } else if (type == "sac_2d_all_positions")
-        return std::make_unique<sac_2d_all_pos>(seeder, osize);
+        return std::make_unique<sac_2d_all_pos>(seeder, osize, bool(config.value("bulk", false)));
     else if (type == "hw_counter")
         return std::make_unique<hw_counter>(config, seeder, osize);
 
@@ -287,11 +866,21 @@ make_stream(const json &config,
     else if (type == "pipe_out_stream")
         return std::make_unique<pipe_out_stream>(config, pipes);
 
+    // execution
+    else if (type == "threaded_stream")
+        return std::make_unique<threaded_stream>(config, seeder, pipes, osize);
+    else if (type == "materialize")
+        return std::make_unique<materialized_stream>(config, seeder, pipes, osize);
+
     // postprocessing modifiers -- streams that has cipher stream as an input
     else if (type == "xor_stream")
         return std::make_unique<xor_stream>(config, seeder, pipes, osize);
+    else if (type == "combine")
+        return std::make_unique<combinator_stream>(config, seeder, pipes, osize);
     else if (type == "column")
         return std::make_unique<column_stream>(config, seeder, pipes, osize);
+    else if (type == "columns")
+        return std::make_unique<columns_stream>(config, seeder, pipes, osize);
     else if (type == "column_fixed_position") {
         const std::size_t pos = std::size_t(config.at("position"));
         return std::make_unique<column_fixed_position_stream>(config, seeder, pipes, osize, pos);
@@ -309,12 +898,18 @@ make_stream(const json &config,
         return std::make_unique<stream_ciphers::stream_stream>(config, seeder, pipes, osize);
 #endif
 #ifdef BUILD_hash
-    else if (type == "hash" || type == "sha3")
+    else if (type == "hash" || type == "sha3") {
+        if (auto compiled = hash::compile_hash_stream(config, seeder, osize))
+            return compiled;
         return std::make_unique<hash::hash_stream>(config, seeder, pipes, osize);
+    }
 #endif
 #ifdef BUILD_block
-    else if (type == "block")
+    else if (type == "block") {
+        if (auto compiled = block::compile_block_stream(config, seeder, pipes, osize))
+            return compiled;
         return std::make_unique<block::block_stream>(config, seeder, pipes, osize);
+    }
 #endif
 #ifdef BUILD_prngs
     else if (type == "prng")
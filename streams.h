@@ -1,11 +1,17 @@
 #pragma once
 
+#include "aligned_buffer.h"
+#include "fd_reader.h"
+#include "pcg32x8.h"
+#include "pipe_buffer.h"
+#include "samplers.h"
 #include "stream.h"
 #include <eacirc-core/json.h>
 #include <eacirc-core/optional.h>
 #include <eacirc-core/random.h>
 #include <fstream>
 #include <random>
+#include <set>
 
 #ifdef BUILD_testsuite
 #include <testsuite/test_utils/test_streams.h>
@@ -36,23 +42,126 @@ template <std::uint8_t value> struct const_stream : stream {
     }
 
     vec_cview next() override { return make_cview(_data); }
+
+    void skip(std::uint64_t) override {}
+
+    bool seekable() const override { return true; }
+};
+
+/**
+ * @brief Number of random bytes in one output of the generator
+ */
+template <typename Generator> constexpr unsigned generator_bytes() {
+    static_assert(Generator::min() == 0, "generator has to produce values from zero");
+    unsigned bytes = 0;
+    for (auto max = std::uint64_t(Generator::max()); max != 0; max >>= 8) {
+        ++bytes;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Whether discard() of the generator jumps ahead instead of stepping through the outputs
+ */
+template <typename Generator> struct discard_jumps : std::false_type {};
+template <> struct discard_jumps<pcg32> : std::true_type {};
+
+/**
+ * @brief Source of uniformly distributed bytes drawn from a generator
+ *
+ * Compatible mode draws every byte through std::uniform_int_distribution, which keeps the exact
+ * bytes of older configurations. Bulk mode emits all bytes of each generator output in little
+ * endian order; bytes left from the last output are used first by the following call.
+ */
+template <typename Generator> struct uniform_bytes {
+    uniform_bytes(const bool bulk)
+        : _bulk(bulk)
+        , _spare(0)
+        , _spare_count(0) {}
+
+    void operator()(Generator &rng, value_type *out, std::size_t n) {
+        if (!_bulk) {
+            std::generate_n(
+                out, n, [&rng]() { return std::uniform_int_distribution<std::uint8_t>()(rng); });
+            return;
+        }
+
+        for (; n != 0 && _spare_count != 0; --n, --_spare_count, _spare >>= 8) {
+            *out++ = value_type(_spare);
+        }
+        for (; n >= bytes; n -= bytes, out += bytes) {
+            const auto value = std::uint64_t(rng());
+            for (unsigned i = 0; i < bytes; ++i) {
+                out[i] = value_type(value >> (8 * i));
+            }
+        }
+        if (n != 0) {
+            _spare = std::uint64_t(rng());
+            _spare_count = bytes - unsigned(n);
+            for (; n != 0; --n, _spare >>= 8) {
+                *out++ = value_type(_spare);
+            }
+        }
+    }
+
+    /**
+     * Moves over n bytes. Bulk mode discards whole generator outputs at once, which takes
+     * logarithmic time for generators with a jump-ahead discard (such as pcg32).
+     */
+    void skip(Generator &rng, std::uint64_t n) {
+        if (!_bulk) {
+            for (; n != 0; --n) {
+                std::uniform_int_distribution<std::uint8_t>()(rng);
+            }
+            return;
+        }
+
+        const std::uint64_t carried = std::min<std::uint64_t>(n, _spare_count);
+        _spare = carried == bytes ? 0 : _spare >> (8 * carried);
+        _spare_count -= unsigned(carried);
+        n -= carried;
+
+        rng.discard(n / bytes);
+        n %= bytes;
+
+        if (n != 0) {
+            _spare = std::uint64_t(rng()) >> (8 * n);
+            _spare_count = bytes - unsigned(n);
+        }
+    }
+
+    /**
+     * Whether skip() takes time independent of n
+     */
+    bool jumps() const { return _bulk && discard_jumps<Generator>::value; }
+
+private:
+    static constexpr unsigned bytes = generator_bytes<Generator>();
+
+    const bool _bulk;
+    std::uint64_t _spare;
+    unsigned _spare_count;
 };
 
 template <typename Generator> struct rng_stream : stream {
     template <typename Seeder>
-    rng_stream(Seeder &&seeder, const std::size_t osize)
+    rng_stream(Seeder &&seeder, const std::size_t osize, const bool bulk = false)
         : stream(osize)
-        , _rng(std::forward<Seeder>(seeder)) {}
+        , _rng(std::forward<Seeder>(seeder))
+        , _bytes(bulk) {}
 
     vec_cview next() override {
-        std::generate_n(_data.data(), osize(), [this]() {
-            return std::uniform_int_distribution<std::uint8_t>()(_rng);
-        });
+        _bytes(_rng, _data.data(), osize());
         return make_cview(_data);
     }
 
+    void skip(std::uint64_t count) override { _bytes.skip(_rng, count * osize()); }
+
+    bool seekable() const override { return _bytes.jumps(); }
+
 private:
     Generator _rng;
+    uniform_bytes<Generator> _bytes;
 };
 
 } // namespace _impl
@@ -65,19 +174,78 @@ struct dummy_stream : stream {
         : stream(osize) {}
 
     vec_cview next() override { return make_cview(_data); }
+
+    void skip(std::uint64_t) override {}
+
+    bool seekable() const override { return true; }
 };
 
 /**
  * @brief Stream of data read from a file
+ *
+ * Vector i starts at byte "offset" + i * "stride" of the file ("offset" defaults to 0, "stride" to
+ * the output size). Regular files are memory mapped for sequential reading, with a huge page hint,
+ * and with "loop" the vectors start over from the offset after the last whole vector of the file.
+ * Pipes and other special files are read through a large buffer; they cannot loop and their
+ * stride has to be at least the output size. Reading past the end of the file throws.
  */
 struct file_stream : stream {
     file_stream(const json &config, const std::size_t osize);
+    ~file_stream() override;
 
     vec_cview next() override;
 
+    void next_batch(value_type *out, std::size_t count) override;
+
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override { return !_reader; }
+
 private:
+    /**
+     * Maps a regular file, or sets up the buffer of a special file
+     */
+    void open_file();
+
+    /**
+     * Copies the next vector of the mapped file
+     */
+    void copy_mapped(value_type *out);
+
     const std::string _path;
-    std::ifstream _istream;
+    const std::uint64_t _offset;
+    const std::uint64_t _stride;
+    const bool _loop;
+    int _fd;
+
+    const value_type *_mapped;
+    std::size_t _mapped_size;
+    std::uint64_t _vectors; // whole vectors in the mapped file
+    std::uint64_t _index;
+
+    std::unique_ptr<fd_reader> _reader; // special files
+};
+
+/**
+ * @brief Stream of data read from an open file descriptor, the standard input by default
+ *
+ * "fd" selects the descriptor, which is not closed by the stream. The type "stdin_stream" always
+ * reads the standard input and rejects "fd". The data are read with large read(2) calls through a
+ * buffer of "buffer_size" bytes (4 MiB by default), batches of vectors larger than the buffer are
+ * read straight into their destination. The end of the data is an error. Placing the stream into
+ * a threaded_stream overlaps reading with the following stages.
+ */
+struct fd_stream : stream {
+    fd_stream(const json &config, const std::size_t osize);
+
+    vec_cview next() override;
+
+    void next_batch(value_type *out, std::size_t count) override;
+
+    void skip(std::uint64_t count) override;
+
+private:
+    fd_reader _reader;
 };
 
 /**
@@ -113,11 +281,58 @@ struct single_value_stream : stream {
 
 /**
  * @brief Stream of counter
+ *
+ * The counter occupies the first "width" bytes of the vector (all of it by default) in "little"
+ * (default) or "big" endian byte order, the rest of the vector is zero. Each vector adds "stride"
+ * (default 1) to the value modulo 2^(8 * width), the first vector holds the start value plus one
+ * stride. The value is kept in 64 bit words, so a step updates a byte only when its word changes.
  */
 struct counter : stream {
     counter(const std::size_t osize);
+    counter(const json &config, const std::size_t osize);
 
     vec_cview next() override;
+
+    void next_batch(value_type *out, std::size_t count) override;
+
+    /**
+     * @brief Moves to the vector which the (n + 1)-th call of next() returns on a new counter
+     */
+    void seek(std::uint64_t n);
+
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override { return true; }
+
+protected:
+    /**
+     * Sets the start value to the one of a vector of this counter
+     */
+    void set_start(vec_cview vector);
+
+private:
+    /**
+     * Adds the stride
+     * @return index of the highest changed word
+     */
+    std::size_t step();
+
+    /**
+     * Sets the value to base + n * stride, base may be the value itself
+     */
+    void add(const std::vector<std::uint64_t> &base, std::uint64_t n);
+
+    /**
+     * Writes bytes of the words first, ..., last of the value to a vector
+     */
+    void store(value_type *out, std::size_t first, std::size_t last) const;
+
+    const std::size_t _width;
+    const bool _big_endian;
+    const std::uint64_t _stride;
+    const std::uint64_t _top_mask; // valid bits of the last word
+    std::vector<std::uint64_t> _value;
+    std::vector<std::uint64_t> _start;
 };
 
 /**
@@ -139,6 +354,10 @@ struct xor_stream : stream {
 
     vec_cview next() override;
 
+    void skip(std::uint64_t count) override { _source->skip(count); }
+
+    bool seekable() const override { return _source->seekable(); }
+
 private:
     std::unique_ptr<stream> _source;
 };
@@ -153,16 +372,15 @@ private:
  */
 struct sac_stream : stream {
     template <typename Seeder>
-    sac_stream(Seeder &&seeder, const std::size_t osize)
+    sac_stream(Seeder &&seeder, const std::size_t osize, const bool bulk = false)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
+        , _bytes(bulk)
         , _first(true) {}
 
     vec_cview next() override {
         if (_first) {
-            std::generate_n(_data.data(), osize(), [this]() {
-                return std::uniform_int_distribution<std::uint8_t>()(_rng);
-            });
+            _bytes(_rng, _data.data(), osize());
         } else {
             std::uniform_int_distribution<std::size_t> dist{0, (osize() * 8) - 1};
             std::size_t pos = dist(_rng);
@@ -175,6 +393,7 @@ struct sac_stream : stream {
 
 private:
     pcg32 _rng;
+    _impl::uniform_bytes<pcg32> _bytes;
     bool _first;
 };
 
@@ -182,9 +401,11 @@ struct sac_fixed_pos_stream : stream {
     template <typename Seeder>
     sac_fixed_pos_stream(Seeder &&seeder,
                          const std::size_t osize,
-                         const std::size_t flip_bit_position)
+                         const std::size_t flip_bit_position,
+                         const bool bulk = false)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
+        , _bytes(bulk)
         , _flip_bit_position(flip_bit_position)
         , _first(true) {
         if (_flip_bit_position >= osize * 8)
@@ -194,9 +415,7 @@ struct sac_fixed_pos_stream : stream {
 
     vec_cview next() override {
         if (_first) {
-            std::generate_n(_data.data(), osize(), [this]() {
-                return std::uniform_int_distribution<std::uint8_t>()(_rng);
-            });
+            _bytes(_rng, _data.data(), osize());
         } else {
             _data[_flip_bit_position / 8] ^= (1 << (_flip_bit_position % 8));
         }
@@ -206,23 +425,23 @@ struct sac_fixed_pos_stream : stream {
 
 private:
     pcg32 _rng;
+    _impl::uniform_bytes<pcg32> _bytes;
     const std::size_t _flip_bit_position;
     bool _first;
 };
 
 struct sac_2d_all_pos : stream {
     template <typename Seeder>
-    sac_2d_all_pos(Seeder &&seeder, const std::size_t osize)
+    sac_2d_all_pos(Seeder &&seeder, const std::size_t osize, const bool bulk = false)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
+        , _bytes(bulk)
         , _origin_data(osize)
         , _flip_bit_position(0) {}
 
     vec_cview next() override {
         if (_flip_bit_position == 0) {
-            std::generate_n(_data.data(), osize(), [this]() {
-                return std::uniform_int_distribution<std::uint8_t>()(_rng);
-            });
+            _bytes(_rng, _data.data(), osize());
             std::copy_n(_data.begin(), osize(), _origin_data.begin());
         } else {
             std::copy_n(_origin_data.begin(), osize(), _data.begin());
@@ -237,11 +456,20 @@ struct sac_2d_all_pos : stream {
 
 private:
     pcg32 _rng;
+    _impl::uniform_bytes<pcg32> _bytes;
     // storing copy is not optimal, can be done faster with more conditions
     std::vector<value_type> _origin_data;
     std::size_t _flip_bit_position;
 };
 
+/**
+ * @brief Enumerates all vectors with a given Hamming weight, XORed to an origin vector
+ *
+ * Bit positions of one vector, c_0 < ... < c_{hw-1}, are enumerated in lexicographic order. Index
+ * of a vector in this order is computed and inverted in the combinatorial number system, which
+ * allows to seek to any vector in O(hw) binomials. A step to the following vector flips two bits
+ * in the common case and hw + 1 bits when the last positions reach the end of the vector.
+ */
 struct hw_counter : stream {
     template <typename Seeder>
     hw_counter(const json &config, Seeder &&seeder, const std::size_t osize)
@@ -250,7 +478,8 @@ struct hw_counter : stream {
         , _origin_data(osize)
         , _increase_hw(config.value("increase_hw", true))
         , _randomize_overflow(config.value("randomize_overflow", false))
-        , _cur_hw(static_cast<uint64_t>(config.value("hw", 1))) {
+        , _cur_hw(static_cast<uint64_t>(config.value("hw", 1)))
+        , _start_hw(_cur_hw) {
         bool randomize_start = config.value("randomize_start", false);
 
         if (_cur_hw == 0 || _cur_hw > osize * 8) {
@@ -268,6 +497,9 @@ struct hw_counter : stream {
         }
 
         combination_init();
+        const std::uint64_t offset = config.value("offset", std::uint64_t(0));
+        if (offset != 0)
+            seek(offset);
     }
 
     hw_counter(const std::size_t osize)
@@ -276,7 +508,8 @@ struct hw_counter : stream {
             , _origin_data(osize)
             , _increase_hw(true)
             , _randomize_overflow(false)
-            , _cur_hw(1) {
+            , _cur_hw(1)
+            , _start_hw(1) {
         if (_cur_hw == 0 || _cur_hw > osize * 8) {
             throw std::runtime_error("Invalid Hamming weight for the given output size");
         }
@@ -292,6 +525,30 @@ struct hw_counter : stream {
 
     vec_cview next() override;
 
+    /**
+     * @brief Moves to the vector which the index-th call of next() returns on a new counter
+     *
+     * The random overflow mode keeps the current origin vector, as its sequence depends on the
+     * generator.
+     */
+    void seek(std::uint64_t index);
+
+    /**
+     * @return binomial coefficient, saturated at the largest std::uint64_t
+     */
+    static std::uint64_t binomial(std::size_t n, std::size_t k);
+
+    /**
+     * @return lexicographic index of the sorted positions among all hw-subsets of {0, ..., bits - 1},
+     * saturated at the largest std::uint64_t
+     */
+    static std::uint64_t rank(const std::vector<std::size_t> &positions, std::size_t bits);
+
+    /**
+     * @return sorted positions with the given lexicographic index, inverse of rank
+     */
+    static std::vector<std::size_t> unrank(std::uint64_t index, std::size_t bits, std::size_t hw);
+
 private:
     void randomize() {
         std::generate_n(_origin_data.data(), osize(), [this]() {
@@ -299,40 +556,25 @@ private:
         });
     }
 
-    void combination_init() {
-        _cur_positions.clear();
-        for (std::size_t i = 0; i < _cur_hw; ++i) {
-            _cur_positions.push_back(i);
-        }
-    }
-
-    bool combination_next() {
-        const auto size = static_cast<int64_t>(_cur_positions.size());
-        auto idx = size - 1;
-
-        if (_cur_positions[idx] == osize() * 8 - 1) {
-            do {
-                idx -= 1;
-            } while (idx >= 0 && _cur_positions[idx] + 1 == _cur_positions[idx + 1]);
-
-            if (idx < 0) {
-                return false;
-            }
-
-            for (auto j = idx + 1; j < size; ++j) {
-                _cur_positions[j] = _cur_positions[idx] + j - idx + 1;
-            }
-        }
-        _cur_positions[idx]++;
-        return true;
-    }
+    /**
+     * Sets the combination to the given sorted positions and rebuilds the output from the origin
+     */
+    void combination_set(const std::vector<std::size_t> &positions);
+    void combination_init();
+    bool combination_next();
+    void flip(std::size_t position);
+    bool is_set(std::size_t position) const;
 
     pcg32 _rng;
     std::vector<value_type> _origin_data;
     const bool _increase_hw;
     const bool _randomize_overflow;
     std::size_t _cur_hw;
-    std::vector<std::size_t> _cur_positions;
+    const std::size_t _start_hw;
+
+    std::vector<std::uint64_t> _mask; // bit c of the combination in bit c % 64 of word c / 64
+    std::size_t _top;                 // highest position of the combination
+    bool _started;                    // the current combination was returned by next()
 };
 
 struct column_stream : stream {
@@ -345,12 +587,43 @@ struct column_stream : stream {
 
 private:
     std::size_t _internal_bit_size;
-    std::vector<std::vector<value_type>>
-        _buf; // change to array (maxe osize() constexpression), or init it to given size
+    aligned_buffer _input; // osize() * 8 source vectors, one per row
+    aligned_buffer _buf;   // one row of osize() bytes per bit column
     std::size_t _position;
     std::unique_ptr<stream> _source;
 };
 
+/**
+ * @brief Columns at selected bit positions of the source, all from one pass over it
+ *
+ * Like column_stream, osize() * 8 source vectors of "size" bytes make one batch, whose bit
+ * columns are obtained by a single transposition. The "positions" are a list of bit positions or
+ * a range {"from": first, "count": n}. Layout "sequential" (default) emits the columns one per
+ * vector in the order of the positions, so a single position gives the output of
+ * column_fixed_position_stream. Layout "interleaved" emits the first byte of every column, then
+ * the second byte of every column and so on.
+ */
+struct columns_stream : stream {
+    columns_stream(const json &config,
+                   default_seed_source &seeder,
+                   std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                   const std::size_t osize);
+
+    vec_cview next() override;
+
+private:
+    static std::vector<std::size_t> read_positions(const json &positions, std::size_t bit_size);
+
+    const std::size_t _internal_bit_size;
+    const std::vector<std::size_t> _positions;
+    const bool _interleaved;
+    aligned_buffer _input;   // osize() * 8 source vectors, one per row
+    aligned_buffer _columns; // one row of osize() bytes per bit column
+    aligned_buffer _output;  // the selected columns of the batch in the output layout
+    std::size_t _next;       // index of the next vector in _output
+    std::unique_ptr<stream> _source;
+};
+
 struct column_fixed_position_stream : stream {
     column_fixed_position_stream(
         const json &config,
@@ -366,17 +639,33 @@ private:
     std::unique_ptr<stream> _source;
 };
 
+/**
+ * @brief Checks the "sampler" of a distribution stream
+ * @return true for the fast sampler, false for the default "std"
+ */
+bool use_fast_sampler(const json &config, const std::string &fast_sampler);
+
 /**
  * @brief Stream with bits generated according to bernoulli distribution.
+ *
+ * Sampler "std" (default) draws each bit through std::bernoulli_distribution,
+ * sampler "bit_parallel" generates 64 bits at once from a few random words.
  */
 struct bernoulli_distribution_stream : stream {
     template <typename Seeder>
     bernoulli_distribution_stream(const json &config, Seeder &&seeder, const std::size_t osize)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
-        , _distribution(std::bernoulli_distribution(double(config.value("p", 0.5)))) {}
+        , _distribution(std::bernoulli_distribution(double(config.value("p", 0.5))))
+        , _bit_parallel(use_fast_sampler(config, "bit_parallel"))
+        , _words(_distribution.p()) {}
 
     vec_cview next() override {
+        if (_bit_parallel) {
+            _words.fill(_rng, _data.data(), osize());
+            return make_cview(_data);
+        }
+
         std::generate_n(_data.data(), osize(), [this]() {
             uint8_t out = 0;
             for (unsigned i = 0; i < 8; ++i) {
@@ -390,10 +679,15 @@ struct bernoulli_distribution_stream : stream {
 private:
     pcg32 _rng;
     std::bernoulli_distribution _distribution;
+    const bool _bit_parallel;
+    sampler::bernoulli_words _words;
 };
 
 /**
  * @brief Stream with bits generated according to binomial distribution.
+ *
+ * Sampler "std" (default) uses std::binomial_distribution, sampler "table"
+ * samples the exact probability mass function from a precomputed alias table.
  */
 struct binomial_distribution_stream : stream {
     template <typename Seeder>
@@ -401,31 +695,53 @@ struct binomial_distribution_stream : stream {
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
         , _distribution(uint8_t(config.value("max_value", std::numeric_limits<uint8_t>::max())),
-                        double(config.value("p", 0.5))) {}
+                        double(config.value("p", 0.5)))
+        , _table(use_fast_sampler(config, "table")
+                     ? std::make_unique<sampler::byte_alias_table>(
+                           binomial_weights(_distribution.t(), _distribution.p()))
+                     : nullptr) {}
 
     vec_cview next() override {
+        if (_table) {
+            _table->fill(_rng, _data.data(), osize());
+            return make_cview(_data);
+        }
+
         std::generate_n(_data.data(), osize(), [this]() { return _distribution(_rng); });
         return make_cview(_data);
     }
 
+    static std::array<double, 256> binomial_weights(unsigned trials, double p);
+
 private:
     pcg32 _rng;
     std::binomial_distribution<uint8_t> _distribution;
+    std::unique_ptr<sampler::byte_alias_table> _table;
 };
 
 /**
  * @brief Stream with bits generated according to normal distribution.
  *
  * Cutted distribution tails outside of 4 times standard deviation.
+ * Sampler "table" samples the resulting byte distribution from a precomputed alias table.
  */
 struct normal_distribution_stream : stream {
     template <typename Seeder>
     normal_distribution_stream(const json &config, Seeder &&seeder, const std::size_t osize)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
-        , _distribution(double(config.value("mean", 0)), double(config.value("std_dev", 1.0))) {}
+        , _distribution(double(config.value("mean", 0)), double(config.value("std_dev", 1.0)))
+        , _table(use_fast_sampler(config, "table")
+                     ? std::make_unique<sampler::byte_alias_table>(
+                           normal_weights(_distribution.mean(), _distribution.stddev()))
+                     : nullptr) {}
 
     vec_cview next() override {
+        if (_table) {
+            _table->fill(_rng, _data.data(), osize());
+            return make_cview(_data);
+        }
+
         std::generate_n(_data.data(), osize(), [this]() {
             double res;
             double sigma_count = 4.0;
@@ -440,53 +756,84 @@ struct normal_distribution_stream : stream {
         return make_cview(_data);
     }
 
+    static std::array<double, 256> normal_weights(double mean, double std_dev);
+
 private:
     pcg32 _rng;
     std::normal_distribution<double> _distribution;
+    std::unique_ptr<sampler::byte_alias_table> _table;
 };
 
 /**
  * @brief Stream with bits generated according to poisson distribution.
+ *
+ * Sampler "table" samples the resulting byte distribution from a precomputed alias table.
  */
 struct poisson_distribution_stream : stream {
     template <typename Seeder>
     poisson_distribution_stream(const json &config, Seeder &&seeder, const std::size_t osize)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
-        , _distribution(double(config.value("mean", std::numeric_limits<uint8_t>::max() / 2))) {}
+        , _distribution(double(config.value("mean", std::numeric_limits<uint8_t>::max() / 2)))
+        , _table(use_fast_sampler(config, "table")
+                     ? std::make_unique<sampler::byte_alias_table>(
+                           poisson_weights(_distribution.mean()))
+                     : nullptr) {}
 
     vec_cview next() override {
+        if (_table) {
+            _table->fill(_rng, _data.data(), osize());
+            return make_cview(_data);
+        }
+
         std::generate_n(_data.data(), osize(), [this]() { return _distribution(_rng); });
         return make_cview(_data);
     }
 
+    static std::array<double, 256> poisson_weights(double mean);
+
 private:
     pcg32 _rng;
     std::poisson_distribution<uint8_t> _distribution;
+    std::unique_ptr<sampler::byte_alias_table> _table;
 };
 
 /**
  * @brief Stream with bits generated according to exponential distribution.
+ *
+ * Sampler "table" samples the resulting byte distribution from a precomputed alias table.
  */
 struct exponential_distribution_stream : stream {
     template <typename Seeder>
     exponential_distribution_stream(const json &config, Seeder &&seeder, const std::size_t osize)
         : stream(osize)
         , _rng(std::forward<Seeder>(seeder))
-        , _distribution(double(config.value("lambda", 1))) {}
+        , _distribution(double(config.value("lambda", 1)))
+        , _table(use_fast_sampler(config, "table")
+                     ? std::make_unique<sampler::byte_alias_table>(
+                           exponential_weights(_distribution.lambda()))
+                     : nullptr) {}
 
     vec_cview next() override {
+        if (_table) {
+            _table->fill(_rng, _data.data(), osize());
+            return make_cview(_data);
+        }
+
         std::generate_n(_data.data(), osize(), [this]() { return uint8_t(_distribution(_rng)); });
         return make_cview(_data);
     }
 
+    static std::array<double, 256> exponential_weights(double lambda);
+
 private:
     pcg32 _rng;
     std::exponential_distribution<double> _distribution;
+    std::unique_ptr<sampler::byte_alias_table> _table;
 };
 
 /**
- * @brief Pipe's sink - stores pointer on the intersnal stream to
+ * @brief Pipe's sink - creates the internal stream and passes it to the pipe's buffer in
  * the pipes hashtable
  */
 struct pipe_in_stream : stream {
@@ -494,39 +841,36 @@ struct pipe_in_stream : stream {
                    default_seed_source &seeder,
                    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
                    const std::size_t osize);
+    ~pipe_in_stream() override { _buffer->remove_consumer(_consumer); }
 
-    vec_cview next() override { return (*_source)->next(); }
+    vec_cview next() override { return _buffer->read(_consumer); }
 
 private:
-    std::shared_ptr<std::unique_ptr<stream>> _source;
+    std::shared_ptr<std::unique_ptr<stream>> _pipe;
+    pipe_buffer *_buffer;
+    std::size_t _consumer;
 };
 
 /**
- * @brief Pipe's source
+ * @brief Pipe's source - reads the last vector of the pipe, or each vector in turn when the pipe is
+ * ordered (see pipe_buffer)
  */
 struct pipe_out_stream : stream {
     pipe_out_stream(
         const json &config,
         std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes)
-        : stream(0) {
-        std::string pipe_id = config.at("id");
-
-        auto search = pipes.find(pipe_id);
-        if (search == pipes.end()) {
-            // pipe_id is not yet in hashtable, create new empty entry
-            _source =
-                std::make_shared<std::unique_ptr<stream>>(std::unique_ptr<stream>(nullptr));
-            pipes[pipe_id] = _source;
-        } else {
-            // pipe_id is in hashtable, use ptr from pipe_in
-            _source = pipes[pipe_id];
-        }
-    }
+        : stream(0)
+        , _pipe(pipe_buffer::find(pipes, config.at("id")))
+        , _buffer(static_cast<pipe_buffer *>(_pipe->get()))
+        , _consumer(_buffer->add_consumer()) {}
+    ~pipe_out_stream() override { _buffer->remove_consumer(_consumer); }
 
-    vec_cview next() override { return (*_source)->get_data(); }
+    vec_cview next() override { return _buffer->read(_consumer); }
 
 private:
-    std::shared_ptr<std::unique_ptr<stream>> _source;
+    std::shared_ptr<std::unique_ptr<stream>> _pipe;
+    pipe_buffer *_buffer;
+    std::size_t _consumer;
 };
 
 /**
@@ -539,18 +883,41 @@ struct tuple_stream : stream {
                  const std::size_t osize);
 
     vec_cview next() override {
+        if (_parallel) {
+            next_parallel();
+            return make_cview(_data);
+        }
+
         auto beg = _data.begin();
         for (auto& source : _sources) {
             vec_cview v = source->next();
-            copy(v.begin(), v.end(), beg);
+            std::copy(v.begin(), v.end(), beg);
             beg += v.end() - v.begin();
         }
 
         return make_cview(_data);
     }
 
+    /**
+     * Skips in each source when all of them are seekable, otherwise the vectors are generated
+     */
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override;
+
 private:
+    /**
+     * Evaluates the groups of sources concurrently, sources connected by a pipe share a group and
+     * run in their order within it. Each source writes to its own slice of _data. Instances of one
+     * algorithm may run at once, so the algorithms keep no state in globals.
+     */
+    void next_parallel();
+
     std::vector<std::unique_ptr<stream>> _sources;
+
+    bool _parallel;
+    std::vector<std::size_t> _offsets;
+    std::vector<std::vector<std::size_t>> _groups;
 };
 
 /**
@@ -573,9 +940,44 @@ using mt19937_stream = _impl::rng_stream<std::mt19937>;
  */
 using pcg32_stream = _impl::rng_stream<pcg32>;
 
+/**
+ * \brief Stream of data produced by eight interleaved PCG generators
+ *
+ * Output is not compatible with pcg32_stream, use it for new configs needing fast random data.
+ */
+struct pcg32x8_stream : stream {
+    template <typename Seeder>
+    pcg32x8_stream(Seeder &&seeder, const std::size_t osize)
+        : stream(osize)
+        , _rng(std::forward<Seeder>(seeder)) {}
+
+    vec_cview next() override {
+        _rng.fill(_data.data(), osize());
+        return make_cview(_data);
+    }
+
+    void skip(std::uint64_t count) override { _rng.skip(count * osize()); }
+
+    bool seekable() const override { return true; }
+
+private:
+    pcg32x8 _rng;
+};
+
 std::unique_ptr<stream>
 make_stream(const json &config,
             default_seed_source &seeder,
             std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
             std::size_t osize);
 void stream_to_dataset(dataset &set, std::unique_ptr<stream> &source);
+
+/**
+ * @brief Collects ids of all pipe_in_stream and pipe_out_stream nodes in the config
+ */
+void collect_pipe_ids(const json &config, std::set<std::string> &in, std::set<std::string> &out);
+
+/**
+ * @brief Ascending round counts of the "round_taps" option, empty without it
+ */
+std::vector<std::size_t> round_taps(const json &config);
+
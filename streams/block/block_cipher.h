@@ -2,6 +2,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
+#include <vector>
 
 namespace block {
 
@@ -29,6 +31,26 @@ struct block_cipher {
     virtual void encrypt(const std::uint8_t *plaintext, std::uint8_t *ciphertext) = 0;
     virtual void decrypt(const std::uint8_t *ciphertext, std::uint8_t *plaintext) = 0;
 
+    /**
+     * Round taps. Ciphers which can stop after any round override both functions, the others are
+     * evaluated separately for every round count by the block stream.
+     */
+    virtual bool has_round_taps() const { return false; }
+
+    /**
+     * Encrypts the plaintext once, writing the ciphertext of taps[i] rounds to
+     * out + i * block size. Every tap output equals encrypt of this cipher with that many rounds.
+     * @param taps ascending round counts, at most the rounds of the cipher
+     */
+    virtual void encrypt_taps(const std::uint8_t *plaintext,
+                              std::uint8_t *out,
+                              const std::vector<std::size_t> &taps) {
+        (void)plaintext;
+        (void)out;
+        (void)taps;
+        throw std::runtime_error("the block cipher has no round taps");
+    }
+
     void crypt(const std::uint8_t *in, std::uint8_t *out, const bool run_encryption = true) {
         if (run_encryption) {
             encrypt(in, out);
@@ -0,0 +1,38 @@
+#include "block_pipeline.h"
+#include "ciphers/aes/aes.h"
+
+namespace block {
+
+template <typename Cipher>
+static std::unique_ptr<stream>
+compile_with_cipher(const json &config,
+                    default_seed_source &seeder,
+                    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                    const std::size_t osize) {
+    const json &plaintext = config.at("plaintext");
+    if (!pipeline_leaf<pcg32_stream>::matches(config.at("key")))
+        return nullptr;
+
+    if (pipeline_leaf<counter>::matches(plaintext))
+        return std::make_unique<block_pipeline<Cipher, counter, pcg32_stream>>(
+            config, seeder, pipes, osize);
+    if (pipeline_leaf<pcg32_stream>::matches(plaintext))
+        return std::make_unique<block_pipeline<Cipher, pcg32_stream, pcg32_stream>>(
+            config, seeder, pipes, osize);
+    return nullptr;
+}
+
+std::unique_ptr<stream>
+compile_block_stream(const json &config,
+                     default_seed_source &seeder,
+                     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                     const std::size_t osize) {
+    if (!config.value("compile", true) || config.count("round_taps") != 0)
+        return nullptr;
+
+    if (config.at("algorithm") == "AES")
+        return compile_with_cipher<aes>(config, seeder, pipes, osize);
+    return nullptr;
+}
+
+} // namespace block
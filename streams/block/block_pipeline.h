@@ -0,0 +1,112 @@
+#pragma once
+
+#include "block_stream.h"
+#include "stream_pipeline.h"
+#include <eacirc-core/logger.h>
+
+namespace block {
+
+/**
+ * @brief Block stream compiled for the types of its cipher, plaintext and key streams
+ *
+ * Produces the same vectors as block_stream with the same config and seeder. The cipher and the
+ * plaintext and key streams are sealed members, so keysetup, encrypt, decrypt and their next() are
+ * called directly. The iv stream is built only to use the seeder as block_stream does. Round taps
+ * are left to block_stream.
+ */
+template <typename Cipher, typename Plaintext, typename Key> struct block_pipeline final : stream {
+    block_pipeline(const json &config,
+                   default_seed_source &seeder,
+                   std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                   const std::size_t osize)
+        : stream(osize)
+        , _block_size(config.at("block_size"))
+        , _reinit_freq(reinit_freq(config))
+        , _i(0)
+        , _plaintext(pipeline_leaf<Plaintext>::make(config.at("plaintext"), seeder, osize))
+        , _iv(make_stream(config.at("iv"), seeder, pipes, _block_size))
+        , _key(pipeline_leaf<Key>::make(config.at("key"), seeder, unsigned(config.at("key_size"))))
+        , _run_encryption(config.value("encryption_mode", true))
+        , _cipher(unsigned(config.at("round"))) {
+        logger::info() << "stream source is block cipher: " << config.at("algorithm") << std::endl;
+
+        if (int(config.at("round")) < 0)
+            throw std::runtime_error("The least number of rounds is 0.");
+        if (_block_size < 4)
+            throw std::runtime_error("The block size is at least 4 bytes");
+        if (osize == 0)
+            throw std::runtime_error("The output size has to be at least 1 byte");
+        if (osize % _block_size != 0)
+            throw std::runtime_error("Output size is not multiple of block size");
+
+        keysetup();
+    }
+
+    vec_cview next() override {
+        ++_i;
+        if (_reinit_freq != -1 && _i % std::size_t(_reinit_freq) == 0)
+            keysetup();
+
+        // the plaintext vectors have the output size
+        vec_cview plaintext = _plaintext.next();
+        for (std::size_t i = 0; i != osize(); i += _block_size) {
+            if (_run_encryption)
+                _cipher.encrypt(plaintext.data() + i, _data.data() + i);
+            else
+                _cipher.decrypt(plaintext.data() + i, _data.data() + i);
+        }
+        return make_cview(_data);
+    }
+
+    void skip(const std::uint64_t count) override {
+        if (count == 0)
+            return;
+
+        _plaintext.skip(count);
+        if (_reinit_freq != -1) {
+            const auto freq = std::uint64_t(_reinit_freq);
+            const std::uint64_t reinits = (_i + count) / freq - _i / freq;
+            if (reinits != 0) {
+                _key.skip(reinits - 1);
+                keysetup();
+            }
+        }
+        _i += count;
+    }
+
+    bool seekable() const override {
+        return _plaintext.seekable() && (_reinit_freq == -1 || _key.seekable());
+    }
+
+private:
+    void keysetup() {
+        vec_cview key = _key.next();
+        _cipher.keysetup(key.data(), std::uint32_t(key.size()));
+    }
+
+    const std::size_t _block_size;
+    const int64_t _reinit_freq;
+    std::size_t _i;
+
+    sealed<Plaintext> _plaintext;
+    std::unique_ptr<stream> _iv;
+    sealed<Key> _key;
+
+    const bool _run_encryption;
+    sealed<Cipher> _cipher;
+};
+
+/**
+ * @brief Builds the block stream of the config as a block_pipeline
+ *
+ * Compiled is AES over a counter or a pcg32_stream (random_stream) plaintext with a pcg32_stream
+ * key, without round taps. Configs with "compile": false, or of other shapes, give nullptr and the
+ * seeder is not used.
+ */
+std::unique_ptr<stream>
+compile_block_stream(const json &config,
+                     default_seed_source &seeder,
+                     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                     std::size_t osize);
+
+} // namespace block
@@ -2,11 +2,12 @@
 #include "block_cipher.h"
 #include "block_factory.h"
 #include "streams.h"
+#include <algorithm>
 #include <eacirc-core/json.h>
 
 namespace block {
 
-static int64_t reinit_freq(const json &config) {
+int64_t reinit_freq(const json &config) {
     try {
         std::string init_freq = config.at("init_frequency");
         if (init_freq == "only_once") {
@@ -25,17 +26,26 @@ static int64_t reinit_freq(const json &config) {
     }
 }
 
+static std::size_t tap_size(const json &config, const std::size_t osize) {
+    const std::size_t taps = std::max<std::size_t>(1, round_taps(config).size());
+    if (osize % taps != 0)
+        throw std::runtime_error("Output size is not multiple of the number of round taps");
+    return osize / taps;
+}
+
 block_stream::block_stream(
     const json &config,
     default_seed_source &seeder,
     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
     const std::size_t osize)
     : stream(osize)
-    , _round(config.at("round"))
+    , _taps(round_taps(config))
+    , _tap_size(tap_size(config, osize))
+    , _round(_taps.empty() ? std::size_t(config.at("round")) : _taps.back())
     , _block_size(config.at("block_size"))
     , _reinit_freq(reinit_freq(config))
     , _i(0)
-    , _source(make_stream(config.at("plaintext"), seeder, pipes, osize))
+    , _source(make_stream(config.at("plaintext"), seeder, pipes, _tap_size))
     , _iv(make_stream(config.at("iv"), seeder, pipes, _block_size))
     , _key(make_stream(config.at("key"), seeder, pipes, unsigned(config.at("key_size"))))
     , _run_encryption(config.value("encryption_mode", true))
@@ -46,23 +56,32 @@ block_stream::block_stream(
                                    _run_encryption)) {
     logger::info() << "stream source is block cipher: " << config.at("algorithm") << std::endl;
 
-    if (int(config.at("round")) < 0)
+    if (_taps.empty() && int(config.at("round")) < 0)
         throw std::runtime_error("The least number of rounds is 0.");
     if (_block_size < 4)
         throw std::runtime_error("The block size is at least 4 bytes");
     if (osize == 0)
         throw std::runtime_error("The output size has to be at least 1 byte");
-    if (osize % _block_size != 0) // not necessary wrong, but we never needed this, we always did
-                                  // this by mistake. Change to warning if needed
+    if (_tap_size % _block_size != 0) // not necessary wrong, but we never needed this, we always
+                                      // did this by mistake. Change to warning if needed
         throw std::runtime_error("Output size is not multiple of block size");
 
+    if (!_taps.empty() && (!_run_encryption || !_encryptor->has_round_taps())) {
+        for (std::size_t tap : _taps)
+            _tap_ciphers.push_back(make_block_cipher(config.at("algorithm"),
+                                                     unsigned(tap),
+                                                     unsigned(_block_size),
+                                                     unsigned(config.at("key_size")),
+                                                     _run_encryption));
+    }
+    _tap_blocks.resize(_taps.size() * _block_size);
+
     /* others modes than ECB are not implemented yet
     vec_view iv_view = _iv->next();
     _encryptor->ivsetup(iv_view.data(), iv_view.size());
     */
 
-    vec_cview key_view = _key->next();
-    _encryptor->keysetup(key_view.data(), std::uint32_t(key_view.size()));
+    keysetup();
 }
 
 block_stream::block_stream(block_stream &&) = default;
@@ -70,9 +89,18 @@ block_stream::~block_stream() = default;
 
 vec_cview block_stream::next() {
     ++_i;
-    if (_reinit_freq != -1 && _i % std::size_t(_reinit_freq) == 0) {
-        vec_cview key_view = _key->next();
-        _encryptor->keysetup(key_view.data(), std::uint32_t(key_view.size()));
+    if (_reinit_freq != -1 && _i % std::size_t(_reinit_freq) == 0)
+        keysetup();
+
+    if (!_taps.empty()) {
+        for (std::size_t offset = 0; offset != _tap_size;) {
+            vec_cview view = _source->next();
+            for (auto ptx_beg = view.begin(); ptx_beg != view.end() and offset != _tap_size;
+                 ptx_beg += _block_size, offset += _block_size) {
+                crypt_taps(&(*ptx_beg), offset);
+            }
+        }
+        return make_view(_data.cbegin(), osize());
     }
 
     for (auto ctx_beg = _data.begin();
@@ -87,4 +115,46 @@ vec_cview block_stream::next() {
     return make_view(_data.cbegin(), osize());
 }
 
+void block_stream::skip(const std::uint64_t count) {
+    if (count == 0)
+        return;
+
+    // every output vector is encrypted from exactly one plaintext vector of size _tap_size
+    _source->skip(count);
+
+    if (_reinit_freq != -1) {
+        const auto freq = std::uint64_t(_reinit_freq);
+        const std::uint64_t reinits = (_i + count) / freq - _i / freq;
+        if (reinits != 0) {
+            _key->skip(reinits - 1);
+            keysetup();
+        }
+    }
+    _i += count;
+}
+
+bool block_stream::seekable() const {
+    return _source->seekable() && (_reinit_freq == -1 || _key->seekable());
+}
+
+void block_stream::keysetup() {
+    vec_cview key_view = _key->next();
+    _encryptor->keysetup(key_view.data(), std::uint32_t(key_view.size()));
+    for (auto &cipher : _tap_ciphers)
+        cipher->keysetup(key_view.data(), std::uint32_t(key_view.size()));
+}
+
+void block_stream::crypt_taps(const value_type *plaintext, std::size_t offset) {
+    if (_tap_ciphers.empty()) {
+        _encryptor->encrypt_taps(plaintext, _tap_blocks.data(), _taps);
+        for (std::size_t i = 0; i < _taps.size(); ++i)
+            std::copy_n(_tap_blocks.data() + i * _block_size,
+                        _block_size,
+                        _data.data() + i * _tap_size + offset);
+    } else {
+        for (std::size_t i = 0; i < _taps.size(); ++i)
+            _tap_ciphers[i]->crypt(plaintext, _data.data() + i * _tap_size + offset, _run_encryption);
+    }
+}
+
 } // namespace block
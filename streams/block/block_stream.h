@@ -6,11 +6,30 @@
 #include <eacirc-core/optional.h>
 #include <eacirc-core/random.h>
 #include <memory>
+#include <vector>
 
 namespace block {
 
 struct block_cipher;
 
+/**
+ * @return number of vectors between key reinitializations of the "init_frequency" option, -1 when
+ * the key is set only once
+ */
+int64_t reinit_freq(const json &config);
+
+/**
+ * @brief Block cipher stream over the plaintext stream
+ *
+ * With "round_taps" (ascending round counts, replacing "round") the output vector consists of
+ * one part per tap, each of them the same as the output of the stream with "round" set to the tap
+ * and output size osize / number of taps. The key and plaintext streams are read once for all
+ * taps and ciphers with round taps encrypt every block only once.
+ *
+ * make_stream builds the configs of the shapes handled by compile_block_stream as a
+ * block_pipeline, whose cipher and leaf streams are resolved at compile time. With "compile":
+ * false the config is always built as a block_stream.
+ */
 struct block_stream : public stream {
 public:
     block_stream(const json &config,
@@ -22,8 +41,21 @@ public:
 
     vec_cview next() override;
 
+    /**
+     * Skips one plaintext vector per output vector and reads only the last key of the skipped
+     * reinitializations, the modes other than ECB are not implemented
+     */
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override;
+
 private:
+    void keysetup();
 
+    void crypt_taps(const value_type *plaintext, std::size_t offset);
+
+    const std::vector<std::size_t> _taps;
+    const std::size_t _tap_size;
     const std::size_t _round;
     const std::size_t _block_size;
     const int64_t _reinit_freq;
@@ -35,6 +67,9 @@ private:
 
     const bool _run_encryption;
     std::unique_ptr<block_cipher> _encryptor;
+
+    std::vector<std::unique_ptr<block_cipher>> _tap_ciphers; // ciphers without round taps
+    std::vector<value_type> _tap_blocks;
 };
 
 } // namespace block
@@ -20,20 +20,20 @@ namespace block {
 // Key length in bytes [128 bit]
 #define KEYLEN 16
 // The number of rounds in AES Cipher.
-static unsigned Nr = 10;
+static thread_local unsigned Nr = 10;
 
 /*****************************************************************************/
 /* Private variables:                                                        */
 /*****************************************************************************/
 // state - array holding the intermediate results during decryption.
 typedef uint8_t state_t[4][4];
-static state_t* state;
+static thread_local state_t* state;
 
 // The array that stores the round keys.
-static uint8_t RoundKey[176];
+static thread_local uint8_t RoundKey[176];
 
 // The Key input to the AES Program
-static const uint8_t* Key;
+static thread_local const uint8_t* Key;
 
 // The lookup-tables are marked const so they can be placed in read-only storage instead of RAM
 // The numbers below can be computed dynamically trading ROM for RAM -
@@ -444,4 +444,38 @@ void aes::decrypt(const std::uint8_t* ciphertext,
     AES128_ECB_decrypt(ciphertext, _ctx.key, plaintext);
 }
 
+void aes::encrypt_taps(const std::uint8_t* plaintext,
+                       std::uint8_t* out,
+                       const std::vector<std::size_t>& taps) {
+    // the reduced cipher of r rounds ends with the last round (without MixColumns) applied to
+    // the state after r - 1 full rounds, so every tap branches off the shared state
+    Nr = unsigned(taps.back());
+    Key = _ctx.key;
+    KeyExpansion();
+
+    state_t current;
+    BlockCopy(reinterpret_cast<uint8_t*>(current), plaintext);
+    state = &current;
+    AddRoundKey(0);
+
+    unsigned full_rounds = 0;
+    for (std::size_t i = 0; i < taps.size(); ++i) {
+        const unsigned round = unsigned(taps[i]);
+        for (; full_rounds + 1 < round; ++full_rounds) {
+            SubBytes();
+            ShiftRows();
+            MixColumns();
+            AddRoundKey(uint8_t(full_rounds + 1));
+        }
+
+        uint8_t* tap = out + i * KEYLEN;
+        BlockCopy(tap, reinterpret_cast<uint8_t*>(current));
+        state = reinterpret_cast<state_t*>(tap);
+        SubBytes();
+        ShiftRows();
+        AddRoundKey(uint8_t(round));
+        state = &current;
+    }
+}
+
 } // namespace block
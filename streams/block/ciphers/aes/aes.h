@@ -32,5 +32,11 @@ namespace block {
 
         void decrypt(const std::uint8_t* ciphertext,
                      std::uint8_t* plaintext) override;
+
+        bool has_round_taps() const override { return true; }
+
+        void encrypt_taps(const std::uint8_t* plaintext,
+                          std::uint8_t* out,
+                          const std::vector<std::size_t>& taps) override;
     };
 }
@@ -5,6 +5,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <mutex>
+
 #include "kuznyechik.h"
 
 #define GENERATING_POLY	0x03	/* x + 1 */
@@ -12,6 +14,8 @@
 
 unsigned char gf_exp[256];
 unsigned char gf_log[256];
+// the tables are shared by all contexts, which may be initialized concurrently
+static std::once_flag gf_tables_once;
 
 unsigned char pibox[] = {
 	/*
@@ -261,7 +265,7 @@ kuzn_context_init(struct kuzn_ctx *ctx)
 	// p(x) = x**8 + x**7 + x**6 + x + 1
 	ctx->polynomial = KUZN_POLY;
 
-	galois_init_tables(ctx->polynomial);
+	std::call_once(gf_tables_once, galois_init_tables, ctx->polynomial);
 }
 
 void
@@ -34,7 +34,7 @@
 namespace block {
 namespace mars {
 
-static unsigned MARS_N_ROUNDS;
+static thread_local unsigned MARS_N_ROUNDS;
 
 /* The low level mars routines are completely WORD oriented, and 
  * endian neutral. The high level NIST routines provide BYTE oriented
@@ -25,7 +25,7 @@
 namespace block {
 namespace rc6 {
 
-static unsigned RC6_N_ROUNDS;
+static thread_local unsigned RC6_N_ROUNDS;
 
 /* The "magic constants" for RC6 with 32-bit wordsize */
 #define P32 0xb7e15163
@@ -31,7 +31,7 @@
 namespace block {
 namespace serpent {
 
-static unsigned SERPENT_N_ROUNDS = 32; /* # of rounds */
+static thread_local unsigned SERPENT_N_ROUNDS = 32; /* # of rounds */
 
 /* -------------------------------------------------- */
 EMBED_RCS(serpent_ref_c,
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "speck.h"
+#include <algorithm>
 
 
 namespace block {
@@ -341,6 +342,28 @@ void speck::decrypt(const std::uint8_t* ciphertext, std::uint8_t* plaintext) {
     endianity_flip(rev_plaintext, plaintext, _ctx.cipher_object->block_size/8);
 }
 
+void speck::encrypt_taps(const std::uint8_t* plaintext,
+                         std::uint8_t* out,
+                         const std::vector<std::size_t>& taps) {
+    const std::size_t block_bytes = _ctx.cipher_object->block_size / 8;
+    const std::size_t word_bytes = block_bytes / 2; // one round key per word
+    std::uint8_t state[16];
+    std::uint8_t next_state[16];
+    endianity_flip(plaintext, state, block_bytes);
+
+    // every tap continues from the state of the previous one with the following round keys
+    std::size_t done = 0;
+    for (std::size_t i = 0; i < taps.size(); ++i) {
+        (*_ctx.cipher_object->encryptPtr)(uint8_t(taps[i] - done),
+                                          _ctx.cipher_object->key_schedule + done * word_bytes,
+                                          state,
+                                          next_state);
+        std::copy_n(next_state, block_bytes, state);
+        done = taps[i];
+        endianity_flip(state, out + i * block_bytes, block_bytes);
+    }
+}
+
 void speck::endianity_flip(const uint8_t *source, uint8_t *destination, const size_t length)
 {
     for (size_t i = 0; i < length; ++i)
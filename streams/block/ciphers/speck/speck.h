@@ -141,6 +141,12 @@ public:
     void decrypt(const std::uint8_t* ciphertext,
                  std::uint8_t* plaintext) override;
 
+    bool has_round_taps() const override { return true; }
+
+    void encrypt_taps(const std::uint8_t* plaintext,
+                      std::uint8_t* out,
+                      const std::vector<std::size_t>& taps) override;
+
 private:
     void endianity_flip(const std::uint8_t* source, std::uint8_t* destination, const size_t length);
 };
@@ -25,10 +25,19 @@ typedef int32_t   s4byte; /* a 32 bit signed integer type     */
     {
 #endif
 
+    /* key schedule of one cipher instance                              */
+    typedef struct
+    {
+        u4byte  k_len;
+        u4byte  l_key[40];
+        u4byte  s_key[4];
+        u4byte  mk_tab[4][256];
+    } twofish_ctx;
+
     char **cipher_name(void);
-    u4byte *set_key(const u4byte in_key[], const u4byte key_len);
-    void twofish_encrypt(const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds);
-    void twofish_decrypt(const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds);
+    u4byte *set_key(twofish_ctx *ctx, const u4byte in_key[], const u4byte key_len);
+    void twofish_encrypt(const twofish_ctx *ctx, const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds);
+    void twofish_decrypt(const twofish_ctx *ctx, const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds);
 
 #ifdef  __cplusplus
     };
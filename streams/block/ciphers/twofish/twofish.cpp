@@ -40,10 +40,12 @@ Mean:          378 cycles =    67.8 mbits/sec
 
 #include "std_defs.h"
 
+#include <mutex>
+
 namespace block {
 namespace twofish {
 
-static unsigned TWOFISH_N_ROUNDS = 16;
+static thread_local unsigned TWOFISH_N_ROUNDS = 16;
 
 #define Q_TABLES
 #define M_TABLE
@@ -57,10 +59,6 @@ char **cipher_name()
     return alg_name;
 }
 
-u4byte  k_len;
-u4byte  l_key[40];
-u4byte  s_key[4];
-
 /* finite field arithmetic for GF(2**8) with the modular    */
 /* polynomial x^8 + x^6 + x^5 + x^3 + 1 (0x169)             */
 
@@ -109,7 +107,6 @@ u1byte qp(const u4byte n, const u1byte x)
 
 #ifdef  Q_TABLES
 
-u4byte  qt_gen = 0;
 u1byte  q_tab[2][256];
 
 #define q(n,x)  q_tab[n][x]
@@ -132,7 +129,6 @@ void gen_qtab(void)
 
 #ifdef  M_TABLE
 
-u4byte  mt_gen = 0;
 u4byte  m_tab[4][256];
 
 void gen_mtab(void)
@@ -187,7 +183,7 @@ void gen_mtab(void)
 
 #endif
 
-u4byte h_fun(const u4byte x, const u4byte key[])
+u4byte h_fun(const u4byte k_len, const u4byte x, const u4byte key[])
 {   u4byte  b0, b1, b2, b3;
 
 #ifndef M_TABLE
@@ -231,9 +227,7 @@ u4byte h_fun(const u4byte x, const u4byte key[])
 
 #ifdef  MK_TABLE
 
-#ifdef  ONE_STEP
-u4byte  mk_tab[4][256];
-#else
+#ifndef ONE_STEP
 u1byte  sb[4][256];
 #endif
 
@@ -252,11 +246,12 @@ u1byte  sb[4][256];
 #define q42(x)  q(1,q(0,q(0, q(0, x) ^ byte(key[3],2)) ^ byte(key[2],2)) ^ byte(key[1],2)) ^ byte(key[0],2)
 #define q43(x)  q(1,q(1,q(0, q(1, x) ^ byte(key[3],3)) ^ byte(key[2],3)) ^ byte(key[1],3)) ^ byte(key[0],3)
 
-void gen_mk_tab(u4byte key[])
+void gen_mk_tab(twofish_ctx *ctx, u4byte key[])
 {   u4byte  i;
     u1byte  by;
+    u4byte  (*mk_tab)[256] = ctx->mk_tab;
 
-    switch(k_len)
+    switch(ctx->k_len)
     {
     case 2: for(i = 0; i < 256; ++i)
             {
@@ -299,10 +294,10 @@ void gen_mk_tab(u4byte key[])
 };
 
 #  ifdef ONE_STEP
-#    define g0_fun(x) ( mk_tab[0][byte(x,0)] ^ mk_tab[1][byte(x,1)] \
-                      ^ mk_tab[2][byte(x,2)] ^ mk_tab[3][byte(x,3)] )
-#    define g1_fun(x) ( mk_tab[0][byte(x,3)] ^ mk_tab[1][byte(x,0)] \
-                      ^ mk_tab[2][byte(x,1)] ^ mk_tab[3][byte(x,2)] )
+#    define g0_fun(x) ( ctx->mk_tab[0][byte(x,0)] ^ ctx->mk_tab[1][byte(x,1)] \
+                      ^ ctx->mk_tab[2][byte(x,2)] ^ ctx->mk_tab[3][byte(x,3)] )
+#    define g1_fun(x) ( ctx->mk_tab[0][byte(x,3)] ^ ctx->mk_tab[1][byte(x,0)] \
+                      ^ ctx->mk_tab[2][byte(x,1)] ^ ctx->mk_tab[3][byte(x,2)] )
 #  else
 #    define g0_fun(x) ( mds(0, sb[0][byte(x,0)]) ^ mds(1, sb[1][byte(x,1)]) \
                       ^ mds(2, sb[2][byte(x,2)]) ^ mds(3, sb[3][byte(x,3)]) )
@@ -312,8 +307,8 @@ void gen_mk_tab(u4byte key[])
 
 #else
 
-#define g0_fun(x)   h_fun(x,s_key)
-#define g1_fun(x)   h_fun(rotl(x,8),s_key)
+#define g0_fun(x)   h_fun(ctx->k_len,x,ctx->s_key)
+#define g1_fun(x)   h_fun(ctx->k_len,rotl(x,8),ctx->s_key)
 
 #endif
 
@@ -378,26 +373,30 @@ u4byte mds_rem(u4byte p0, u4byte p1)
     return p1;
 };
 
-/* initialise the key schedule from the user supplied key   */
+/* the key independent tables are shared by all instances   */
 
-u4byte *set_key(const u4byte in_key[], const u4byte key_len)
-{   u4byte  i, a, b, me_key[4], mo_key[4];
+static std::once_flag tables_once;
 
+void gen_tables(void)
+{
 #ifdef Q_TABLES
-    if(!qt_gen)
-    {
-        gen_qtab(); qt_gen = 1;
-    }
+    gen_qtab();
 #endif
 
 #ifdef M_TABLE
-    if(!mt_gen)
-    {
-        gen_mtab(); mt_gen = 1;
-    }
+    gen_mtab();
 #endif
+};
+
+/* initialise the key schedule from the user supplied key   */
+
+u4byte *set_key(twofish_ctx *ctx, const u4byte in_key[], const u4byte key_len)
+{   u4byte  i, a, b, me_key[4], mo_key[4];
+    u4byte  k_len, *l_key = ctx->l_key, *s_key = ctx->s_key;
+
+    std::call_once(tables_once, gen_tables);
 
-    k_len = key_len / 64;   /* 2, 3 or 4 */
+    k_len = ctx->k_len = key_len / 64;   /* 2, 3 or 4 */
 
     for(i = 0; i < k_len; ++i)
     {
@@ -409,14 +408,14 @@ u4byte *set_key(const u4byte in_key[], const u4byte key_len)
     for(i = 0; i < 40; i += 2)
     {
         a = 0x01010101 * i; b = a + 0x01010101;
-        a = h_fun(a, me_key);
-        b = rotl(h_fun(b, mo_key), 8);
+        a = h_fun(k_len, a, me_key);
+        b = rotl(h_fun(k_len, b, mo_key), 8);
         l_key[i] = a + b;
         l_key[i + 1] = rotl(a + 2 * b, 9);
     }
 
 #ifdef MK_TABLE
-    gen_mk_tab(s_key);
+    gen_mk_tab(ctx, s_key);
 #endif
 
     return l_key;
@@ -436,8 +435,9 @@ u4byte *set_key(const u4byte in_key[], const u4byte key_len)
         blk[1] = rotl(blk[1], 1) ^ (t0 + 2 * t1 + l_key[4 * (i) + 11]); \
     }
 
-void twofish_encrypt(const u4byte in_blk[4], u4byte out_blk[], unsigned rounds)
+void twofish_encrypt(const twofish_ctx *ctx, const u4byte in_blk[4], u4byte out_blk[], unsigned rounds)
 {   u4byte  t0, t1, blk[4];
+    const u4byte *l_key = ctx->l_key;
     TWOFISH_N_ROUNDS = rounds;
 
     blk[0] = in_blk[0] ^ l_key[0];
@@ -468,8 +468,9 @@ void twofish_encrypt(const u4byte in_blk[4], u4byte out_blk[], unsigned rounds)
         blk[1] = rotr(blk[1] ^ (t0 + 2 * t1 + l_key[4 * (i) +  9]), 1); \
     }
 
-void twofish_decrypt(const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds)
+void twofish_decrypt(const twofish_ctx *ctx, const u4byte in_blk[4], u4byte out_blk[4], unsigned rounds)
 {   u4byte  t0, t1, blk[4];
+    const u4byte *l_key = ctx->l_key;
     TWOFISH_N_ROUNDS = rounds;
 
     blk[0] = in_blk[0] ^ l_key[4];
@@ -0,0 +1,32 @@
+#include "hash_pipeline.h"
+#include "others/hash_functions/sha2/sha256_factory.h"
+#include "sha3/hash_functions/Keccak/Keccak_sha3.h"
+
+namespace hash {
+
+template <typename Hasher>
+static std::unique_ptr<stream>
+compile_with_hasher(const json &config, default_seed_source &seeder, const std::size_t osize) {
+    const json &source = config.at("source");
+
+    if (pipeline_leaf<counter>::matches(source))
+        return std::make_unique<hash_pipeline<Hasher, counter>>(config, seeder, osize);
+    if (pipeline_leaf<pcg32_stream>::matches(source))
+        return std::make_unique<hash_pipeline<Hasher, pcg32_stream>>(config, seeder, osize);
+    return nullptr;
+}
+
+std::unique_ptr<stream>
+compile_hash_stream(const json &config, default_seed_source &seeder, const std::size_t osize) {
+    if (!config.value("compile", true) || config.count("round_taps") != 0)
+        return nullptr;
+
+    const std::string algorithm = config.at("algorithm");
+    if (algorithm == "Keccak")
+        return compile_with_hasher<sha3::Keccak>(config, seeder, osize);
+    if (algorithm == "SHA2")
+        return compile_with_hasher<others::sha256_factory>(config, seeder, osize);
+    return nullptr;
+}
+
+} // namespace hash
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "hash_stream.h"
+#include "stream_pipeline.h"
+#include <eacirc-core/logger.h>
+
+namespace hash {
+
+/**
+ * @brief Hash stream compiled for the types of its hash function and source stream
+ *
+ * Produces the same vectors as hash_stream with the same config and seeder. The hash function and
+ * the source are sealed members, so Init, Update, Final and the next() of the source are called
+ * directly. Round taps are left to hash_stream.
+ */
+template <typename Hasher, typename Source> struct hash_pipeline final : stream {
+    hash_pipeline(const json &config, default_seed_source &seeder, const std::size_t osize)
+        : stream(osize)
+        , _hash_size(std::size_t(config.at("hash_size")))
+        , _source(pipeline_leaf<Source>::make(config.at("source"), seeder, source_size(config)))
+        , _hasher(unsigned(config.at("round"))) {
+        if (osize % _hash_size != 0)
+            throw std::runtime_error("Output size is not multiple of hash size");
+        logger::info() << "stream source is hash function: " << config.at("algorithm")
+                       << std::endl;
+    }
+
+    vec_cview next() override {
+        for (std::size_t i = 0; i < osize(); i += _hash_size)
+            hash_data(_hasher, _source.next(), _data.data() + i, _hash_size);
+        return make_cview(_data);
+    }
+
+    void skip(std::uint64_t count) override { _source.skip(count * (osize() / _hash_size)); }
+
+    bool seekable() const override { return _source.seekable(); }
+
+private:
+    const std::size_t _hash_size;
+
+    sealed<Source> _source;
+    sealed<Hasher> _hasher;
+};
+
+/**
+ * @brief Builds the hash stream of the config as a hash_pipeline
+ *
+ * Compiled are Keccak and SHA2 over a counter or a pcg32_stream (random_stream) without round
+ * taps. Configs with "compile": false, or of other shapes, give nullptr and the seeder is not used.
+ */
+std::unique_ptr<stream> compile_hash_stream(const json &config,
+                                            default_seed_source &seeder,
+                                            std::size_t osize);
+
+} // namespace hash
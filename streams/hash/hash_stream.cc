@@ -6,24 +6,16 @@
 
 namespace hash {
 
-template <typename I>
-void hash_data(hash_interface &hasher,
-               const I &data,
-               std::uint8_t *hash,
-               const std::size_t hash_size) {
-    using std::to_string;
-
-    int status = hasher.Init(int(hash_size * 8));
-    if (status != 0)
-        throw std::runtime_error("cannot initialize hash (code: " + to_string(status) + ")");
-
-    status = hasher.Update(&(*data.begin()), 8 * (data.size()));
-    if (status != 0)
-        throw std::runtime_error("cannot update the hash (code: " + to_string(status) + ")");
+std::size_t source_size(const json &config) {
+    // if input size is not defined, use hash-size
+    return config.value("input_size", std::size_t(config.at("hash_size")));
+}
 
-    status = hasher.Final(hash);
-    if (status != 0)
-        throw std::runtime_error("cannot finalize the hash (code: " + to_string(status) + ")");
+static std::vector<std::size_t> rounds(const json &config) {
+    std::vector<std::size_t> taps = round_taps(config);
+    if (taps.empty())
+        return {std::size_t(config.at("round"))};
+    return taps;
 }
 
 hash_stream::hash_stream(
@@ -32,15 +24,16 @@ hash_stream::hash_stream(
     std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
     const std::size_t osize)
     : stream(osize) // round osize to multiple of _hash_input_size
-    , _round(config.at("round"))
+    , _rounds(rounds(config))
+    , _tap_size(osize / _rounds.size())
     , _hash_size(std::size_t(config.at("hash_size")))
-    , _source(make_stream(
-          config.at("source"),
-          seeder,
-          pipes,
-          config.value("input_size", _hash_size))) // if input size is not defined, use hash-size
-    , _hasher(hash_factory::create(config.at("algorithm"), unsigned(_round))) {
-    if (osize % _hash_size != 0) {
+    , _source(make_stream(config.at("source"), seeder, pipes, source_size(config))) {
+    for (std::size_t round : _rounds)
+        _hashers.push_back(hash_factory::create(config.at("algorithm"), unsigned(round)));
+
+    if (osize % _rounds.size() != 0)
+        throw std::runtime_error("Output size is not multiple of the number of round taps");
+    if (_tap_size % _hash_size != 0) {
         // not necessary wrong, but we never needed this, we always did
         // this by mistake. Change to warning if needed
         throw std::runtime_error("Output size is not multiple of hash size");
@@ -53,13 +46,18 @@ hash_stream::~hash_stream() = default;
 
 vec_cview hash_stream::next() {
     auto hash = _data.data();
-    for (std::size_t i = 0; i < _data.size(); i += _hash_size) {
+    for (std::size_t i = 0; i < _tap_size; i += _hash_size) {
         vec_cview view = _source->next();
 
-        hash_data(*_hasher, view, &hash[i], _hash_size);
+        for (std::size_t tap = 0; tap < _hashers.size(); ++tap)
+            hash_data(*_hashers[tap], view, &hash[tap * _tap_size + i], _hash_size);
     }
 
     return make_view(_data.cbegin(), osize());
 }
 
+void hash_stream::skip(const std::uint64_t count) {
+    _source->skip(count * (_tap_size / _hash_size));
+}
+
 } // namespace hash
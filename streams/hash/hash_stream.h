@@ -5,17 +5,53 @@
 #include <eacirc-core/optional.h>
 #include <eacirc-core/random.h>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace hash {
 
 struct hash_interface;
 
-template <typename I>
-void hash_data(hash_interface &hasher,
-               const I &data,
-               std::uint8_t *hash,
-               const std::size_t hash_size);
+/**
+ * @brief Hashes the data to hash_size bytes
+ *
+ * The hasher is a hash_interface or, in compiled pipelines, a sealed hash function whose calls are
+ * resolved statically.
+ */
+template <typename Hasher, typename I>
+void hash_data(Hasher &hasher, const I &data, std::uint8_t *hash, const std::size_t hash_size) {
+    using std::to_string;
 
+    int status = hasher.Init(int(hash_size * 8));
+    if (status != 0)
+        throw std::runtime_error("cannot initialize hash (code: " + to_string(status) + ")");
+
+    status = hasher.Update(&(*data.begin()), 8 * (data.size()));
+    if (status != 0)
+        throw std::runtime_error("cannot update the hash (code: " + to_string(status) + ")");
+
+    status = hasher.Final(hash);
+    if (status != 0)
+        throw std::runtime_error("cannot finalize the hash (code: " + to_string(status) + ")");
+}
+
+/**
+ * @return size of the source vectors, the "input_size" or the "hash_size" of the config
+ */
+std::size_t source_size(const json &config);
+
+/**
+ * @brief Hash function stream over the source stream
+ *
+ * With "round_taps" (ascending round counts, replacing "round") the output vector consists of
+ * one part per tap, each of them the same as the output of the stream with "round" set to the tap
+ * and output size osize / number of taps. The source is read once for all taps.
+ *
+ * make_stream builds the configs of the shapes handled by compile_hash_stream as a hash_pipeline,
+ * whose hash function and source are resolved at compile time. With "compile": false the config is
+ * always built as a hash_stream.
+ */
 struct hash_stream : stream {
     hash_stream(const json &config,
                 default_seed_source &seeder,
@@ -26,13 +62,20 @@ struct hash_stream : stream {
 
     vec_cview next() override;
 
+    /**
+     * Skips the source vectors of the skipped hashes
+     */
+    void skip(std::uint64_t count) override;
+
+    bool seekable() const override { return _source->seekable(); }
+
 private:
-    const std::size_t _round;
+    const std::vector<std::size_t> _rounds; // the round or the round taps
+    const std::size_t _tap_size;
     const std::size_t _hash_size;
 
     std::unique_ptr<stream> _source;
-    stream *_prepared_stream_source;
-    std::unique_ptr<hash_interface> _hasher;
+    std::vector<std::unique_ptr<hash_interface>> _hashers;
 };
 
 } // namespace hash
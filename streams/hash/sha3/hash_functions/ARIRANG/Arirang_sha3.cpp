@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <memory.h>
+#include <mutex>
 extern "C" {
 #include "Arirang_OP32.h"
 }
@@ -7,6 +8,7 @@ extern "C" {
 
 namespace sha3 {
 
+static std::once_flag arirang_tabs_once;
 
 Arirang::Arirang(int numRounds) {
 	if (numRounds == -1) {
@@ -51,7 +53,7 @@ int Arirang::Init(int hashbitlen)
 	if ((hashbitlen != 224) && (hashbitlen != 256) && (hashbitlen != 384) && (hashbitlen != 512))
 		return BAD_HASHLEN;
 
-	arirang_gen_tabs();
+	std::call_once(arirang_tabs_once, arirang_gen_tabs);
 	// Setting the Hash Length
 	arirangState.hashbitlen = hashbitlen;
 	
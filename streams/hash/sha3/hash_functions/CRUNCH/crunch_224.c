@@ -27,10 +27,10 @@
 extern unsigned long int crunch_nbalea[];
 
 //Left data after a call of Update function
-unsigned long int Crunch224_LeftData[(CRUNCH224_BLOCKSIZE-CRUNCH224_HASHLEN)/LONGSIZE];
-unsigned int Crunch224_SizeLeft; //size of left data in bytes
-unsigned long int Crunch224_PrevHash[CRUNCH224_HASHLEN/LONGSIZE];
-CrunchDataLength Crunch224TotalInputSizeInBit; //Total size of message in bits
+_Thread_local unsigned long int Crunch224_LeftData[(CRUNCH224_BLOCKSIZE-CRUNCH224_HASHLEN)/LONGSIZE];
+_Thread_local unsigned int Crunch224_SizeLeft; //size of left data in bytes
+_Thread_local unsigned long int Crunch224_PrevHash[CRUNCH224_HASHLEN/LONGSIZE];
+_Thread_local CrunchDataLength Crunch224TotalInputSizeInBit; //Total size of message in bits
 
 
 unsigned long int *padding_224(int *nb_final_block)
@@ -37,10 +37,10 @@ In this way we can xor all the bytes, even the byte which give the value of i in
 extern unsigned long int crunch_nbalea[];
 
 //Left data after a call of Update function
-unsigned long int Crunch256_LeftData[(CRUNCH256_BLOCKSIZE-CRUNCH256_HASHLEN)/LONGSIZE];
-unsigned int Crunch256_SizeLeft; //size of left data in bytes
-unsigned long int Crunch256_PrevHash[CRUNCH256_HASHLEN/LONGSIZE];
-CrunchDataLength Crunch256TotalInputSizeInBit; //Total size of message in bits
+_Thread_local unsigned long int Crunch256_LeftData[(CRUNCH256_BLOCKSIZE-CRUNCH256_HASHLEN)/LONGSIZE];
+_Thread_local unsigned int Crunch256_SizeLeft; //size of left data in bytes
+_Thread_local unsigned long int Crunch256_PrevHash[CRUNCH256_HASHLEN/LONGSIZE];
+_Thread_local CrunchDataLength Crunch256TotalInputSizeInBit; //Total size of message in bits
 
 
 unsigned long int *padding_256(int *nb_final_block)
@@ -27,10 +27,10 @@
 extern unsigned long int crunch_nbalea[];
 
 //Left data after a call of Update function
-unsigned long int Crunch384_LeftData[(CRUNCH384_BLOCKSIZE-CRUNCH384_HASHLEN)/LONGSIZE];
-unsigned int Crunch384_SizeLeft; //size of left data in bytes
-unsigned long int Crunch384_PrevHash[CRUNCH384_HASHLEN/LONGSIZE];
-CrunchDataLength Crunch384_TotalInputSizeInBit; //Total size of message in bits
+_Thread_local unsigned long int Crunch384_LeftData[(CRUNCH384_BLOCKSIZE-CRUNCH384_HASHLEN)/LONGSIZE];
+_Thread_local unsigned int Crunch384_SizeLeft; //size of left data in bytes
+_Thread_local unsigned long int Crunch384_PrevHash[CRUNCH384_HASHLEN/LONGSIZE];
+_Thread_local CrunchDataLength Crunch384_TotalInputSizeInBit; //Total size of message in bits
 
 
 unsigned long int *padding_384(int *nb_final_block)
@@ -27,10 +27,10 @@
 extern unsigned long int crunch_nbalea[];
 
 //Left data after a call of Update function
-unsigned long int Crunch512_LeftData[(CRUNCH512_BLOCKSIZE-CRUNCH512_HASHLEN)/LONGSIZE];
-unsigned int Crunch512_SizeLeft; //size of left data in bytes
-unsigned long int Crunch512_PrevHash[CRUNCH512_HASHLEN/LONGSIZE];
-CrunchDataLength Crunch512_TotalInputSizeInBit; //Total size of message in bits
+_Thread_local unsigned long int Crunch512_LeftData[(CRUNCH512_BLOCKSIZE-CRUNCH512_HASHLEN)/LONGSIZE];
+_Thread_local unsigned int Crunch512_SizeLeft; //size of left data in bytes
+_Thread_local unsigned long int Crunch512_PrevHash[CRUNCH512_HASHLEN/LONGSIZE];
+_Thread_local CrunchDataLength Crunch512_TotalInputSizeInBit; //Total size of message in bits
 
 
 unsigned long int *padding_512(int *nb_final_block)
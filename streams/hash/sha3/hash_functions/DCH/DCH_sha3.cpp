@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <mutex>
 
 namespace sha3 {
 
@@ -129,7 +130,17 @@ static const BitSequence dch_gfinv[256] =
 
 
 BitSequence dch_multtable[256][256];
-int dchIsInitialized = 0;
+static std::once_flag dch_multtable_once;
+
+static void dch_init_multtable(){
+  int i, j;
+
+  for(i=0;i<256;i++){
+    for(j=0;j<256;j++){
+      dch_multtable[i][j] = (j==0) ? 0 : dch_gf[(i+dch_gfinv[j])%255];
+    }
+  }
+}
 
 DCH::DCH(const int numRounds) {
 	if (numRounds == -1) {
@@ -141,7 +152,7 @@ DCH::DCH(const int numRounds) {
 
 //state is where the initialized state gets returned
 int DCH::Init(int hashbitlen){
-  int i, j;
+  int i;
 
   //Make sure the input hash bit length is supported
   if((hashbitlen != 224) && (hashbitlen != 256) &&
@@ -149,14 +160,7 @@ int DCH::Init(int hashbitlen){
     return BAD_HASHBITLEN;
   }
 
-  if(dchIsInitialized == 0){
-    for(i=0;i<256;i++){
-      for(j=0;j<256;j++){
-	dch_multtable[i][j] = (j==0) ? 0 : dch_gf[(i+dch_gfinv[j])%255];
-      }
-    }
-    dchIsInitialized = 1;
-  } 
+  std::call_once(dch_multtable_once, dch_init_multtable);
 
   dchState.hashbitlen = hashbitlen;
   dchState.numUnprocessed = 0;
@@ -31,9 +31,9 @@ static unsigned int ECHO_T3[256] = {
 #define ECHO_ET_LITTLE_ENDIAN	1
 #define ECHO_ET_MIDDLE_ENDIAN	2
 
-unsigned long long echo_CNT_r;
-unsigned int echo_r;
-unsigned char echo_endian;
+thread_local unsigned long long echo_CNT_r;
+thread_local unsigned int echo_r;
+thread_local unsigned char echo_endian;
 
 /***************************Endianess routines***********************************/
 unsigned char Echo::Endianess(){
@@ -1,10 +1,13 @@
 #include "Fugue_sha3.h"
+#include <mutex>
 extern "C" {
 #include "fugue.h"
 }
 
 namespace sha3 {
 
+static std::once_flag fugue_iv_once;
+
 Fugue::Fugue(const int numRounds) {
 	if (numRounds == -1) {
 		fugueNumRoundsParam1 = FUGUE_ROUNDS_PARAM_R_224_256;
@@ -22,6 +25,7 @@ Fugue::Fugue(const int numRounds) {
 int
 Fugue::Init (int hashbitlen)
 {
+    std::call_once(fugue_iv_once, Make_Fugue);
     if (Init_Fugue(&fugueState, hashbitlen, fugueNumRoundsParam1, fugueNumRoundsParam2, 
 		fugueNumRoundsParam3, fugueNumRoundsParam4)) return SUCCESS;
     return FAIL;
@@ -16,8 +16,6 @@ static struct {
                             ,{0}
                             };
 
-int make_fugue = 0;
-
 void
 Make_Fugue ()
 {
@@ -25,9 +23,6 @@ Make_Fugue ()
     fugueHashState hs;
     int i;
 
-    if (make_fugue) return;
-    make_fugue = 1;
-
     /* generate IV for each hashbitlen in hashSizes table */
     for (i=0; hashSizes[i].hashbitlen; i++)
     {
@@ -70,17 +65,13 @@ unsigned long
 Init_Fugue (fugueHashState *hs, int hashbitlen, const int rounds1, const int rounds2, const int rounds3, const int rounds4)
 {
     int i;
-	//NASTAVENIE RUND:
-	hashSizes[0].Cfg.r = rounds1;
-	hashSizes[1].Cfg.r = rounds1;
-	hashSizes[2].Cfg.r = rounds2;
-	hashSizes[3].Cfg.r = rounds3;
-	hashSizes[0].Cfg.r = rounds4;
-	hashSizes[1].Cfg.r = rounds4;
-	hashSizes[2].Cfg.r = rounds4;
-	hashSizes[3].Cfg.r = rounds4;
-
-    Make_Fugue();
+	/* the final rounds are fixed in fugue_final_*, hashSizes is shared by all states and
+	   stays unchanged */
+	(void)rounds1;
+	(void)rounds2;
+	(void)rounds3;
+	(void)rounds4;
+
     if (!hs) return 0;
     memset (hs, 0, sizeof (fugueHashState));
     for (i=0; hashSizes[i].hashbitlen; i++)
@@ -101,7 +92,6 @@ Load_Fugue (fugueHashState* hs, int hashbitlen, const unsigned long* iv, int has
 {
     int i;
 
-    Make_Fugue ();
     if (!hs) return 0;
     memset (hs, 0, sizeof (fugueHashState));
     for (i=0; hashSizes[i].hashbitlen; i++)
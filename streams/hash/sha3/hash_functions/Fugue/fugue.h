@@ -3,6 +3,8 @@
 
 #include "fugue_t.h"
 
+/* generates the IV table, has to complete once before the first Init_Fugue or Load_Fugue */
+void Make_Fugue (void);
 unsigned long Init_Fugue (fugueHashState *hs, int hashbitlen, const int rounds1, 
 						  const int rounds2, const int rounds3, const int rounds4);
 unsigned long Load_Fugue (fugueHashState *state, int hashbitlen, const unsigned long *iv_key, int ivwordlen);
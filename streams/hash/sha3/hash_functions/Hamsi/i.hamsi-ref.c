@@ -94,7 +94,7 @@ INLINE void diffuse512(unsigned int s[4][8]) {
 
 int hamsi_hash256(const int ROUNDS, unsigned int*cv, const unsigned char*d, int lastiter) {
     const int arrlen=4;
-    static unsigned int s[5][4];
+    static _Thread_local unsigned int s[5][4];
     int i;
 
     // Concatenation
@@ -120,7 +120,7 @@ int hamsi_hash256(const int ROUNDS, unsigned int*cv, const unsigned char*d, int
 
 int hamsi_hash512(const int ROUNDS, unsigned int*cv, const unsigned char*d, int lastiter) {
     const int arrlen=8;
-    static unsigned int s[5][8];
+    static _Thread_local unsigned int s[5][8];
     int i;
 
     // Concatenation
@@ -248,7 +248,7 @@ static const md6_word Q[120] =
 
 /* routines for dealing with byte ordering */
 
-int md6_byte_order = 0;    
+_Thread_local int md6_byte_order = 0;    
 /* md6_byte_order describes the endianness of the 
 ** underlying machine:
 ** 0 = unknown
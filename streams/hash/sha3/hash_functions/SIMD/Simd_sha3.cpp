@@ -119,10 +119,7 @@ int Simd::Init(int hashbitlen) {
 int Simd::Update(const BitSequence *data, SimdDataLength databitlen) {
   unsigned current;
   unsigned int bs = simdState.blocksize;
-  static int align = -1;
-
-  if (align == -1)
-    align = SimdRequiredAlignment();
+  static const int align = SimdRequiredAlignment();
 
 #ifdef SIMD_HAS_64
   current = simdState.count & (bs - 1);
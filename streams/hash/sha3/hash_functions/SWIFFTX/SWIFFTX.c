@@ -17,6 +17,7 @@
 // Remove this while using gcc:
 #include "stdbool.h"
 #include <memory.h>
+#include <pthread.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 // Constants and static tables portion.
@@ -57,8 +58,8 @@
 // - A: the input.
 #define Q_REDUCE(A) (((A) & 0xff) - ((A) >> 8))
 
-// Since we need to do the setup only once, this is the indicator variable:
-static bool wasSetupDone = false;
+// Since we need to do the setup only once, concurrent hashes wait for the first one to do it:
+static pthread_once_t setupOnce = PTHREAD_ONCE_INIT;
 
 // This array stores the powers of omegas that correspond to the indices, which are the input 
 // values. Known also as the "outer FFT twiddle factors".
@@ -525,7 +526,7 @@ int Center(int x);
 int ReverseBits(int input, int numOfBits); 
 
 // Initializes the FFT fast lookup table.
-// Shall be called only once.
+// Builds it on the first call only, also when called from several threads.
 void InitializeSWIFFTX();
 
 // Calculates the FFT.
@@ -595,16 +596,13 @@ int ReverseBits(int input, int numOfBits)
 	return reversed;
 }
 
-void InitializeSWIFFTX() 
+static void SetupSWIFFTX() 
 {
 	int i, j, k, x;
 	// The powers of OMEGA
 	int omegaPowers[2 * N]; 
 	omegaPowers[0] = 1;
 
-	if (wasSetupDone) 
-		return;
-
 	for (i = 1; i < (2 * N); ++i) 
 	{
 		omegaPowers[i] = Center(omegaPowers[i - 1] * OMEGA);  
@@ -632,8 +630,11 @@ void InitializeSWIFFTX()
 			fftTable[(x << 3) + j] = Center(temp);
 		}
 	}
+}
 
-	wasSetupDone = true;
+void InitializeSWIFFTX() 
+{
+	pthread_once(&setupOnce, SetupSWIFFTX);
 }
 
 void FFT(const unsigned char input[EIGHTH_N], swift_int32_t *output)
@@ -22,7 +22,7 @@ $Log: $
 #include <memory.h>
 #include "WaMMErrorMessage.h"
 
-WaMMHashReturn _WaMM_ErrorCode = WaMM_NOT_IMPLEMENTED;
+_Thread_local WaMMHashReturn _WaMM_ErrorCode = WaMM_NOT_IMPLEMENTED;
 char *_WaMM_ErrorMesssage = NULL;
 
 WaMMHashReturn InitErrorMessageBuffer(void)
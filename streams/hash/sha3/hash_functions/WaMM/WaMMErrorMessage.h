@@ -27,7 +27,12 @@ $Log: $
 #include "WaMMConstants.h"
 //#include "SHA3API.h"
 
-extern WaMMHashReturn _WaMM_ErrorCode;
+/* set by the hash running on the same thread */
+#ifdef __cplusplus
+extern thread_local WaMMHashReturn _WaMM_ErrorCode;
+#else
+extern _Thread_local WaMMHashReturn _WaMM_ErrorCode;
+#endif
 extern char *_WaMM_ErrorMesssage;
 
 WaMMHashReturn InitErrorMessageBuffer(void);
@@ -0,0 +1,43 @@
+//
+// Counter-based PRNG factory
+//
+
+#include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
+#include <streams.h>
+#include <streams/prngs/prng_interface.h>
+#include <streams/prngs/cbrng-prngs/cbrng_interface.h>
+#include <streams/prngs/cbrng-prngs/functions/philox.h>
+#include <streams/prngs/cbrng-prngs/functions/splitmix.h>
+#include <streams/prngs/cbrng-prngs/functions/threefry.h>
+
+namespace prng {
+
+    namespace {
+        template <typename Generator, typename... Args>
+        std::unique_ptr<prng_interface>
+        make_cbrng(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes, Args... args) {
+            auto key_stream = make_stream(configuration.at("seeder"), seeder, pipes, Generator::key_size);
+            return std::make_unique<cbrng_interface<Generator>>(
+                    key_stream, configuration.value("reseed_for_each_test_vector", false), args...);
+        }
+    }
+
+    std::unique_ptr<prng_interface>
+    create_cbrng_interface(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes) {
+        std::string name = configuration.at("algorithm");
+
+        if(name == "cbrng-philox4x32")
+            return make_cbrng<philox4x32>(configuration, seeder, pipes,
+                                          unsigned(configuration.value("rounds", philox4x32::default_rounds)));
+        if(name == "cbrng-threefry4x64")
+            return make_cbrng<threefry4x64>(configuration, seeder, pipes,
+                                            unsigned(configuration.value("rounds", threefry4x64::default_rounds)));
+        if(name == "cbrng-splitmix64")
+            return make_cbrng<splitmix64>(configuration, seeder, pipes);
+
+        throw std::runtime_error("requested cbrng prng named \"" + name +
+                                 "\" is either broken or does not exists");
+    }
+
+}
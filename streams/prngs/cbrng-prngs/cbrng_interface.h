@@ -0,0 +1,90 @@
+//
+// Counter-based PRNG interface
+//
+
+#pragma once
+
+#include <streams/prngs/prng_interface.h>
+#include <stream.h>
+#include <algorithm>
+#include <utility>
+
+namespace prng {
+
+    /**
+     * Wrapper of a counter-based generator. Generator block i depends only on the key and i, so the
+     * position in the sequence can be set freely. Each call of generate_bits starts at a new block,
+     * unused bytes of the last block are discarded as in the other prng interfaces.
+     */
+    template <typename Generator>
+    class cbrng_interface : public prng_interface {
+    protected:
+        std::unique_ptr<stream> _seeder;
+        vec_cview _seed;
+        Generator _generator;
+        bool _reseed_for_each_test_vector;
+        std::uint64_t _position;
+
+    public:
+        template <typename... Args>
+        explicit cbrng_interface(std::unique_ptr<stream> &seeder, bool reseed_for_each_test_vector, Args &&... args)
+                : _seeder(std::move(seeder))
+                , _seed(_seeder->next())
+                , _generator(_seed.data(), std::forward<Args>(args)...)
+                , _reseed_for_each_test_vector(reseed_for_each_test_vector)
+                , _position(0) {}
+
+        void generate_bits(std::uint8_t *data, size_t number_of_bytes) override {
+            const size_t blocks = number_of_bytes / Generator::block_size;
+            _generator.generate(_position, blocks, data);
+            _position += blocks;
+
+            if (number_of_bytes % Generator::block_size != 0) {
+                std::uint8_t last[Generator::block_size];
+                _generator.generate(_position++, 1, last);
+                std::copy_n(last, number_of_bytes % Generator::block_size, data + blocks * Generator::block_size);
+            }
+
+            if (_reseed_for_each_test_vector) {
+                _seed = _seeder->next();
+                _generator.set_key(_seed.data());
+                _position = 0;
+            }
+        }
+
+        void jump(std::uint64_t n) override {
+            _position += n;
+        }
+
+        void skip(size_t number_of_bytes, std::uint64_t count) override {
+            if (count == 0)
+                return;
+
+            if (_reseed_for_each_test_vector) {
+                _seeder->skip(count - 1);
+                _seed = _seeder->next();
+                _generator.set_key(_seed.data());
+                _position = 0;
+                return;
+            }
+
+            _position += count * ((number_of_bytes + Generator::block_size - 1) / Generator::block_size);
+        }
+
+        bool seekable() const override {
+            return !_reseed_for_each_test_vector || _seeder->seekable();
+        }
+
+        /**
+         * Sets the index of the next generated block. With a fixed vector size v, vector k starts at
+         * block k * ceil(v / block_size).
+         */
+        void seek(std::uint64_t block) {
+            _position = block;
+        }
+
+        std::uint64_t position() const {
+            return _position;
+        }
+    };
+}
@@ -0,0 +1,139 @@
+//
+// Philox counter-based generator
+//
+
+#include "philox.h"
+#include <simd.h>
+#include <stdexcept>
+#include <string>
+
+namespace prng {
+
+    namespace {
+        const std::uint32_t multiplier0 = 0xD2511F53;
+        const std::uint32_t multiplier1 = 0xCD9E8D57;
+        const std::uint32_t weyl0 = 0x9E3779B9;
+        const std::uint32_t weyl1 = 0xBB67AE85;
+
+        void store_block(const philox4x32::counter_type &block, std::uint8_t *out) {
+            for (std::size_t i = 0; i < 16; i++) {
+                out[i] = static_cast<std::uint8_t>(block[i / 4] >> (8 * (i % 4)));
+            }
+        }
+
+#ifdef STREAMS_X86_DISPATCH
+        /**
+         * 32 x 32 -> 64 bit products of all eight lanes split to the low and high halves
+         */
+        STREAMS_TARGET("avx2")
+        void mulhilo(__m256i a, __m256i multiplier, __m256i &lo, __m256i &hi) {
+            const __m256i even = _mm256_mul_epu32(a, multiplier);
+            const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), multiplier);
+            lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+            hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+        }
+
+        /**
+         * Eight blocks at once, each register holds one word of all the eight counters
+         */
+        STREAMS_TARGET("avx2")
+        void generate_avx2(const philox4x32::key_type &key, unsigned rounds, std::uint64_t first,
+                           std::size_t count, std::uint8_t *out) {
+            const __m256i m0 = _mm256_set1_epi32(int(multiplier0));
+            const __m256i m1 = _mm256_set1_epi32(int(multiplier1));
+            const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+            for (; count >= 8; count -= 8, first += 8, out += 128) {
+                // low counter words are first + lane, with the carry to the high word
+                const __m256i base = _mm256_set1_epi32(int(std::uint32_t(first)));
+                __m256i c0 = _mm256_add_epi32(base, lane);
+                const __m256i carry = _mm256_cmpgt_epi32(_mm256_xor_si256(base, _mm256_set1_epi32(INT32_MIN)),
+                                                         _mm256_xor_si256(c0, _mm256_set1_epi32(INT32_MIN)));
+                __m256i c1 = _mm256_sub_epi32(_mm256_set1_epi32(int(std::uint32_t(first >> 32))), carry);
+                __m256i c2 = _mm256_setzero_si256();
+                __m256i c3 = _mm256_setzero_si256();
+
+                std::uint32_t k0 = key[0];
+                std::uint32_t k1 = key[1];
+                for (unsigned r = 0; r < rounds; r++) {
+                    __m256i lo0, hi0, lo1, hi1;
+                    mulhilo(c0, m0, lo0, hi0);
+                    mulhilo(c2, m1, lo1, hi1);
+                    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(int(k0)));
+                    c1 = lo1;
+                    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(int(k1)));
+                    c3 = lo0;
+                    k0 += weyl0;
+                    k1 += weyl1;
+                }
+
+                // transpose to eight consecutive blocks
+                const __m256i t0 = _mm256_unpacklo_epi32(c0, c1);
+                const __m256i t1 = _mm256_unpackhi_epi32(c0, c1);
+                const __m256i t2 = _mm256_unpacklo_epi32(c2, c3);
+                const __m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+                const __m256i u0 = _mm256_unpacklo_epi64(t0, t2); // blocks 0 and 4
+                const __m256i u1 = _mm256_unpackhi_epi64(t0, t2); // blocks 1 and 5
+                const __m256i u2 = _mm256_unpacklo_epi64(t1, t3); // blocks 2 and 6
+                const __m256i u3 = _mm256_unpackhi_epi64(t1, t3); // blocks 3 and 7
+
+                auto *dst = reinterpret_cast<__m256i *>(out);
+                _mm256_storeu_si256(dst + 0, _mm256_permute2x128_si256(u0, u1, 0x20));
+                _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(u2, u3, 0x20));
+                _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(u0, u1, 0x31));
+                _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(u2, u3, 0x31));
+            }
+        }
+#endif
+    }
+
+    constexpr std::size_t philox4x32::block_size;
+    constexpr std::size_t philox4x32::key_size;
+    constexpr unsigned philox4x32::default_rounds;
+    constexpr unsigned philox4x32::max_rounds;
+
+    philox4x32::philox4x32(const std::uint8_t *key, const unsigned rounds)
+            : _rounds(rounds) {
+        if (rounds < 1 || rounds > max_rounds)
+            throw std::runtime_error("Philox4x32 supports 1 to " + std::to_string(max_rounds) + " rounds");
+        set_key(key);
+    }
+
+    void philox4x32::set_key(const std::uint8_t *key) {
+        for (std::size_t i = 0; i < key_size; i++) {
+            if (i % 4 == 0)
+                _key[i / 4] = 0;
+            _key[i / 4] |= std::uint32_t(key[i]) << (8 * (i % 4));
+        }
+    }
+
+    philox4x32::counter_type philox4x32::block(counter_type counter) const {
+        key_type key = _key;
+        for (unsigned r = 0; r < _rounds; r++) {
+            const std::uint64_t product0 = std::uint64_t(multiplier0) * counter[0];
+            const std::uint64_t product1 = std::uint64_t(multiplier1) * counter[2];
+            counter = {{std::uint32_t(product1 >> 32) ^ counter[1] ^ key[0], std::uint32_t(product1),
+                        std::uint32_t(product0 >> 32) ^ counter[3] ^ key[1], std::uint32_t(product0)}};
+            key[0] += weyl0;
+            key[1] += weyl1;
+        }
+        return counter;
+    }
+
+    void philox4x32::generate(std::uint64_t first, std::size_t count, std::uint8_t *out,
+                              const bool use_simd) const {
+#ifdef STREAMS_X86_DISPATCH
+        if (use_simd && simd::has_avx2()) {
+            generate_avx2(_key, _rounds, first, count, out);
+            first += count - count % 8;
+            out += (count - count % 8) * block_size;
+            count %= 8;
+        }
+#else
+        (void)use_simd;
+#endif
+        for (; count != 0; count--, first++, out += block_size) {
+            store_block(block({{std::uint32_t(first), std::uint32_t(first >> 32), 0, 0}}), out);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Philox counter-based generator
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace prng {
+
+    /**
+     * Philox4x32-R (Salmon et al., Parallel Random Numbers: As Easy as 1, 2, 3, SC'11)
+     *
+     * Block i is the encryption of the counter (i mod 2^64, i >> 64, 0, 0) under the 64 bit key,
+     * stored as four little-endian 32 bit words. Any block can be computed independently.
+     */
+    class philox4x32 {
+    public:
+        using counter_type = std::array<std::uint32_t, 4>;
+        using key_type = std::array<std::uint32_t, 2>;
+
+        static constexpr std::size_t block_size = 16;
+        static constexpr std::size_t key_size = 8;
+        static constexpr unsigned default_rounds = 10;
+        static constexpr unsigned max_rounds = 16;
+
+        philox4x32(const std::uint8_t *key, unsigned rounds = default_rounds);
+
+        void set_key(const std::uint8_t *key);
+
+        /**
+         * Encrypts one counter with all of the rounds
+         */
+        counter_type block(counter_type counter) const;
+
+        /**
+         * Writes blocks first, first + 1, ..., first + count - 1
+         * @param use_simd selects the AVX2 kernel when the CPU has it
+         */
+        void generate(std::uint64_t first, std::size_t count, std::uint8_t *out, bool use_simd = true) const;
+
+    private:
+        key_type _key;
+        unsigned _rounds;
+    };
+}
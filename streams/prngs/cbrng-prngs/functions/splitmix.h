@@ -0,0 +1,57 @@
+//
+// SplitMix64 generator
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace prng {
+
+    /**
+     * SplitMix64 (Steele et al., Fast Splittable Pseudorandom Number Generators, OOPSLA'14)
+     *
+     * Output i is the mix of seed + (i + 1) * golden_gamma, stored as a little-endian 64 bit word,
+     * so it is a counter-based generator as well.
+     */
+    class splitmix64 {
+    public:
+        static constexpr std::size_t block_size = 8;
+        static constexpr std::size_t key_size = 8;
+
+        explicit splitmix64(const std::uint8_t *key) { set_key(key); }
+
+        void set_key(const std::uint8_t *key) {
+            _seed = 0;
+            for (std::size_t i = 0; i < key_size; i++) {
+                _seed |= std::uint64_t(key[i]) << (8 * i);
+            }
+        }
+
+        std::uint64_t block(std::uint64_t index) const {
+            std::uint64_t z = _seed + (index + 1) * golden_gamma;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * Writes blocks first, first + 1, ..., first + count - 1. The scalar loop has no dependency
+         * between iterations, 64 bit multiplications are not worth emulating in AVX2.
+         */
+        void generate(std::uint64_t first, std::size_t count, std::uint8_t *out, bool = true) const {
+            for (; count != 0; count--, first++, out += block_size) {
+                const std::uint64_t word = block(first);
+                for (std::size_t i = 0; i < block_size; i++) {
+                    out[i] = static_cast<std::uint8_t>(word >> (8 * i));
+                }
+            }
+        }
+
+    private:
+        static constexpr std::uint64_t golden_gamma = 0x9E3779B97F4A7C15;
+
+        std::uint64_t _seed;
+    };
+}
@@ -0,0 +1,156 @@
+//
+// Threefry counter-based generator
+//
+
+#include "threefry.h"
+#include <simd.h>
+#include <stdexcept>
+#include <string>
+
+namespace prng {
+
+    namespace {
+        const std::uint64_t parity = 0x1BD11BDAA9FC1A22;
+
+        // rotation constants, the pairs of words are mixed alternately
+        const unsigned rotations[8][2] = {{14, 16}, {52, 57}, {23, 40}, {5, 37},
+                                          {25, 33}, {46, 12}, {58, 22}, {32, 32}};
+
+        std::uint64_t rotl(std::uint64_t x, unsigned r) {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        void store_block(const threefry4x64::counter_type &block, std::uint8_t *out) {
+            for (std::size_t i = 0; i < 32; i++) {
+                out[i] = static_cast<std::uint8_t>(block[i / 8] >> (8 * (i % 8)));
+            }
+        }
+
+#ifdef STREAMS_X86_DISPATCH
+        STREAMS_TARGET("avx2")
+        __m256i rotl(__m256i x, unsigned r) {
+            return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128(int(r))),
+                                   _mm256_srl_epi64(x, _mm_cvtsi32_si128(int(64 - r))));
+        }
+
+        /**
+         * Four blocks at once, each register holds one word of all the four counters
+         */
+        STREAMS_TARGET("avx2")
+        void generate_avx2(const threefry4x64::key_type &key, unsigned rounds, std::uint64_t first,
+                           std::size_t count, std::uint8_t *out) {
+            __m256i ks[5];
+            for (unsigned i = 0; i < 5; i++) {
+                ks[i] = _mm256_set1_epi64x(static_cast<long long>(key[i]));
+            }
+
+            for (; count >= 4; count -= 4, first += 4, out += 128) {
+                const auto f = static_cast<long long>(first);
+                __m256i x[4] = {_mm256_add_epi64(_mm256_setr_epi64x(f, f + 1, f + 2, f + 3), ks[0]), ks[1],
+                                ks[2], ks[3]};
+
+                for (unsigned r = 0; r < rounds; r++) {
+                    const unsigned *rotation = rotations[r % 8];
+                    if (r % 2 == 0) {
+                        x[0] = _mm256_add_epi64(x[0], x[1]);
+                        x[1] = _mm256_xor_si256(rotl(x[1], rotation[0]), x[0]);
+                        x[2] = _mm256_add_epi64(x[2], x[3]);
+                        x[3] = _mm256_xor_si256(rotl(x[3], rotation[1]), x[2]);
+                    } else {
+                        x[0] = _mm256_add_epi64(x[0], x[3]);
+                        x[3] = _mm256_xor_si256(rotl(x[3], rotation[0]), x[0]);
+                        x[2] = _mm256_add_epi64(x[2], x[1]);
+                        x[1] = _mm256_xor_si256(rotl(x[1], rotation[1]), x[2]);
+                    }
+                    if (r % 4 == 3) {
+                        const unsigned s = (r + 1) / 4;
+                        for (unsigned i = 0; i < 4; i++) {
+                            x[i] = _mm256_add_epi64(x[i], ks[(s + i) % 5]);
+                        }
+                        x[3] = _mm256_add_epi64(x[3], _mm256_set1_epi64x(s));
+                    }
+                }
+
+                // transpose to four consecutive blocks
+                const __m256i t0 = _mm256_unpacklo_epi64(x[0], x[1]); // blocks 0 and 2
+                const __m256i t1 = _mm256_unpackhi_epi64(x[0], x[1]); // blocks 1 and 3
+                const __m256i t2 = _mm256_unpacklo_epi64(x[2], x[3]);
+                const __m256i t3 = _mm256_unpackhi_epi64(x[2], x[3]);
+
+                auto *dst = reinterpret_cast<__m256i *>(out);
+                _mm256_storeu_si256(dst + 0, _mm256_permute2x128_si256(t0, t2, 0x20));
+                _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(t1, t3, 0x20));
+                _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(t0, t2, 0x31));
+                _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(t1, t3, 0x31));
+            }
+        }
+#endif
+    }
+
+    constexpr std::size_t threefry4x64::block_size;
+    constexpr std::size_t threefry4x64::key_size;
+    constexpr unsigned threefry4x64::default_rounds;
+    constexpr unsigned threefry4x64::max_rounds;
+
+    threefry4x64::threefry4x64(const std::uint8_t *key, const unsigned rounds)
+            : _rounds(rounds) {
+        if (rounds < 1 || rounds > max_rounds)
+            throw std::runtime_error("Threefry4x64 supports 1 to " + std::to_string(max_rounds) + " rounds");
+        set_key(key);
+    }
+
+    void threefry4x64::set_key(const std::uint8_t *key) {
+        _key.fill(0);
+        for (std::size_t i = 0; i < key_size; i++) {
+            _key[i / 8] |= std::uint64_t(key[i]) << (8 * (i % 8));
+        }
+        _key[4] = parity ^ _key[0] ^ _key[1] ^ _key[2] ^ _key[3];
+    }
+
+    threefry4x64::counter_type threefry4x64::block(counter_type x) const {
+        for (unsigned i = 0; i < 4; i++) {
+            x[i] += _key[i];
+        }
+
+        for (unsigned r = 0; r < _rounds; r++) {
+            const unsigned *rotation = rotations[r % 8];
+            if (r % 2 == 0) {
+                x[0] += x[1];
+                x[1] = rotl(x[1], rotation[0]) ^ x[0];
+                x[2] += x[3];
+                x[3] = rotl(x[3], rotation[1]) ^ x[2];
+            } else {
+                x[0] += x[3];
+                x[3] = rotl(x[3], rotation[0]) ^ x[0];
+                x[2] += x[1];
+                x[1] = rotl(x[1], rotation[1]) ^ x[2];
+            }
+            // key injection after every four rounds
+            if (r % 4 == 3) {
+                const unsigned s = (r + 1) / 4;
+                for (unsigned i = 0; i < 4; i++) {
+                    x[i] += _key[(s + i) % 5];
+                }
+                x[3] += s;
+            }
+        }
+        return x;
+    }
+
+    void threefry4x64::generate(std::uint64_t first, std::size_t count, std::uint8_t *out,
+                                const bool use_simd) const {
+#ifdef STREAMS_X86_DISPATCH
+        if (use_simd && simd::has_avx2()) {
+            generate_avx2(_key, _rounds, first, count, out);
+            first += count - count % 4;
+            out += (count - count % 4) * block_size;
+            count %= 4;
+        }
+#else
+        (void)use_simd;
+#endif
+        for (; count != 0; count--, first++, out += block_size) {
+            store_block(block({{first, 0, 0, 0}}), out);
+        }
+    }
+}
@@ -8,9 +8,22 @@ namespace prng {
 
     prng_factory::prng_factory(const json& config, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes)
             : _generator(create_prng_interface(config, seeder, pipes))
-    {}
+    {
+        // number of outputs to skip, generators started at different offsets share one sequence
+        const std::uint64_t offset = config.value("offset", std::uint64_t(0));
+        if (offset != 0)
+            _generator->jump(offset);
+    }
 
     void prng_factory::generate_bits(unsigned char *data, size_t number_of_bytes) {
         _generator->generate_bits(data, number_of_bytes);
     }
+
+    void prng_factory::skip(size_t number_of_bytes, std::uint64_t count) {
+        _generator->skip(number_of_bytes, count);
+    }
+
+    bool prng_factory::seekable() const {
+        return _generator->seekable();
+    }
 }
@@ -17,12 +17,16 @@ namespace prng {
     create_testu01_interface(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes);
     std::unique_ptr<prng_interface>
     create_std_prng_interface(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes);
+    std::unique_ptr<prng_interface>
+    create_cbrng_interface(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes);
 
     class prng_factory {
 
     public:
         prng_factory(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes);
         void generate_bits(unsigned char* data, size_t number_of_bytes);
+        void skip(size_t number_of_bytes, std::uint64_t count);
+        bool seekable() const;
 
     private:
         std::unique_ptr<prng_interface> create_prng_interface(const json& configuration, default_seed_source& seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes) {
@@ -30,6 +34,8 @@ namespace prng {
                 return create_testu01_interface(configuration, seeder, pipes);
             } else if (configuration.at("algorithm").get<std::string>().find("std") == 0) {
                 return create_std_prng_interface(configuration, seeder, pipes);
+            } else if (configuration.at("algorithm").get<std::string>().find("cbrng") == 0) {
+                return create_cbrng_interface(configuration, seeder, pipes);
             }
 
             throw std::runtime_error("requested prng named \"" + configuration.at("algorithm").get<std::string>() +
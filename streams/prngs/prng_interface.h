@@ -4,11 +4,73 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <vector>
+
 namespace prng {
 
     class prng_interface {
     public:
+        virtual ~prng_interface() = default;
+
         virtual void generate_bits(unsigned char* data, size_t number_of_bytes) = 0;
+
+        /**
+         * Advances the generator as if n outputs were generated and thrown away. Allows to split one
+         * sequence between several streams, each starting at a different offset.
+         * @param n number of generator outputs (words, not bytes) to skip
+         */
+        virtual void jump(std::uint64_t n) {
+            (void)n;
+            throw std::runtime_error("jump is not supported by this prng");
+        }
+
+        /**
+         * Moves over count calls of generate_bits with number_of_bytes each. Generators which
+         * can jump override this, by default the data are generated and thrown away.
+         */
+        virtual void skip(size_t number_of_bytes, std::uint64_t count) {
+            std::vector<unsigned char> discarded(number_of_bytes);
+            for (; count != 0; --count) {
+                generate_bits(discarded.data(), number_of_bytes);
+            }
+        }
+
+        /**
+         * Whether skip jumps over the data instead of generating them
+         */
+        virtual bool seekable() const {
+            return false;
+        }
     };
+
+    /**
+     * Stores the lowest number_of_bytes bytes of the word in little-endian order
+     */
+    template <std::size_t number_of_bytes, typename Word>
+    inline void store_little_endian(std::uint8_t* data, Word word) {
+        for (std::size_t i = 0; i < number_of_bytes; i++) {
+            data[i] = static_cast<std::uint8_t>(word >> (8 * i));
+        }
+    }
+
+    /**
+     * Fills the buffer with outputs of the generator, each stored in little-endian order in
+     * number_of_bytes bytes. Unused bytes of the last output are discarded.
+     */
+    template <std::size_t number_of_bytes, typename NextWord>
+    inline void fill_words(std::uint8_t* data, size_t size, NextWord&& next_word) {
+        std::uint8_t* const end_of_words = data + size - size % number_of_bytes;
+        for (; data != end_of_words; data += number_of_bytes) {
+            store_little_endian<number_of_bytes>(data, next_word());
+        }
+        if (data != end_of_words + size % number_of_bytes) {
+            const auto word = next_word();
+            for (std::size_t i = 0; i < size % number_of_bytes; i++) {
+                data[i] = static_cast<std::uint8_t>(word >> (8 * i));
+            }
+        }
+    }
 }
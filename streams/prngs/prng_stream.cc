@@ -13,9 +13,16 @@ namespace prng {
         return make_cview(_data);
     }
 
+    void prng_stream::skip(std::uint64_t count) {
+        _generator->skip(_data.size(), count);
+    }
+
+    bool prng_stream::seekable() const {
+        return _generator->seekable();
+    }
+
     prng_stream::prng_stream(const json& config, default_seed_source& seeder, std::size_t osize, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes)
             : stream(osize)
             , _generator(std::make_unique<prng_factory>(config, seeder, pipes))
-            , _data(osize)
     {}
 }
@@ -18,8 +18,11 @@ namespace prng {
 
         vec_cview next() override;
 
+        void skip(std::uint64_t count) override;
+
+        bool seekable() const override;
+
     private:
         std::unique_ptr<prng_factory> _generator;
-        std::vector<uint8_t> _data;
     };
 }
@@ -9,7 +9,7 @@
 
 namespace prng {
     
-    class mersenne_twister_generator : public std_prng_interface<std::mt19937, uint32_t, uint32_t> {
+    class mersenne_twister_generator : public std_prng_interface<mersenne_twister, uint32_t, uint32_t> {
     public:
         mersenne_twister_generator(const json &config, default_seed_source &seeder, std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes) : mersenne_twister_generator(
                 make_stream(config.at("seeder"), seeder, pipes, 4), config.value("reseed_for_each_test_vector", false)) {}
@@ -0,0 +1,201 @@
+//
+// Mersenne Twister with jump-ahead
+//
+
+#include "mersenne_twister.h"
+#include <stdexcept>
+#include <vector>
+
+namespace prng {
+
+    namespace {
+
+        // dimension of the MT19937 state space, 624 * 32 - 31
+        const std::size_t degree = 19937;
+
+        using polynomial = std::vector<std::uint64_t>; // GF(2) coefficients, bit i is x^i
+
+        bool coefficient(const polynomial &p, std::size_t i) {
+            return (p[i / 64] >> (i % 64)) & 1;
+        }
+
+        void flip(polynomial &p, std::size_t i) {
+            p[i / 64] ^= std::uint64_t(1) << (i % 64);
+        }
+
+        bool parity(std::uint64_t word) {
+            for (unsigned shift = 32; shift != 0; shift /= 2) {
+                word ^= word >> shift;
+            }
+            return word & 1;
+        }
+
+        /**
+         * 64 bits of p starting at the i-th one, p needs one word of padding
+         */
+        std::uint64_t bits_at(const polynomial &p, std::size_t i) {
+            const std::size_t word = i / 64;
+            const unsigned shift = i % 64;
+            if (shift == 0)
+                return p[word];
+            return (p[word] >> shift) | (p[word + 1] << (64 - shift));
+        }
+
+        /**
+         * dst ^= src * x^shift
+         */
+        void add_shifted(polynomial &dst, const polynomial &src, std::size_t shift) {
+            const std::size_t words = shift / 64;
+            const unsigned bits = shift % 64;
+            for (std::size_t i = 0; i + words < dst.size() && i < src.size(); ++i) {
+                dst[i + words] ^= src[i] << bits;
+                if (bits != 0 && i + words + 1 < dst.size())
+                    dst[i + words + 1] ^= src[i] >> (64 - bits);
+            }
+        }
+
+        /**
+         * Characteristic polynomial of the MT19937 transition, found by the Berlekamp-Massey
+         * algorithm from the lowest bits of 2 * degree consecutive outputs
+         */
+        polynomial compute_characteristic_polynomial() {
+            const std::size_t length = 2 * degree;
+            const std::size_t words = length / 64 + 3;
+
+            // reversed sequence, s_n is stored at the position length - 1 - n
+            polynomial reversed(words, 0);
+            // P is irreducible and the tempering is linear, so the minimal polynomial of any
+            // nonzero output bit sequence is P
+            mersenne_twister generator;
+            for (std::size_t n = 0; n < length; ++n) {
+                if (generator() & 1)
+                    flip(reversed, length - 1 - n);
+            }
+
+            polynomial c(words, 0); // connection polynomial
+            polynomial b(words, 0);
+            c[0] = b[0] = 1;
+            std::size_t l = 0;
+            std::size_t m = 1;
+            for (std::size_t n = 0; n < length; ++n) {
+                const std::size_t offset = length - 1 - n;
+                std::uint64_t discrepancy = 0;
+                for (std::size_t i = 0; i <= l / 64; ++i) {
+                    discrepancy ^= c[i] & bits_at(reversed, offset + 64 * i);
+                }
+                if (!parity(discrepancy)) {
+                    ++m;
+                } else if (2 * l <= n) {
+                    polynomial previous = c;
+                    add_shifted(c, b, m);
+                    l = n + 1 - l;
+                    b = std::move(previous);
+                    m = 1;
+                } else {
+                    add_shifted(c, b, m);
+                    ++m;
+                }
+            }
+            if (l != degree)
+                throw std::logic_error("unexpected linear complexity of mt19937");
+
+            // characteristic polynomial is the reciprocal of the connection polynomial
+            polynomial p(degree / 64 + 1, 0);
+            for (std::size_t i = 0; i <= degree; ++i) {
+                if (coefficient(c, degree - i))
+                    flip(p, i);
+            }
+            return p;
+        }
+
+        const polynomial &characteristic_polynomial() {
+            static const polynomial p = compute_characteristic_polynomial();
+            return p;
+        }
+
+        /**
+         * x^n mod p, p of the given degree
+         */
+        polynomial x_power_mod(std::uint64_t n, const polynomial &p) {
+            const std::size_t words = p.size();
+
+            // p * x^s for s in [0, 64), so reduction is done by aligned word operations
+            std::vector<polynomial> shifted(64, polynomial(words + 1, 0));
+            for (unsigned s = 0; s < 64; ++s) {
+                add_shifted(shifted[s], p, s);
+            }
+
+            const auto reduce = [&](polynomial &r) {
+                for (std::size_t i = r.size() * 64; i-- > degree;) {
+                    if (!coefficient(r, i))
+                        continue;
+                    const std::size_t shift = i - degree;
+                    const polynomial &q = shifted[shift % 64];
+                    for (std::size_t w = 0; w < q.size() && w + shift / 64 < r.size(); ++w) {
+                        r[w + shift / 64] ^= q[w];
+                    }
+                }
+                r.resize(words);
+            };
+
+            polynomial result(words, 0);
+            result[0] = 1;
+            for (int bit = 63; bit >= 0; --bit) {
+                // squaring over GF(2) spreads the coefficients to the even positions
+                polynomial square(2 * words, 0);
+                for (std::size_t w = 0; w < words; ++w) {
+                    for (unsigned i = 0; i < 64; ++i) {
+                        if ((result[w] >> i) & 1)
+                            flip(square, 2 * (64 * w + i));
+                    }
+                }
+                reduce(square);
+                result = std::move(square);
+
+                if ((n >> bit) & 1) {
+                    polynomial shifted_result(words + 1, 0);
+                    add_shifted(shifted_result, result, 1);
+                    reduce(shifted_result);
+                    result = std::move(shifted_result);
+                }
+            }
+            return result;
+        }
+    }
+
+    void mersenne_twister::seed(const result_type value) {
+        _x[0] = value;
+        for (std::size_t i = 1; i < state_size; ++i) {
+            _x[i] = 1812433253u * (_x[i - 1] ^ (_x[i - 1] >> 30)) + result_type(i);
+        }
+        _index = 0;
+    }
+
+    void mersenne_twister::add(const mersenne_twister &other) {
+        for (std::size_t j = 0; j < state_size; ++j) {
+            const std::size_t i = _index + j < state_size ? _index + j : _index + j - state_size;
+            const std::size_t o = other._index + j < state_size ? other._index + j
+                                                                : other._index + j - state_size;
+            _x[i] ^= other._x[o];
+        }
+    }
+
+    void mersenne_twister::jump(const std::uint64_t n) {
+        if (n < degree) {
+            discard(n);
+            return;
+        }
+
+        const polynomial jump_polynomial = x_power_mod(n, characteristic_polynomial());
+
+        mersenne_twister result;
+        result._x.fill(0);
+        result._index = _index;
+        for (std::size_t i = degree; i-- > 0;) {
+            result.next_state();
+            if (coefficient(jump_polynomial, i))
+                result.add(*this);
+        }
+        *this = result;
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Mersenne Twister with jump-ahead
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace prng {
+
+    /**
+     * @brief MT19937 producing the same outputs as std::mt19937, with jump-ahead
+     *
+     * The state is kept as a circular buffer of 624 words and one word is regenerated per output,
+     * so a single step is a linear map T on the state. Jumping n steps evaluates the polynomial
+     * x^n mod P(x) at T (Horner's scheme), where P is the characteristic polynomial of T
+     * (Haramoto et al., Efficient Jump Ahead for F2-Linear Random Number Generators, 2008).
+     */
+    class mersenne_twister {
+    public:
+        using result_type = std::uint32_t;
+
+        static constexpr std::size_t state_size = 624;
+        static constexpr std::size_t shift_size = 397;
+        static constexpr result_type default_seed = 5489u;
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+        explicit mersenne_twister(result_type value = default_seed) { seed(value); }
+
+        /**
+         * Same initialization as std::mt19937::seed
+         */
+        void seed(result_type value);
+
+        result_type operator()() { return temper(next_state()); }
+
+        void discard(std::uint64_t n) {
+            for (; n != 0; --n) {
+                next_state();
+            }
+        }
+
+        /**
+         * Equivalent to discard(n), the cost is independent of n
+         */
+        void jump(std::uint64_t n);
+
+    private:
+        static constexpr result_type matrix_a = 0x9908B0DFu;
+        static constexpr result_type upper_mask = 0x80000000u;
+        static constexpr result_type lower_mask = 0x7FFFFFFFu;
+
+        result_type next_state() {
+            const std::size_t i = _index;
+            const std::size_t next = i + 1 < state_size ? i + 1 : 0;
+            const std::size_t shifted =
+                    i + shift_size < state_size ? i + shift_size : i + shift_size - state_size;
+
+            const result_type y = (_x[i] & upper_mask) | (_x[next] & lower_mask);
+            _x[i] = _x[shifted] ^ (y >> 1) ^ ((y & 1) ? matrix_a : 0);
+            _index = next;
+            return _x[i];
+        }
+
+        static result_type temper(result_type y) {
+            y ^= y >> 11;
+            y ^= (y << 7) & 0x9D2C5680u;
+            y ^= (y << 15) & 0xEFC60000u;
+            return y ^ (y >> 18);
+        }
+
+        /**
+         * Adds (xor) the state of other word by word, starting at the oldest word of both
+         */
+        void add(const mersenne_twister &other);
+
+        std::array<result_type, state_size> _x;
+        std::size_t _index; // position of the oldest word, regenerated by the next step
+    };
+}
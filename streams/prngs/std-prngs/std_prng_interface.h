@@ -7,9 +7,55 @@
 #include <utility>
 #include <stream.h>
 #include <random>
+#include <sstream>
+#include <streams/prngs/std-prngs/mersenne_twister.h>
 
 namespace prng {
 
+    /**
+     * Engines without a jump-ahead step through the outputs
+     */
+    template <typename Generator>
+    void jump_generator(Generator &generator, std::uint64_t n) {
+        generator.discard(n);
+    }
+
+    /**
+     * x_(i + n) = a^n * x_i mod m, the state of the engine is its last output
+     */
+    template <typename UIntType, UIntType a, UIntType m>
+    void jump_generator(std::linear_congruential_engine<UIntType, a, 0, m> &generator, std::uint64_t n) {
+        static_assert(m != 0 && m <= (std::uint64_t(1) << 32), "products of two states have to fit 64 bits");
+
+        std::stringstream state;
+        state << generator;
+        std::uint64_t x;
+        state >> x;
+
+        std::uint64_t power = 1;
+        for (std::uint64_t base = a % m; n != 0; n >>= 1, base = base * base % m) {
+            if (n & 1)
+                power = power * base % m;
+        }
+        generator.seed(UIntType(power * x % m));
+    }
+
+    inline void jump_generator(mersenne_twister &generator, std::uint64_t n) {
+        generator.jump(n);
+    }
+
+    /**
+     * Whether jump_generator takes time independent of n
+     */
+    template <typename Generator>
+    struct jumps_ahead : std::false_type {};
+
+    template <typename UIntType, UIntType a, UIntType m>
+    struct jumps_ahead<std::linear_congruential_engine<UIntType, a, 0, m>> : std::true_type {};
+
+    template <>
+    struct jumps_ahead<mersenne_twister> : std::true_type {};
+
     template <typename Generator, typename SeedType, typename OutputType>
     class std_prng_interface : public prng_interface {
     protected:
@@ -26,24 +72,36 @@ namespace prng {
                 , _reseed_for_each_test_vector(reseed_for_each_test_vector) {}
 
         void generate_bits(std::uint8_t *data, size_t number_of_bytes) override {
-            size_t current_index = 0;
-
-            while (number_of_bytes > 0) {
+            fill_words<sizeof(OutputType)>(data, number_of_bytes, [this]() { return OutputType(_generator()); });
 
-                OutputType generated_data = _generator(); // Get new Bytes from generator
+            if (_reseed_for_each_test_vector) {
+                _seed = _seeder->next();
+                _generator.seed(*reinterpret_cast<const SeedType*>(_seed.data()));
+            }
+        }
 
-                for (auto i = 0; i < std::min<size_t>(number_of_bytes, sizeof(OutputType)); i++) {
-                    data[current_index++] = static_cast<std::uint8_t>(generated_data & 0xFF);
-                    generated_data >>= 8;
-                }
+        void jump(std::uint64_t n) override {
+            jump_generator(_generator, n);
+        }
 
-                number_of_bytes -= std::min<size_t>(number_of_bytes, sizeof(OutputType));
-            }
+        void skip(size_t number_of_bytes, std::uint64_t count) override {
+            if (count == 0)
+                return;
 
             if (_reseed_for_each_test_vector) {
+                // only the seed of the last skipped vector matters
+                _seeder->skip(count - 1);
                 _seed = _seeder->next();
                 _generator.seed(*reinterpret_cast<const SeedType*>(_seed.data()));
+                return;
             }
+
+            const std::uint64_t words = (number_of_bytes + sizeof(OutputType) - 1) / sizeof(OutputType);
+            jump_generator(_generator, count * words);
+        }
+
+        bool seekable() const override {
+            return _reseed_for_each_test_vector ? _seeder->seekable() : jumps_ahead<Generator>::value;
         }
     };
 }
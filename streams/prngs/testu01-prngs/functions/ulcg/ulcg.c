@@ -2402,6 +2402,49 @@ unif01_Gen *ulcg_CreateCombWH3 (long m1, long m2, long m3, long a1,
 
 /**************************************************************************/
 
+/*-------------------------------------------------------------------------*/
+/* CryptoStreams addition: in-place reseeding and jump-ahead of the
+ * generators created by ulcg_CreateLCG */
+
+static long MultModLCG (long a, long s, long c, long m)
+/*
+ * Returns (a*s + c) % m for 0 <= a, s, c < m
+ */
+{
+   if ((a == 0) || (s == 0))
+      return c;
+   return num_MultModL (a, s, c, m);
+}
+
+void ulcg_SetStateLCG (unif01_Gen * gen, long s)
+{
+   LCG_param *param = gen->param;
+   LCG_state *state = gen->state;
+
+   if ((s < 0) || (s >= param->M))
+      util_Error ("ulcg_SetStateLCG:   Invalid parameter");
+   state->S = s;
+}
+
+void ulcg_JumpLCG (unif01_Gen * gen, unsigned long long n)
+{
+   LCG_param *param = gen->param;
+   LCG_state *state = gen->state;
+   long a = param->A;
+   long c = param->C;
+
+   /* (a, c) is the map x -> a*x + c applied 2^i times at the i-th bit of n */
+   while (n > 0) {
+      if (n & 1)
+         state->S = MultModLCG (a, state->S, c, param->M);
+      c = MultModLCG (a, c, c, param->M);
+      a = MultModLCG (a, a, 0, param->M);
+      n >>= 1;
+   }
+}
+
+/*-------------------------------------------------------------------------*/
+
 void ulcg_DeleteGen (unif01_Gen * gen)
 {
    unif01_DeleteGen (gen);
@@ -109,6 +109,12 @@ unif01_Gen * ulcg_CreateCombWH3 (long m1, long m2, long m3, long a1,
 #endif
 
 
+/* CryptoStreams addition, only for generators created by ulcg_CreateLCG:
+ * sets the state to s, or advances the generator by n steps in O(log n). */
+void ulcg_SetStateLCG (unif01_Gen *gen, long s);
+void ulcg_JumpLCG (unif01_Gen *gen, unsigned long long n);
+
+
 void ulcg_DeleteGen (unif01_Gen *gen);
 
  
@@ -29,18 +29,33 @@ namespace prng {
         explicit ulcg_generator(std::unique_ptr<stream> seeder, bool reseed, int64_t m, int64_t a, int64_t c)
                 : uniform_generator_interface(
                 [m, a, c](const value_type *seed) {
-
-                    int64_t s = 0;
-
-                    for (int64_t i = 0; i < get_viable_number_of_bytes(m); i++) {
-                        s |= static_cast<int64_t>(seed[i]) << (8 * i);
-                    }
-
-                    return std::unique_ptr<unif01_Gen, void (*)(unif01_Gen *)>(ulcg_CreateLCG(m, a, c, s),
+                    return std::unique_ptr<unif01_Gen, void (*)(unif01_Gen *)>(ulcg_CreateLCG(m, a, c, read_seed(m, seed)),
                                                                                ulcg_DeleteGen);
                 }
 
                 , seeder, reseed
-        ) {}
+        )
+                , _m(m) {}
+
+        void jump(std::uint64_t n) override {
+            ulcg_JumpLCG(_generator.get(), n);
+        }
+
+    protected:
+        void reseed(const value_type *seed) override {
+            ulcg_SetStateLCG(_generator.get(), read_seed(_m, seed));
+        }
+
+    private:
+        static int64_t read_seed(int64_t m, const value_type *seed) {
+            int64_t s = 0;
+
+            for (std::size_t i = 0; i < get_viable_number_of_bytes(m); i++) {
+                s |= static_cast<int64_t>(seed[i]) << (8 * i);
+            }
+            return s;
+        }
+
+        int64_t _m;
     };
 }
@@ -757,6 +757,126 @@ void umrg_DeleteMRG (unif01_Gen * gen)
 }
 
 
+/*-------------------------------------------------------------------------*/
+/* CryptoStreams addition: in-place reseeding and jump-ahead of the
+ * generators created by umrg_CreateMRG */
+
+static long MultModMRG (long a, long s, long c, long m)
+/*
+ * Returns (a*s + c) % m for 0 <= a, s, c < m
+ */
+{
+   if ((a == 0) || (s == 0))
+      return c;
+   return num_MultModL (a, s, c, m);
+}
+
+static void GetMRG (unif01_Gen * gen, int *k, long *m, long **X, long *A)
+/*
+ * Order k, modulus m and the state X[0..k-1] (most recent value first) of
+ * the generator. If A is not NULL, the coefficients reduced modulo m are
+ * stored in A[0..k-1]. The specialized implementations of order 2, 3, 5 and
+ * 7 have parameters a1, ak at the same place and the state made of x1..xk.
+ */
+{
+   MRG_param *param = gen->param;
+   int i;
+
+   if (param->kind == MRG_ALL) {
+      MRG_state *state = gen->state;
+      *k = state->k;
+      *m = param->M;
+      *X = state->S + 1;
+      if (A != NULL)
+         for (i = 0; i < *k; i++)
+            A[i] = ((param->A[i + 1] % *m) + *m) % *m;
+   } else {
+      MRG2_param *par = gen->param;
+      *k = par->kind;
+      *m = par->M;
+      *X = gen->state;
+      if (A != NULL) {
+         for (i = 0; i < *k; i++)
+            A[i] = 0;
+         A[0] = par->a1;
+         A[*k - 1] = par->a2;
+      }
+   }
+}
+
+void umrg_SetStateMRG (unif01_Gen * gen, long S[])
+{
+   int i, k, n = 0;
+   long m, *X;
+
+   GetMRG (gen, &k, &m, &X, NULL);
+   for (i = 0; i < k; i++) {
+      util_Assert (S[i] < m, "umrg_SetStateMRG:   S[i] >= m");
+      util_Assert (S[i] >= 0, "umrg_SetStateMRG:   S[i] < 0");
+      if (S[i] != 0)
+         n++;
+   }
+   util_Assert (n > 0, "umrg_SetStateMRG:   all S[i] are 0");
+   for (i = 0; i < k; i++)
+      X[i] = S[i];
+}
+
+static void MultMatMRG (int k, long m, long *A, long *B, long *C, long *T)
+/*
+ * C = A * B mod m for k x k matrices, T is a temporary matrix
+ */
+{
+   int i, j, l;
+   for (i = 0; i < k; i++)
+      for (j = 0; j < k; j++) {
+         long sum = 0;
+         for (l = 0; l < k; l++)
+            sum = MultModMRG (A[i * k + l], B[l * k + j], sum, m);
+         T[i * k + j] = sum;
+      }
+   memcpy (C, T, (size_t) k * k * sizeof (long));
+}
+
+void umrg_JumpMRG (unif01_Gen * gen, unsigned long long n)
+{
+   int i, j, k;
+   long m, *X, *A, *P, *R, *T, *Y;
+
+   GetMRG (gen, &k, &m, &X, NULL);
+   A = util_Calloc ((size_t) k, sizeof (long));
+   P = util_Calloc ((size_t) k * k, sizeof (long));
+   R = util_Calloc ((size_t) k * k, sizeof (long));
+   T = util_Calloc ((size_t) k * k, sizeof (long));
+   Y = util_Calloc ((size_t) k, sizeof (long));
+   GetMRG (gen, &k, &m, &X, A);
+
+   /* P is the companion matrix of one step, R = P^n by repeated squaring */
+   for (j = 0; j < k; j++)
+      P[j] = A[j];
+   for (i = 1; i < k; i++)
+      P[i * k + i - 1] = 1;
+   for (i = 0; i < k; i++)
+      R[i * k + i] = 1;
+   while (n > 0) {
+      if (n & 1)
+         MultMatMRG (k, m, R, P, R, T);
+      MultMatMRG (k, m, P, P, P, T);
+      n >>= 1;
+   }
+
+   for (i = 0; i < k; i++)
+      for (j = 0; j < k; j++)
+         Y[i] = MultModMRG (R[i * k + j], X[j], Y[i], m);
+   for (i = 0; i < k; i++)
+      X[i] = Y[i];
+
+   util_Free (A);
+   util_Free (P);
+   util_Free (R);
+   util_Free (T);
+   util_Free (Y);
+}
+
 /**************************************************************************/
 
 static double MRGFloat_U01 (void *vpar, void *vsta)
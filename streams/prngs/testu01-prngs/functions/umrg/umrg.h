@@ -42,6 +42,13 @@ unif01_Gen * umrg_CreateC2MRG (long m1, long m2, int k, long A1[],
 #endif
 
 
+/* CryptoStreams addition, only for generators created by umrg_CreateMRG:
+ * sets the state to S[0..k-1], or advances the generator by n steps in
+ * O(k^3 log n). */
+void umrg_SetStateMRG (unif01_Gen * gen, long S[]);
+void umrg_JumpMRG (unif01_Gen * gen, unsigned long long n);
+
+
 void umrg_DeleteMRG    (unif01_Gen * gen);
 void umrg_DeleteMRGFloat (unif01_Gen * gen);
 void umrg_DeleteLagFib (unif01_Gen * gen);
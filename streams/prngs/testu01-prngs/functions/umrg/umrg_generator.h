@@ -32,24 +32,45 @@ namespace prng {
         explicit umrg_generator(std::unique_ptr<stream> seeder, bool reseed, uint64_t m, std::vector<long>& a)
                 : uniform_generator_interface(
                 [m, a](const value_type *seed) mutable -> auto {
-                    std::vector<long> s(a.size());
-
-                    for (auto i = 0; i < s.size(); i++) {
-                        uint64_t value_of_seed = 0;
-                        for (auto j = 0; j < testu01_interface::get_viable_number_of_bytes(m); j++) {
-                            value_of_seed |= static_cast<uint64_t>(seed[i * testu01_interface::get_viable_number_of_bytes(m) + j]) <<  (j*8);
-                        }
-
-                        s[i] = value_of_seed;
-                    }
+                    std::vector<long> s = read_seed(m, a.size(), seed);
 
                     return std::unique_ptr<unif01_Gen, void (*)(unif01_Gen *)>(umrg_CreateMRG(m, static_cast<int>(a.size()), a.data(), s.data()), umrg_DeleteMRG);
                 }
                 , seeder, reseed
-        ) {}
+        )
+                , _m(m)
+                , _order(a.size()) {}
+
+        void jump(std::uint64_t n) override {
+            umrg_JumpMRG(_generator.get(), n);
+        }
 
         stream* get_seeder_stream() {
             return _seeder.get();
         }
+
+    protected:
+        void reseed(const value_type *seed) override {
+            std::vector<long> s = read_seed(_m, _order, seed);
+            umrg_SetStateMRG(_generator.get(), s.data());
+        }
+
+    private:
+        static std::vector<long> read_seed(uint64_t m, std::size_t order, const value_type *seed) {
+            std::vector<long> s(order);
+
+            for (std::size_t i = 0; i < s.size(); i++) {
+                uint64_t value_of_seed = 0;
+                for (std::size_t j = 0; j < get_viable_number_of_bytes(m); j++) {
+                    value_of_seed |= static_cast<uint64_t>(seed[i * get_viable_number_of_bytes(m) + j]) <<  (j*8);
+                }
+
+                s[i] = value_of_seed;
+            }
+            return s;
+        }
+
+        uint64_t _m;
+        std::size_t _order;
     };
 }
@@ -5,6 +5,7 @@
 
 #include <streams/prngs/prng_interface.h>
 #include <utility>
+#include <functional>
 
 extern "C" {
 #include <streams/prngs/testu01-prngs/includes/unif01.h>
@@ -31,27 +32,28 @@ namespace prng {
                 , _reseed_for_each_test_vector(reseed_for_each_test_vector) {}
 
         void generate_bits(std::uint8_t *data, size_t number_of_bytes) override {
-            int current_index = 0;
-
-            while (number_of_bytes > 0) {
-
-                uint64_t generated_data = _generator->GetBits(_generator->param,
-                                                              _generator->state); // Get new Bytes from generator
-
-                for (auto i = 0; i < std::min<size_t>(number_of_bytes, OUTPUT_SIZE); i++) {
-                    data[current_index++] = static_cast<std::uint8_t>(generated_data & 0xFF);
-                    generated_data >>= 8;
-                }
-
-                number_of_bytes -= std::min<size_t>(number_of_bytes, OUTPUT_SIZE);
-            }
+            GENERATOR *generator = _generator.get();
+            const auto get_bits = generator->GetBits;
+            fill_words<OUTPUT_SIZE>(data, number_of_bytes, [=]() -> uint64_t {
+                return get_bits(generator->param, generator->state);
+            });
 
             if (_reseed_for_each_test_vector) {
                 _seed = _seeder->next();
-                _generator = _generator_creator(_seed.data());
+                reseed(_seed.data());
             }
         }
 
+    protected:
+        /**
+         * Sets a new seed, generators which can change their state in place override it to avoid
+         * the reallocation of the whole generator
+         */
+        virtual void reseed(const value_type *seed) {
+            _generator = _generator_creator(seed);
+        }
+
+    public:
 
         /**
          *
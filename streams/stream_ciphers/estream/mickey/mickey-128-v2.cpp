@@ -6,6 +6,7 @@
 
 /* Include the header file ecrypt-sync.h, edited for MICKEY-128 v 2 */
 #include "ecrypt-sync.h"
+#include <mutex>
 
 namespace stream_ciphers {
 namespace estream {
@@ -23,12 +24,13 @@ u32 S_Mask0[5];
 u32 S_Mask1[5];
 /* Feedback mask associated with the register S for clock control bit = 1 */
 
+static std::once_flag masks_once;
+
 /*
- * Key and message independent initialization. This function will be
- * called once when the program starts.
+ * Key and message independent initialization, shared by all instances.
  */
 
-void ECRYPT_Mickey::ECRYPT_init(void) {
+static void init_masks(void) {
     /* Initialise the feedback mask associated with register R */
     R_Mask[0] = 0x42114d31;
     R_Mask[1] = 0xf3ec4c59;
@@ -64,6 +66,10 @@ void ECRYPT_Mickey::ECRYPT_init(void) {
     S_Mask1[4] = 0x11a780ef;
 }
 
+void ECRYPT_Mickey::ECRYPT_init(void) {
+    std::call_once(masks_once, init_masks);
+}
+
 /* The following routine clocks register R in ctx with given input and control bits */
 
 void CLOCK_R(MICKEY_ctx* ctx, int input_bit, int control_bit) {
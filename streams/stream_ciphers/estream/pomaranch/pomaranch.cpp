@@ -1,11 +1,14 @@
 #include "pomaranch.h"
 
+#include <mutex>
 #include <string.h>
 
 namespace stream_ciphers {
 namespace estream {
 
-void ECRYPT_Pomaranch::ECRYPT_init(void) {
+static std::once_flag wt_mod2_once;
+
+static void init_wt_mod2(void) {
     u16 i, j;
 
     /* calculate binary weight of all 8-bit vectors */
@@ -15,6 +18,10 @@ void ECRYPT_Pomaranch::ECRYPT_init(void) {
             wt_mod2[i + j] = 1 - wt_mod2[j];
 }
 
+void ECRYPT_Pomaranch::ECRYPT_init(void) {
+    std::call_once(wt_mod2_once, init_wt_mod2);
+}
+
 void ECRYPT_Pomaranch::ECRYPT_keysetup(const u8* key8, u32 keysize, u32 ivsize) {
     POMARANCH_ctx* ctx = &_ctx;
     int i;
@@ -12,6 +12,7 @@
 /* of Py, nor for using the submitted code.      */
 
 #include "ecrypt-sync.h"
+#include <mutex>
 #include <string.h>
 
 #ifdef DEBUG
@@ -189,7 +190,7 @@ void ECRYPT_Py::ECRYPT_ivsetup(const u8* iv) {
 /* All computations are made in multiples of                 */
 /* NUMBLOCKSATONCE*8 bytes, if possible                      */
 
-static u32 PY[(NUMBLOCKSATONCE + PYSIZE) * 2];
+static thread_local u32 PY[(NUMBLOCKSATONCE + PYSIZE) * 2];
 #define P(i8, j) (((u8*)PY)[(i8) + 8 * (j) + 4])
 /* access P[i+j] where i8=8*i. */
 /* P is byte 4 of the 8-byte record */
@@ -370,7 +371,9 @@ void ECRYPT_Py::PY_keystream_bytes(PY_ctx* ctx,
 #undef P
 #undef Y
 
-void ECRYPT_Py::ECRYPT_init(void) {
+static std::once_flag permutation_once;
+
+static void init_permutation(void) {
     int i;
     u8 j = 0;
     static u8 str[] =
@@ -393,6 +396,10 @@ void ECRYPT_Py::ECRYPT_init(void) {
     }
 }
 
+void ECRYPT_Py::ECRYPT_init(void) {
+    std::call_once(permutation_once, init_permutation);
+}
+
 void ECRYPT_Py::ECRYPT_encrypt_bytes(const u8* plaintext, u8* ciphertext, u32 msglen) {
     PY_process_bytes(0, &_ctx, plaintext, ciphertext, msglen);
 }
@@ -10,6 +10,7 @@
  */
 
 #include "ecrypt-sync.h"
+#include <mutex>
 
 namespace stream_ciphers {
 namespace estream {
@@ -17,6 +18,7 @@ namespace estream {
 /* Two S-boxes, the first is only temporary, the second will contain the 16-bit inversion S-Box*/
 u16 POWER[65536];
 u16 INV[65536];
+static std::once_flag sbox_once;
 
 /*
  * lfsr_clock
@@ -93,11 +95,13 @@ void GFpower() {
 
 /*
  * ECRYPT_init
- * Initializes the (16,16) inversion S-box
+ * Initializes the (16,16) inversion S-box, once for all instances
  */
 void ECRYPT_Sfinks::ECRYPT_init() {
-    GFexp();
-    GFpower();
+    std::call_once(sbox_once, [] {
+        GFexp();
+        GFpower();
+    });
 }
 
 /*
@@ -334,7 +334,7 @@ static INLINE void encode32le(unsigned char* dst, unum32 val) {
 
 /* ======================================================================== */
 
-static int num_rounds;
+static thread_local int num_rounds;
 
 #ifdef SOSEMANUK_ECRYPT
 void ECRYPT_Sosemanuk::ECRYPT_init(void) {
@@ -553,6 +553,7 @@ void sosemanuk_init(sosemanuk_run_context* rc,
     SOSEMANUK_ctx* ctx = &_ctx;
 
 #ifdef SOSEMANUK_ECRYPT
+    num_rounds = _rounds; // thread local, the instance may run on another thread than ECRYPT_init
 #define rc ctx
 #define kc ctx
 #define iv_len (ctx->ivlen)
@@ -1131,6 +1132,7 @@ void ECRYPT_Sosemanuk::SOSEMANUK_process_bytes(
         int action, void* ctxa, const u8* input, u8* output, u32 msglen) {
     SOSEMANUK_ctx* ctx = (SOSEMANUK_ctx*)ctxa;
     (void)action;
+    num_rounds = _rounds;
 
     while (msglen > 0) {
         u32 ibuf[SOSEMANUK_BLOCKLENGTH / 4];
@@ -1152,6 +1154,7 @@ void ECRYPT_Sosemanuk::SOSEMANUK_process_bytes(
 /* see ecrypt-sync.h */
 void ECRYPT_Sosemanuk::SOSEMANUK_keystream_bytes(SOSEMANUK_ctx* ctx, u8* keystream, u32 length) {
     static const u32 zb[SOSEMANUK_BLOCKLENGTH] = {};
+    num_rounds = _rounds;
 
     while (length > 0) {
         u32 tbuf[SOSEMANUK_BLOCKLENGTH / 4];
@@ -1172,6 +1175,7 @@ void ECRYPT_Sosemanuk::SOSEMANUK_keystream_bytes(SOSEMANUK_ctx* ctx, u8* keystre
 void ECRYPT_Sosemanuk::SOSEMANUK_process_blocks(
         int action, SOSEMANUK_ctx* ctx, const u8* input, u8* output, u32 blocks) {
     (void)action;
+    num_rounds = _rounds;
 
     while (blocks-- > 0) {
         sosemanuk_internal(ctx, (u32*)input, (u32*)output);
@@ -1183,6 +1187,7 @@ void ECRYPT_Sosemanuk::SOSEMANUK_process_blocks(
 /* see ecrypt-sync.h */
 void ECRYPT_Sosemanuk::SOSEMANUK_keystream_blocks(SOSEMANUK_ctx* ctx, u8* keystream, u32 blocks) {
     static const u32 zb[SOSEMANUK_BLOCKLENGTH / 4] = {};
+    num_rounds = _rounds;
 
     while (blocks-- > 0) {
         sosemanuk_internal(ctx, zb, (u32*)keystream);
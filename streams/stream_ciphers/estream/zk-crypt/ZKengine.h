@@ -81,9 +81,6 @@ static const BYTE MACnibMix[32] =  { 3, 2, 1, 0, 7, 6, 5, 4,11,10, 9, 8,15,14,13
 /*	PRIVATE 
 ***************/
 
- /* ZK-crypt INIT options */
-	DWORD initOptions;
-
 	/* nLFSR Bank	*/
 	DWORD nLFSR_Bank(ZKCRYPT_ctx* ctx);
 	DWORD runBank(ZKCRYPT_ctx* ctx, DWORD* ptrState, BYTE control, 
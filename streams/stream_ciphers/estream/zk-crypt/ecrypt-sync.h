@@ -120,6 +120,9 @@ typedef struct {
 
     u16 delayedBuffer; /* 9 bit  */
 
+    u32 initOptions; /* ZK-crypt INIT options */
+    u8 F3, F4, F5, F6, F7, F8; /* feedback of the random clock */
+
     /* DEBUG */
     u32 sttTest;
     u32 clockTest;
@@ -110,7 +110,8 @@ void ECRYPT_Zkcrypt::ECRYPT_init(void) {
 
     **********************/
 
-    initOptions = ZK_OPTI_SUPER;
+    _ctx.initOptions = ZK_OPTI_SUPER;
+    _ctx.F3 = _ctx.F4 = _ctx.F5 = _ctx.F6 = _ctx.F7 = _ctx.F8 = 0;
 }
 
 void ZKCRYPT_init_X(ZKCRYPT_ctx* ctx, u32 options) {
@@ -127,15 +128,15 @@ options = 3
     switch (options) {
     case 0:
     default:
-        initOptions = ZK_OPTI_SUPER;
+        ctx->initOptions = ZK_OPTI_SUPER;
         break;
 
     case 1:
-        initOptions = 0;
+        ctx->initOptions = 0;
         break;
 
     case 2:
-        initOptions = ZK_OPTI_LEGACY | ZK_OPTI_SUPER;
+        ctx->initOptions = ZK_OPTI_LEGACY | ZK_OPTI_SUPER;
         break;
     }
 }
@@ -354,7 +355,7 @@ DWORD nLFSR_Bank(ZKCRYPT_ctx* ctx) {
 
     /*	Super Bank 28L	&	29R	&	30	*/
     lclCtrlBank = ctx->ctrlSuperBank | CTRL_NLFSR_FB;
-    if ((initOptions & ZK_OPTI_SUPER) > 0)
+    if ((ctx->initOptions & ZK_OPTI_SUPER) > 0)
         tmpSprBank = runSuperBank(ctx,
                                   &(ctx->sttSuper),
                                   lclCtrlBank,
@@ -406,7 +407,7 @@ DWORD nLFSR_Bank(ZKCRYPT_ctx* ctx) {
     res = tmpMajBank ^ tmpRolBank;
 
     /* If using SUPER tier */
-    if ((initOptions & ZK_OPTI_SUPER) > 0)
+    if ((ctx->initOptions & ZK_OPTI_SUPER) > 0)
         res = res ^ tmpSprBank;
 
     return res;
@@ -1330,7 +1331,7 @@ void setHashVector(ZKCRYPT_ctx* ctx) {
     ctx->ctrlBotHashMatrix &= 0xF0;
 
     /* mobile mode fixed on D */
-    if ((initOptions & ZK_OPTI_LEGACY) > 0) {
+    if ((ctx->initOptions & ZK_OPTI_LEGACY) > 0) {
         ctx->ctrlTopHashMatrix |= CTRL_HASH_VECTOR_D;
         ctx->ctrlBotHashMatrix |= CTRL_HASH_VECTOR_D;
         return;
@@ -1380,12 +1381,11 @@ void cyclePRandomClock(ZKCRYPT_ctx* ctx, BOOL fClean)
 /*	4P	&	4C1B	&	4C2B	*/
 {
     BYTE tmpBit = 0, tmpA = 0, tmpB = 0;
-    static BYTE F3, F4, F5, F6, F7, F8;
     WORD tmpLongPClock = ctx->longPClock;
     BYTE tmpShortPClock = ctx->shortPClock;
 
     if (fClean == TRUE) {
-        F3 = F4 = F5 = F6 = F7 = F8 = 0;
+        ctx->F3 = ctx->F4 = ctx->F5 = ctx->F6 = ctx->F7 = ctx->F8 = 0;
         return;
     }
 
@@ -1416,30 +1416,30 @@ void cyclePRandomClock(ZKCRYPT_ctx* ctx, BOOL fClean)
     tmpBit = getBitAtLocation(ctx->sttClockFeedBack, CTRL_CLOCKS_FB_QTA);
 
     /*	Next State (Juggle Hash) */
-    F6 = (tmpBit ^ F5 ^ F3 ^ F6) & BIT_ONE;
-    if ((F6 & BIT_ONE) != 0)
+    ctx->F6 = (tmpBit ^ ctx->F5 ^ ctx->F3 ^ ctx->F6) & BIT_ONE;
+    if ((ctx->F6 & BIT_ONE) != 0)
         ctx->sttClockFeedBack_next |= CTRL_CLOCKS_FB_JUGG;
 
     /* Fourthmask	*/
-    F7 = (tmpBit ^ F5 ^ F3 ^ F7) & BIT_ONE;
-    if ((F7 & BIT_ONE) != 0)
+    ctx->F7 = (tmpBit ^ ctx->F5 ^ ctx->F3 ^ ctx->F7) & BIT_ONE;
+    if ((ctx->F7 & BIT_ONE) != 0)
         ctx->sttClockFeedBack_next |= CTRL_CLOCKS_FB_4TH;
 
     /* das	*/
-    F8 = (tmpBit ^ F3 ^ F4 ^ F8) & BIT_ONE;
-    if ((F8 & BIT_ONE) != 0)
+    ctx->F8 = (tmpBit ^ ctx->F3 ^ ctx->F4 ^ ctx->F8) & BIT_ONE;
+    if ((ctx->F8 & BIT_ONE) != 0)
         ctx->sttClockFeedBack_next |= CTRL_CLOCKS_FB_DAS;
 
-    F3 = (BYTE)(GETBIT_TWO(tmpLongPClock) ^ GETBIT_FIVE(tmpLongPClock) ^
-                GETBIT_EIGHT(tmpLongPClock));
+    ctx->F3 = (BYTE)(GETBIT_TWO(tmpLongPClock) ^ GETBIT_FIVE(tmpLongPClock) ^
+                     GETBIT_EIGHT(tmpLongPClock));
 
-    F4 = (BYTE)(GETBIT_THREE(tmpLongPClock) ^ GETBIT_SIX(tmpLongPClock) ^
-                GETBIT_NINE(tmpLongPClock));
+    ctx->F4 = (BYTE)(GETBIT_THREE(tmpLongPClock) ^ GETBIT_SIX(tmpLongPClock) ^
+                     GETBIT_NINE(tmpLongPClock));
 
-    F5 = (BYTE)(GETBIT_ONE(tmpLongPClock) ^ GETBIT_FOUR(tmpLongPClock) ^
-                GETBIT_SEVEN(tmpLongPClock));
+    ctx->F5 = (BYTE)(GETBIT_ONE(tmpLongPClock) ^ GETBIT_FOUR(tmpLongPClock) ^
+                     GETBIT_SEVEN(tmpLongPClock));
 
-    if (((F4 | F5 | (ctx->shortPClock & BIT_TWO)) & BIT_ONE) != 0) {
+    if (((ctx->F4 | ctx->F5 | (ctx->shortPClock & BIT_TWO)) & BIT_ONE) != 0) {
         ctx->ctrlClocks |= BIT_ONE; /* CTRL_PRND_CLOCK	*/
     }
 }
@@ -0,0 +1,265 @@
+//
+// Steady-state next() of the built-in streams must not allocate
+//
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdio>
+#include <eacirc-core/seed.h>
+#include <fstream>
+#include <glob.h>
+#include <memory>
+#include <streams.h>
+#include <testsuite/test_utils/allocation_counter.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const json counter_source = {{"type", "counter"}};
+const json random_source = {{"type", "pcg32_stream"}};
+
+// vectors of 16 bytes read by expect_no_allocations
+constexpr std::size_t read_vectors = 4 * 8 * 16 + 1024;
+
+void expect_no_allocations(const json &config, std::size_t osize = 16) {
+    seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+    std::unique_ptr<stream> s = make_stream(config, seeder, pipes, osize);
+
+    // the first vectors may still set up lazily initialized state
+    for (unsigned i = 0; i < 4 * 8 * osize; ++i)
+        s->next();
+
+    testsuite::allocation_counter counter;
+    for (unsigned i = 0; i < 1024; ++i)
+        s->next();
+    EXPECT_EQ(0u, counter.allocations()) << config.dump();
+}
+
+} // namespace
+
+TEST(allocations, counter_sees_other_threads) {
+    std::atomic<bool> start(false);
+    std::unique_ptr<int> allocated;
+    std::thread worker([&start, &allocated]() {
+        while (!start)
+            std::this_thread::yield();
+        allocated.reset(new int(1));
+    });
+
+    testsuite::allocation_counter counter;
+    start = true;
+    worker.join();
+    EXPECT_EQ(1u, counter.allocations());
+}
+
+TEST(allocations, tree_buffers_share_an_arena) {
+    std::unique_ptr<stream> tree;
+    aligned_buffer first;
+    aligned_buffer second;
+    {
+        const aligned_buffer::arena_scope arena;
+        first = aligned_buffer(10);
+        second = aligned_buffer(100);
+
+        seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+        tree = make_stream({{"type", "xor_stream"}, {"source", random_source}}, seeder, pipes, 24);
+    }
+    // consecutive buffers, each one rounded up to the alignment, the root before its source
+    EXPECT_EQ(first.data() + 64, second.data());
+    EXPECT_EQ(second.data() + 128, tree->get_data().data());
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first.data()) % 64);
+
+    // the arena outlives its scope
+    std::fill(second.begin(), second.end(), 0xff);
+    EXPECT_EQ(24u, tree->next().size());
+}
+
+TEST(allocations, source_streams) {
+    for (const json &config :
+         {json{{"type", "dummy_stream"}}, json{{"type", "true_stream"}},
+          json{{"type", "false_stream"}}, json{{"type", "mt19937_stream"}}, random_source,
+          json{{"type", "random_stream"}},
+          json{{"type", "pcg32_stream"}, {"bulk", true}}, json{{"type", "pcg32x8_stream"}},
+          counter_source, json{{"type", "random_start_counter"}}, json{{"type", "sac"}},
+          json{{"type", "sac_fixed_position"}, {"position", 3}},
+          json{{"type", "sac_2d_all_positions"}}, json{{"type", "hw_counter"}, {"hw", 2}}}) {
+        expect_no_allocations(config);
+    }
+}
+
+TEST(allocations, distribution_streams) {
+    for (const std::string sampler : {"std", "table"}) {
+        for (const json &config :
+             {json{{"type", "binomial_distribution"}, {"max_value", 8}, {"p", 0.3}},
+              json{{"type", "normal_distribution"}, {"mean", 0}, {"std_dev", 1}},
+              json{{"type", "poisson_distribution"}, {"mean", 4}},
+              json{{"type", "exponential_distribution"}, {"lambda", 1}}}) {
+            json with_sampler = config;
+            with_sampler["sampler"] = sampler;
+            expect_no_allocations(with_sampler);
+        }
+    }
+    expect_no_allocations({{"type", "bernoulli_distribution"}, {"p", 0.3}});
+    expect_no_allocations(
+        {{"type", "bernoulli_distribution"}, {"p", 0.3}, {"sampler", "bit_parallel"}});
+}
+
+TEST(allocations, modifier_streams) {
+    const json piped = {{"type", "tuple_stream"},
+                        {"sources",
+                         {{{"type", "pipe_in_stream"},
+                           {"id", "p"},
+                           {"output_size", 8},
+                           {"source", random_source}},
+                          {{"type", "pipe_out_stream"}, {"id", "p"}, {"output_size", 8}}}}};
+
+    for (const json &config :
+         {json{{"type", "single_value_stream"}, {"source", random_source}},
+          json{{"type", "repeating_stream"}, {"period", 3}, {"source", random_source}},
+          json{{"type", "xor_stream"}, {"source", random_source}},
+          json{{"type", "combine"},
+               {"operation", "add"},
+               {"word_size", 4},
+               {"sources", {random_source, counter_source, random_source}}},
+          json{{"type", "combine"},
+               {"operation", "rotate"},
+               {"word_size", 8},
+               {"shift", 13},
+               {"sources", {random_source}}},
+          json{{"type", "combine"},
+               {"operation", "select"},
+               {"mask", "f00f0ff0aa"},
+               {"sources", {random_source}}},
+          json{{"type", "column"}, {"size", 4}, {"source", counter_source}},
+          json{{"type", "columns"},
+               {"size", 4},
+               {"positions", {1, 30}},
+               {"layout", "interleaved"},
+               {"source", counter_source}},
+          json{{"type", "column_fixed_position"}, {"size", 4}, {"position", 5}, {"source", counter_source}},
+          piped, json{{"type", "threaded_stream"}, {"source", random_source}}}) {
+        expect_no_allocations(config);
+    }
+
+    json parallel = piped;
+    parallel["parallel"] = true;
+    parallel["sources"].push_back(
+        {{"type", "xor_stream"}, {"output_size", 8}, {"source", random_source}});
+    expect_no_allocations(parallel, 24);
+}
+
+TEST(allocations, cipher_streams) {
+    expect_no_allocations({{"type", "block"},
+                           {"init_frequency", "only_once"},
+                           {"algorithm", "AES"},
+                           {"round", 10},
+                           {"block_size", 16},
+                           {"plaintext", counter_source},
+                           {"key_size", 16},
+                           {"key", random_source},
+                           {"iv", random_source}});
+    expect_no_allocations({{"type", "hash"},
+                           {"algorithm", "SHA2"},
+                           {"round", 64},
+                           {"hash_size", 32},
+                           {"input_size", 32},
+                           {"source", counter_source}},
+                          32);
+    expect_no_allocations({{"type", "stream_cipher"},
+                           {"algorithm", "Salsa20"},
+                           {"round", 12},
+                           {"block_size", 64},
+                           {"plaintext", counter_source},
+                           {"key_size", 32},
+                           {"key", random_source},
+                           {"iv_size", 8},
+                           {"iv", random_source}},
+                          64);
+
+    // the older type names of the same streams
+    expect_no_allocations({{"type", "sha3"},
+                           {"algorithm", "Keccak"},
+                           {"round", 4},
+                           {"hash_size", 32},
+                           {"input_size", 32},
+                           {"source", counter_source}},
+                          32);
+    expect_no_allocations({{"type", "estream"},
+                           {"algorithm", "Salsa20"},
+                           {"round", 12},
+                           {"block_size", 64},
+                           {"plaintext", counter_source},
+                           {"key_size", 32},
+                           {"key", random_source},
+                           {"iv_size", 8},
+                           {"iv", random_source}},
+                          64);
+}
+
+TEST(allocations, prng_streams) {
+    for (const std::string algorithm :
+         {"std_lcg", "std_subtract_with_carry", "std_mersenne_twister", "testu01-ulcg",
+          "testu01-umrg", "testu01-uxorshift", "cbrng-philox4x32", "cbrng-threefry4x64",
+          "cbrng-splitmix64"}) {
+        expect_no_allocations({{"type", "prng"}, {"algorithm", algorithm}, {"seeder", random_source}});
+    }
+}
+
+TEST(allocations, input_streams) {
+    std::vector<value_type> data(read_vectors * 16);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = value_type(i * 7);
+
+    // mapped regular file and a special file read through a buffer
+    std::ofstream("allocation_file.bin", std::ios::binary)
+        .write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size()));
+    expect_no_allocations({{"type", "file_stream"}, {"path", "allocation_file.bin"}});
+    std::remove("allocation_file.bin");
+    expect_no_allocations({{"type", "file_stream"}, {"path", "/dev/zero"}});
+
+    // the pipe holds all the data, so nothing has to write it concurrently
+    for (const std::string type : {"fd_stream", "stdin_stream"}) {
+        int fds[2];
+        ASSERT_EQ(0, pipe(fds));
+        ASSERT_EQ(ssize_t(data.size()), write(fds[1], data.data(), data.size()));
+        close(fds[1]);
+        if (type == "fd_stream") {
+            expect_no_allocations({{"type", type}, {"fd", fds[0]}});
+        } else {
+            const int stdin_copy = dup(0);
+            ASSERT_EQ(0, dup2(fds[0], 0));
+            expect_no_allocations({{"type", type}});
+            dup2(stdin_copy, 0);
+            close(stdin_copy);
+        }
+        close(fds[0]);
+    }
+
+    json outputs = json::array();
+    for (unsigned i = 0; i < 3; ++i)
+        outputs.push_back(std::vector<value_type>(16, value_type(i)));
+    expect_no_allocations({{"type", "test_stream"}, {"outputs", outputs}});
+}
+
+TEST(allocations, materialized_replay) {
+    const json config = {
+        {"type", "materialize"}, {"dir", "allocation_materialize_dir"}, {"source", random_source}};
+    {
+        // stores the entry, which the checked stream only replays
+        seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+        std::vector<value_type> stored(read_vectors * 16);
+        make_stream(config, seeder, pipes, 16)->next_batch(stored.data(), read_vectors);
+    }
+    expect_no_allocations(config);
+
+    glob_t entries;
+    ASSERT_EQ(0, glob("allocation_materialize_dir/*", 0, nullptr, &entries));
+    for (std::size_t i = 0; i < entries.gl_pathc; ++i)
+        std::remove(entries.gl_pathv[i]);
+    globfree(&entries);
+    rmdir("allocation_materialize_dir");
+}
@@ -1,4 +1,10 @@
+#include "streams.h"
+#include <array>
+#include <chrono>
+#include <eacirc-core/seed.h>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <streams/block/block_factory.h>
 #include <testsuite/test_utils/block_test_case.h>
 
 TEST(aes, test_vectors) {
@@ -34,6 +40,27 @@ TEST(twofish, test_vectors) {
     testsuite::block_test_case("TWOFISH", 16)();
 }
 
+TEST(twofish, instances_keep_own_keys) {
+    const std::vector<std::uint8_t> key_a(16, 0x11);
+    const std::vector<std::uint8_t> key_b(16, 0x22);
+    const std::vector<std::uint8_t> plaintext(16, 0x33);
+
+    auto alone = block::make_block_cipher("TWOFISH", 16, 16, 16, true);
+    alone->keysetup(key_a.data(), key_a.size());
+    std::vector<std::uint8_t> expected(16);
+    alone->encrypt(plaintext.data(), expected.data());
+
+    // the key setup of the second instance used to replace the key schedule of the first
+    auto first = block::make_block_cipher("TWOFISH", 16, 16, 16, true);
+    auto second = block::make_block_cipher("TWOFISH", 16, 16, 16, true);
+    first->keysetup(key_a.data(), key_a.size());
+    second->keysetup(key_b.data(), key_b.size());
+    std::vector<std::uint8_t> actual(16);
+    first->encrypt(plaintext.data(), actual.data());
+
+    ASSERT_EQ(expected, actual);
+}
+
 TEST(camellia, test_vectors) {
     testsuite::block_test_case("CAMELLIA", 18)();
     testsuite::block_test_case("CAMELLIA", 24)();
@@ -349,3 +376,149 @@ TEST(twine, round_reduction) {
         util.testRoundReducedEncryptDecrypt(8, 10, i);
     }
 }
+
+namespace {
+
+std::vector<value_type> generate(std::unique_ptr<stream> &source, unsigned vectors) {
+    std::vector<value_type> output;
+    for (unsigned i = 0; i < vectors; ++i) {
+        vec_cview view = source->next();
+        output.insert(output.end(), view.begin(), view.end());
+    }
+    return output;
+}
+
+json aes_config(const json &plaintext) {
+    return {{"type", "block"},
+            {"algorithm", "AES"},
+            {"round", 3},
+            {"block_size", 16},
+            {"key_size", 16},
+            {"init_frequency", "3"},
+            {"plaintext", plaintext},
+            {"key", {{"type", "pcg32_stream"}}},
+            {"iv", {{"type", "false_stream"}}}};
+}
+
+} // namespace
+
+TEST(block_stream, round_taps_match_single_rounds) {
+    struct cipher {
+        std::string algorithm;
+        std::size_t block_size;
+        std::size_t key_size;
+        std::vector<std::size_t> taps;
+        bool encryption;
+    };
+    // AES and SPECK tap one encryption, TEA and decryption fall back to a cipher per tap
+    for (const cipher &c : {cipher{"AES", 16, 16, {0, 1, 2, 5, 10}, true},
+                            cipher{"SPECK", 8, 12, {1, 7, 8, 26}, true},
+                            cipher{"SPECK", 6, 9, {3, 22}, true},
+                            cipher{"TEA", 8, 16, {2, 4}, true},
+                            cipher{"AES", 16, 16, {3, 4}, false}}) {
+        json config = aes_config({{"type", "counter"}});
+        config["algorithm"] = c.algorithm;
+        config["block_size"] = c.block_size;
+        config["key_size"] = c.key_size;
+        config["encryption_mode"] = c.encryption;
+        config.erase("round");
+        config["round_taps"] = c.taps;
+
+        const std::size_t tv_size = 4 * c.block_size;
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+        seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+        std::unique_ptr<stream> tapped = make_stream(config, seeder, pipes, tv_size * c.taps.size());
+        const std::vector<value_type> taps = generate(tapped, 8);
+
+        for (std::size_t i = 0; i < c.taps.size(); ++i) {
+            json single = config;
+            single.erase("round_taps");
+            single["round"] = c.taps[i];
+            seed_seq_from<pcg32> single_seeder(seed::create("1fe40505e131963c"));
+            std::unique_ptr<stream> reduced = make_stream(single, single_seeder, pipes, tv_size);
+            const std::vector<value_type> expected = generate(reduced, 8);
+
+            for (std::size_t v = 0; v < 8; ++v) {
+                const auto tap = taps.begin() + std::ptrdiff_t((v * c.taps.size() + i) * tv_size);
+                ASSERT_TRUE(std::equal(tap, tap + std::ptrdiff_t(tv_size),
+                                       expected.begin() + std::ptrdiff_t(v * tv_size)))
+                    << c.algorithm << " round " << c.taps[i];
+            }
+        }
+    }
+}
+
+TEST(block_stream, skip_matches_discarded_vectors) {
+    // the key is reinitialized every 3 vectors
+    for (std::uint64_t count : {1, 2, 3, 5, 100}) {
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+        seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+        seed_seq_from<pcg32> skipped_seeder(seed::create("1fe40505e131963c"));
+        std::unique_ptr<stream> sequential =
+            make_stream(aes_config({{"type", "counter"}}), seeder, pipes, 32);
+        std::unique_ptr<stream> skipped =
+            make_stream(aes_config({{"type", "counter"}}), skipped_seeder, pipes, 32);
+
+        generate(sequential, unsigned(count));
+        skipped->skip(count);
+        ASSERT_EQ(generate(sequential, 7), generate(skipped, 7)) << "count " << count;
+    }
+}
+
+TEST(block_pipeline, matches_block_stream) {
+    for (const json &plaintext : {json{{"type", "counter"}},
+                                 json{{"type", "pcg32_stream"}},
+                                 json{{"type", "random_stream"}, {"bulk", true}}}) {
+        for (const bool encryption : {true, false}) {
+            for (const std::string frequency : {"3", "only_once"}) {
+                json config = aes_config(plaintext);
+                config["encryption_mode"] = encryption;
+                config["init_frequency"] = frequency;
+                json dynamic_config = config;
+                dynamic_config["compile"] = false;
+
+                std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+                seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+                std::unique_ptr<stream> compiled = make_stream(config, seeder, pipes, 64);
+                seed_seq_from<pcg32> dynamic_seeder(seed::create("1fe40505e131963c"));
+                std::unique_ptr<stream> dynamic =
+                    make_stream(dynamic_config, dynamic_seeder, pipes, 64);
+                ASSERT_EQ(nullptr, dynamic_cast<block::block_stream *>(compiled.get()));
+                ASSERT_NE(nullptr, dynamic_cast<block::block_stream *>(dynamic.get()));
+
+                // the streams built after them get the same seeds
+                std::array<std::uint32_t, 2> next_seeds, dynamic_next_seeds;
+                seeder.generate(next_seeds.begin(), next_seeds.end());
+                dynamic_seeder.generate(dynamic_next_seeds.begin(), dynamic_next_seeds.end());
+                ASSERT_EQ(dynamic_next_seeds, next_seeds);
+
+                ASSERT_EQ(generate(dynamic, 8), generate(compiled, 8)) << config.dump();
+                dynamic->skip(5);
+                compiled->skip(5);
+                ASSERT_EQ(generate(dynamic, 8), generate(compiled, 8)) << config.dump();
+                ASSERT_EQ(dynamic->seekable(), compiled->seekable());
+            }
+        }
+    }
+}
+
+TEST(block_pipeline, DISABLED_benchmark) {
+    const unsigned vectors = 1u << 22;
+    for (const bool compile : {false, true}) {
+        json config = aes_config({{"type", "counter"}});
+        config["init_frequency"] = "only_once";
+        config["compile"] = compile;
+        std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+        seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+
+        // single blocks, so the calls between the streams and the cipher dominate
+        std::unique_ptr<stream> source = make_stream(config, seeder, pipes, 16);
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < vectors; ++i)
+            source->next();
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << (compile ? "compiled" : "dynamic") << " AES over counter: "
+                  << elapsed.count() / vectors << " ns per vector" << std::endl;
+    }
+}
@@ -0,0 +1,148 @@
+//
+// Tests of the counter-based prngs
+//
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <eacirc-core/seed.h>
+#include <streams.h>
+#include <streams/prngs/cbrng-prngs/cbrng_interface.h>
+#include <streams/prngs/cbrng-prngs/functions/philox.h>
+#include <streams/prngs/cbrng-prngs/functions/splitmix.h>
+#include <streams/prngs/cbrng-prngs/functions/threefry.h>
+
+namespace {
+    const std::vector<std::uint8_t> zero_key(32, 0);
+    const std::vector<std::uint8_t> ones_key(32, 0xff);
+}
+
+// known answers from the Random123 library (kat_vectors)
+
+TEST(PHILOX, known_answers) {
+    prng::philox4x32 zero(zero_key.data());
+    EXPECT_EQ((prng::philox4x32::counter_type{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}),
+              zero.block({{0, 0, 0, 0}}));
+
+    prng::philox4x32 ones(ones_key.data());
+    EXPECT_EQ((prng::philox4x32::counter_type{{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}),
+              ones.block({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}));
+
+    const std::vector<std::uint8_t> pi_key = {0x22, 0x38, 0x09, 0xa4, 0xd0, 0x31, 0x9f, 0x29};
+    prng::philox4x32 pi(pi_key.data());
+    EXPECT_EQ((prng::philox4x32::counter_type{{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}),
+              pi.block({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}));
+}
+
+TEST(THREEFRY, known_answers) {
+    prng::threefry4x64 zero(zero_key.data());
+    EXPECT_EQ((prng::threefry4x64::counter_type{
+                      {0x09218ebde6c85537, 0x55941f5266d86105, 0x4bd25e16282434dc, 0xee29ec846bd2e40b}}),
+              zero.block({{0, 0, 0, 0}}));
+}
+
+TEST(SPLITMIX, known_answers) {
+    prng::splitmix64 zero(zero_key.data());
+    EXPECT_EQ(0xe220a8397b1dcdafu, zero.block(0));
+}
+
+template <typename Generator>
+void check_simd_kernel(const Generator &generator) {
+    // odd offset and count cover the carry to the high counter word and the scalar tail
+    const std::uint64_t first = 0xfffffffbu;
+    const std::size_t count = 37;
+    std::vector<std::uint8_t> simd(count * Generator::block_size);
+    std::vector<std::uint8_t> scalar(count * Generator::block_size);
+
+    generator.generate(first, count, simd.data(), true);
+    generator.generate(first, count, scalar.data(), false);
+    ASSERT_EQ(scalar, simd);
+}
+
+TEST(PHILOX, simd_kernel) {
+    for (unsigned rounds : {1, 7, 10, 16}) {
+        check_simd_kernel(prng::philox4x32(ones_key.data(), rounds));
+    }
+}
+
+TEST(THREEFRY, simd_kernel) {
+    for (unsigned rounds : {1, 5, 13, 20, 72}) {
+        check_simd_kernel(prng::threefry4x64(ones_key.data(), rounds));
+    }
+}
+
+TEST(CBRNG, seek) {
+    std::unique_ptr<stream> key_stream = std::make_unique<false_stream>(prng::philox4x32::key_size);
+    prng::cbrng_interface<prng::philox4x32> sequential(key_stream, false);
+    key_stream = std::make_unique<false_stream>(prng::philox4x32::key_size);
+    prng::cbrng_interface<prng::philox4x32> random_access(key_stream, false);
+
+    // vectors of 40 bytes take 3 blocks each
+    std::vector<std::uint8_t> expected(40);
+    std::vector<std::uint8_t> actual(40);
+    for (unsigned k = 0; k < 10; k++) {
+        sequential.generate_bits(expected.data(), expected.size());
+    }
+    random_access.seek(9 * 3);
+    random_access.generate_bits(actual.data(), actual.size());
+    ASSERT_EQ(expected, actual);
+
+    random_access.seek(0);
+    random_access.jump(9 * 3);
+    random_access.generate_bits(actual.data(), actual.size());
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(CBRNG, invalid_rounds) {
+    EXPECT_THROW(prng::philox4x32(zero_key.data(), 0), std::runtime_error);
+    EXPECT_THROW(prng::threefry4x64(zero_key.data(), 73), std::runtime_error);
+}
+
+TEST(CBRNG, prng_stream_offset) {
+    seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+    json config = {{"type", "prng"},
+                   {"algorithm", "cbrng-splitmix64"},
+                   {"seeder", {{"type", "false_stream"}}},
+                   {"offset", 1}};
+
+    auto prng_stream = make_stream(config, seeder, pipes, 8);
+    vec_cview data = prng_stream->next();
+
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < 8; i++) {
+        word |= std::uint64_t(data.data()[i]) << (8 * i);
+    }
+    ASSERT_EQ(prng::splitmix64(zero_key.data()).block(1), word);
+}
+
+TEST(CBRNG, prng_stream_skip) {
+    // odd vector sizes leave unused bytes of the last block or word of every vector
+    for (const std::string algorithm : {"cbrng-philox4x32", "cbrng-threefry4x64", "std_lcg",
+                                        "std_mersenne_twister", "std_subtract_with_carry"}) {
+        for (bool reseed : {false, true}) {
+            const json config = {{"type", "prng"},
+                                 {"algorithm", algorithm},
+                                 {"seeder", {{"type", "pcg32_stream"}}},
+                                 {"reseed_for_each_test_vector", reseed}};
+
+            for (std::uint64_t count : {1, 2, 1000}) {
+                std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+                seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+                seed_seq_from<pcg32> skipped_seeder(seed::create("1fe40505e131963c"));
+                auto sequential = make_stream(config, seeder, pipes, 13);
+                auto skipped = make_stream(config, skipped_seeder, pipes, 13);
+
+                for (std::uint64_t i = 0; i < count; i++)
+                    sequential->next();
+                skipped->skip(count);
+
+                for (int i = 0; i < 3; i++) {
+                    vec_cview expected = sequential->next();
+                    vec_cview actual = skipped->next();
+                    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin()))
+                        << algorithm << " reseed " << reseed << " count " << count;
+                }
+            }
+        }
+    }
+}
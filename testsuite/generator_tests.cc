@@ -0,0 +1,384 @@
+#include "campaign.h"
+#include "generator.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <glob.h>
+#include <iterator>
+#include <unistd.h>
+
+namespace {
+
+std::vector<value_type> read_file(const std::string &name) {
+    std::ifstream file(name, std::ios::binary);
+    std::vector<value_type> content((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+    std::remove(name.c_str());
+    return content;
+}
+
+std::vector<value_type> counter_vectors(std::size_t count, std::size_t size) {
+    std::vector<value_type> vectors(count * size);
+    for (std::size_t i = 0; i < count; ++i)
+        vectors[i * size] = value_type(i + 1); // the counter starts at one
+    return vectors;
+}
+
+} // namespace
+
+TEST(generator, sinks_share_pipes) {
+    const json config = {
+        {"seed", "1fe40505e131963c"},
+        {"tv_size", 16},
+        {"tv_count", 10},
+        {"sinks",
+         {{{"file_name", "sink_plaintext.bin"},
+           {"tv_count", 3},
+           {"stream",
+            {{"type", "pipe_in_stream"},
+             {"id", "plaintext"},
+             {"ordered", true},
+             {"capacity", 2},
+             {"source", {{"type", "counter"}}}}}},
+          {{"file_name", "sink_copy.bin"},
+           {"stream", {{"type", "pipe_out_stream"}, {"id", "plaintext"}}}}}}};
+
+    generator(config).generate();
+
+    // the finished sink does not hold back the pipe of capacity 2
+    EXPECT_EQ(counter_vectors(3, 16), read_file("sink_plaintext.bin"));
+    EXPECT_EQ(counter_vectors(10, 16), read_file("sink_copy.bin"));
+}
+
+TEST(generator, sinks_exclude_single_stream) {
+    json config = {{"seed", "1fe40505e131963c"},
+                   {"tv_size", 16},
+                   {"tv_count", 10},
+                   {"stream", {{"type", "counter"}}},
+                   {"sinks", json::array()}};
+    EXPECT_THROW(generator{config}, std::runtime_error);
+}
+
+TEST(campaign, sweep_matches_single_runs) {
+    const json base = {{"seed", "1fe40505e131963c"},
+                       {"tv_size", 32},
+                       {"tv_count", 50},
+                       {"stream",
+                        {{"type", "block"},
+                         {"algorithm", "AES"},
+                         {"round", 10},
+                         {"block_size", 16},
+                         {"key_size", 16},
+                         {"init_frequency", "only_once"},
+                         {"plaintext", {{"type", "counter"}}},
+                         {"key", {{"type", "pcg32_stream"}}},
+                         {"iv", {{"type", "false_stream"}}}}}};
+    const json config = {
+        {"sweep", {{"template", base}, {"parameters", {{"round", {1, 2, 3, -1}}}}}},
+        {"threads", 3},
+        {"manifest", "campaign_test_manifest.json"}};
+
+    campaign c(config, ".");
+    ASSERT_EQ(4u, c.size());
+    EXPECT_THROW(c.run(), std::runtime_error); // the configuration with round -1
+
+    std::ifstream manifest_file("campaign_test_manifest.json");
+    const json manifest = json::parse(manifest_file);
+    std::remove("campaign_test_manifest.json");
+    EXPECT_EQ(1u, std::size_t(manifest.at("failed")));
+    EXPECT_EQ(4u, manifest.at("configs").size());
+
+    for (int round : {1, 2, 3}) {
+        const json &result = manifest.at("configs").at(std::size_t(round - 1));
+        ASSERT_EQ(1u, result.at("outputs").size());
+        const std::string name = result.at("outputs")[0].at("file");
+        EXPECT_EQ(32u * 50, std::size_t(result.at("outputs")[0].at("size")));
+        const std::vector<value_type> swept = read_file(name);
+
+        json single = base;
+        single["stream"]["round"] = round;
+        generator(single).generate();
+        EXPECT_EQ(read_file(name), swept) << name;
+    }
+}
+
+TEST(campaign, single_thread_runs_configs_one_at_a_time) {
+    const json base = {{"seed", "1fe40505e131963c"},
+                       {"tv_size", 16},
+                       {"tv_count", 10},
+                       {"stream", {{"type", "pcg32_stream"}, {"algorithm", "PCG32"}}}};
+    const json config = {
+        {"sweep", {{"template", base}, {"parameters", {{"round", {1, 2, 3}}}}}},
+        {"threads", 1},
+        {"manifest", "campaign_single_manifest.json"}};
+    campaign(config, ".").run();
+
+    std::ifstream manifest_file("campaign_single_manifest.json");
+    const json manifest = json::parse(manifest_file);
+    std::remove("campaign_single_manifest.json");
+    EXPECT_EQ(1u, std::size_t(manifest.at("threads")));
+    ASSERT_EQ(3u, manifest.at("configs").size());
+    for (const json &result : manifest.at("configs")) {
+        ASSERT_EQ(1u, result.at("outputs").size());
+        read_file(result.at("outputs")[0].at("file"));
+    }
+}
+
+TEST(campaign, rejects_configs_writing_the_same_file) {
+    const json base = {{"seed", "1fe40505e131963c"},
+                       {"tv_size", 16},
+                       {"tv_count", 10},
+                       {"stream", {{"type", "pcg32_stream"}, {"algorithm", "PCG32"}}}};
+    // the default file name has no place for the swept parameter
+    const json sweep = {{"sweep", {{"template", base}, {"parameters", {{"unused", {1, 2}}}}}}};
+    EXPECT_THROW(campaign(sweep, "."), std::runtime_error);
+
+    const json rounds = {{"sweep", {{"template", base}, {"parameters", {{"round", {1, 2}}}}}}};
+    EXPECT_EQ(2u, campaign(rounds, ".").size());
+}
+
+TEST(generator, ranges_concatenate_to_whole_run) {
+    const json block = {{"type", "block"},
+                        {"algorithm", "AES"},
+                        {"round", 2},
+                        {"block_size", 16},
+                        {"key_size", 16},
+                        {"init_frequency", "4"},
+                        {"plaintext", {{"type", "counter"}}},
+                        {"key", {{"type", "pcg32_stream"}, {"bulk", true}}},
+                        {"iv", {{"type", "false_stream"}}}};
+    // pipes keep the skipped vectors generated
+    const json piped = R"({
+        "type": "xor_stream",
+        "source": {
+            "type": "tuple_stream",
+            "sources": [
+                {"type": "pipe_in_stream", "id": "p", "output_size": 32,
+                 "source": {"type": "pcg32_stream"}},
+                {"type": "pipe_out_stream", "id": "p", "output_size": 32}
+            ]
+        }
+    })"_json;
+
+    for (const json &stream : {block, piped}) {
+        json config = {{"seed", "1fe40505e131963c"},
+                       {"tv_size", 32},
+                       {"tv_count", 20},
+                       {"file_name", "range_test.bin"},
+                       {"stream", stream}};
+
+        generator(config).generate();
+        const std::vector<value_type> whole = read_file("range_test.bin");
+
+        // the last range reaches over tv_count
+        std::vector<value_type> slices;
+        for (const auto &range :
+             {std::make_pair(0u, 3u), std::make_pair(3u, 8u), std::make_pair(11u, 100u)}) {
+            generator(config).generate(range.first, range.second);
+            const std::vector<value_type> slice = read_file("range_test.bin");
+            slices.insert(slices.end(), slice.begin(), slice.end());
+        }
+        EXPECT_EQ(whole, slices) << stream.dump();
+    }
+}
+
+TEST(generator, checkpoint_resumes_and_extends) {
+    const json block = {{"seed", "1fe40505e131963c"},
+                        {"tv_size", 32},
+                        {"file_name", "checkpoint_test.bin"},
+                        {"stream",
+                         {{"type", "block"},
+                          {"algorithm", "AES"},
+                          {"round", 2},
+                          {"block_size", 16},
+                          {"key_size", 16},
+                          {"init_frequency", "4"},
+                          {"plaintext", {{"type", "counter"}}},
+                          {"key", {{"type", "pcg32_stream"}, {"bulk", true}}},
+                          {"iv", {{"type", "false_stream"}}}}}};
+    const json tuple = {{"seed", "1fe40505e131963c"},
+                        {"tv_size", 16},
+                        {"file_name", "checkpoint_test.bin"},
+                        {"stream",
+                         {{"type", "tuple_stream"},
+                          {"sources",
+                           {{{"type", "pcg32_stream"}, {"bulk", true}, {"output_size", 5}},
+                            {{"type", "counter"}, {"output_size", 11}}}}}}};
+
+    for (json config : {block, tuple}) {
+        config["tv_count"] = 25;
+        generator(config).generate();
+        const std::vector<value_type> fresh = read_file("checkpoint_test.bin");
+        std::remove("checkpoint_copy.bin");
+
+        config["checkpoint"] = "checkpoint_test.json";
+        config["checkpoint_interval"] = 4;
+        config["tv_count"] = 10;
+        generator(config).generate();
+
+        // an interrupted run wrote vectors after its last checkpoint
+        std::ifstream checkpoint_file("checkpoint_test.json");
+        json checkpoint = json::parse(checkpoint_file);
+        checkpoint_file.close();
+        EXPECT_EQ(10u, std::uint64_t(checkpoint.at("sinks")[0].at("written")));
+        checkpoint["sinks"][0]["written"] = 8;
+        std::ofstream("checkpoint_test.json") << checkpoint.dump();
+
+        config["tv_count"] = 25;
+        generator(config).generate();
+        EXPECT_EQ(fresh, read_file("checkpoint_test.bin")) << config.dump();
+        std::remove("checkpoint_copy.bin");
+
+        config["seed"] = "2fe40505e131963c";
+        EXPECT_THROW(generator(config).generate(), std::runtime_error);
+        std::remove("checkpoint_test.json");
+    }
+}
+
+TEST(generator, checkpoint_resumes_streams_which_cannot_jump) {
+    const json compatible_bytes = {{"type", "pcg32_stream"}};
+    const json stream_cipher = {{"type", "stream_cipher"},
+                                {"algorithm", "Salsa20"},
+                                {"round", 12},
+                                {"block_size", 64},
+                                {"plaintext", {{"type", "counter"}}},
+                                {"key_size", 32},
+                                {"key", {{"type", "pcg32_stream"}}},
+                                {"iv_size", 8},
+                                {"iv", {{"type", "false_stream"}}}};
+    const json piped = {{"type", "tuple_stream"},
+                        {"sources",
+                         {{{"type", "pipe_in_stream"},
+                           {"id", "p"},
+                           {"output_size", 8},
+                           {"source", {{"type", "pcg32_stream"}}}},
+                          {{"type", "pipe_out_stream"}, {"id", "p"}, {"output_size", 8}}}}};
+
+    // with the sizes of their vectors
+    for (const auto &stream : std::vector<std::pair<json, std::size_t>>{
+             {compatible_bytes, 16}, {stream_cipher, 64}, {piped, 16}}) {
+        json config = {{"seed", "1fe40505e131963c"},
+                       {"tv_size", stream.second},
+                       {"tv_count", 12},
+                       {"file_name", "checkpoint_unseekable.bin"},
+                       {"stream", stream.first}};
+        generator(config).generate();
+        const std::vector<value_type> fresh = read_file("checkpoint_unseekable.bin");
+
+        config["checkpoint"] = "checkpoint_unseekable.json";
+        config["tv_count"] = 5;
+        generator(config).generate();
+        config["tv_count"] = 12;
+        generator(config).generate();
+        EXPECT_EQ(fresh, read_file("checkpoint_unseekable.bin")) << stream.first.dump();
+        std::remove("checkpoint_unseekable.json");
+    }
+}
+
+TEST(generator, cache_serves_and_extends_files) {
+    json config = {{"seed", "1fe40505e131963c"},
+                   {"tv_size", 32},
+                   {"tv_count", 25},
+                   {"file_name", "cache_test.bin"},
+                   {"stream",
+                    {{"type", "block"},
+                     {"algorithm", "AES"},
+                     {"round", 2},
+                     {"block_size", 16},
+                     {"key_size", 16},
+                     {"init_frequency", "4"},
+                     {"plaintext", {{"type", "counter"}}},
+                     {"key", {{"type", "pcg32_stream"}, {"bulk", true}}},
+                     {"iv", {{"type", "false_stream"}}}}}};
+    generator(config).generate();
+    const std::vector<value_type> fresh = read_file("cache_test.bin");
+
+    config["cache"] = "cache_test_dir";
+    config["tv_count"] = 10;
+    generator miss(config);
+    miss.generate();
+    EXPECT_EQ(1u, miss.cache_statistics().misses);
+    EXPECT_EQ(std::vector<value_type>(fresh.begin(), fresh.begin() + 320),
+              read_file("cache_test.bin"));
+
+    config["tv_count"] = 25;
+    config["file_name"] = "cache_test_other.bin";
+    generator extended(config);
+    extended.generate();
+    EXPECT_EQ(1u, extended.cache_statistics().extended);
+    EXPECT_EQ(320u, extended.cache_statistics().reused_bytes);
+    EXPECT_EQ(480u, extended.cache_statistics().generated_bytes);
+    EXPECT_EQ(fresh, read_file("cache_test_other.bin"));
+
+    config["tv_count"] = 7;
+    generator hit(config);
+    hit.generate();
+    EXPECT_EQ(1u, hit.cache_statistics().hits);
+    EXPECT_EQ(0u, hit.cache_statistics().generated_bytes);
+    EXPECT_EQ(std::vector<value_type>(fresh.begin(), fresh.begin() + 224),
+              read_file("cache_test_other.bin"));
+
+    // the copied prefix is checked, a damaged block is generated again
+    {
+        glob_t data;
+        ASSERT_EQ(0, glob("cache_test_dir/*.bin", 0, nullptr, &data));
+        std::fstream file(data.gl_pathv[0], std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(100);
+        file.put(char(fresh[100] ^ 1));
+        globfree(&data);
+    }
+    config["tv_count"] = 10;
+    generator damaged(config);
+    damaged.generate();
+    EXPECT_EQ(1u, damaged.cache_statistics().misses);
+    EXPECT_EQ(std::vector<value_type>(fresh.begin(), fresh.begin() + 320),
+              read_file("cache_test_other.bin"));
+
+    glob_t entries;
+    ASSERT_EQ(0, glob("cache_test_dir/*", 0, nullptr, &entries));
+    EXPECT_EQ(2u, entries.gl_pathc); // data and description of one entry
+    for (std::size_t i = 0; i < entries.gl_pathc; ++i)
+        std::remove(entries.gl_pathv[i]);
+    globfree(&entries);
+    rmdir("cache_test_dir");
+}
+
+TEST(generator, writes_do_not_change_cached_data) {
+    json config = {{"seed", "1fe40505e131963c"},
+                   {"tv_size", 32},
+                   {"tv_count", 10},
+                   {"file_name", "cache_link_test.bin"},
+                   {"stream", {{"type", "pcg32_stream"}, {"bulk", true}}}};
+    json cached = config;
+    cached["cache"] = "cache_link_test_dir";
+    generator(cached).generate(); // the file is linked to the new entry
+    const std::vector<value_type> original = read_file("cache_link_test.bin");
+
+    // a new file of the same name
+    json other_seed = config;
+    other_seed["seed"] = "0000000000000001";
+    generator(other_seed).generate();
+
+    // resumed, the written vectors stay and the rest is appended
+    json resumed = config;
+    resumed["checkpoint"] = "cache_link_test_checkpoint.json";
+    generator(resumed).generate();
+    generator(cached).generate();
+    resumed["tv_count"] = 20;
+    generator(resumed).generate();
+    EXPECT_EQ(640u, read_file("cache_link_test.bin").size());
+
+    generator hit(cached);
+    hit.generate();
+    EXPECT_EQ(1u, hit.cache_statistics().hits);
+    EXPECT_EQ(original, read_file("cache_link_test.bin"));
+
+    std::remove("cache_link_test.bin");
+    std::remove("cache_link_test_checkpoint.json");
+    glob_t entries;
+    ASSERT_EQ(0, glob("cache_link_test_dir/*", 0, nullptr, &entries));
+    for (std::size_t i = 0; i < entries.gl_pathc; ++i)
+        std::remove(entries.gl_pathv[i]);
+    globfree(&entries);
+    rmdir("cache_link_test_dir");
+}
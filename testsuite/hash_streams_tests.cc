@@ -1,8 +1,12 @@
 #include "stream.h"
 #include "streams.h"
+#include <array>
+#include <chrono>
 #include <eacirc-core/json.h>
+#include <eacirc-core/seed.h>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <streams/hash/hash_factory.h>
 #include <streams/hash/sha3/sha3_interface.h>
 
@@ -137,3 +141,111 @@ TEST(tiger, test_vectors) {
 TEST(whirlpool, test_vectors) {
     testsuite::hash_test_case("Whirlpool", 10)();
 }
+
+TEST(hash_stream, round_taps_match_single_rounds) {
+    const std::vector<std::size_t> rounds = {1, 2, 4};
+    json config = {{"type", "hash"},
+                   {"algorithm", "SHA2"},
+                   {"round_taps", rounds},
+                   {"hash_size", 32},
+                   {"source", {{"type", "pcg32_stream"}}}};
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+
+    seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+    std::unique_ptr<stream> tapped = make_stream(config, seeder, pipes, 64 * rounds.size());
+    std::vector<std::vector<value_type>> taps;
+    for (unsigned i = 0; i < 8; ++i) {
+        vec_cview view = tapped->next();
+        taps.emplace_back(view.begin(), view.end());
+    }
+
+    config.erase("round_taps");
+    for (std::size_t tap = 0; tap < rounds.size(); ++tap) {
+        config["round"] = rounds[tap];
+        seed_seq_from<pcg32> single_seeder(seed::create("1fe40505e131963c"));
+        std::unique_ptr<stream> single = make_stream(config, single_seeder, pipes, 64);
+        for (unsigned i = 0; i < 8; ++i) {
+            vec_cview expected = single->next();
+            ASSERT_TRUE(std::equal(expected.begin(), expected.end(), taps[i].begin() + std::ptrdiff_t(tap * 64)))
+                << "round " << rounds[tap];
+        }
+    }
+}
+
+namespace {
+
+std::vector<value_type> generate(std::unique_ptr<stream> &source, unsigned vectors) {
+    std::vector<value_type> output;
+    for (unsigned i = 0; i < vectors; ++i) {
+        vec_cview view = source->next();
+        output.insert(output.end(), view.begin(), view.end());
+    }
+    return output;
+}
+
+json hash_config(const std::string &algorithm, const json &source) {
+    return {{"type", "hash"},
+            {"algorithm", algorithm},
+            {"round", 4},
+            {"hash_size", 32},
+            {"input_size", 24},
+            {"source", source}};
+}
+
+} // namespace
+
+TEST(hash_pipeline, matches_hash_stream) {
+    for (const std::string algorithm : {"Keccak", "SHA2"}) {
+        for (const json &source : {json{{"type", "counter"}},
+                                  json{{"type", "pcg32_stream"}},
+                                  json{{"type", "random_stream"}, {"bulk", true}}}) {
+            const json config = hash_config(algorithm, source);
+            json dynamic_config = config;
+            dynamic_config["compile"] = false;
+
+            std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+            seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+            std::unique_ptr<stream> compiled = make_stream(config, seeder, pipes, 64);
+            seed_seq_from<pcg32> dynamic_seeder(seed::create("1fe40505e131963c"));
+            std::unique_ptr<stream> dynamic =
+                make_stream(dynamic_config, dynamic_seeder, pipes, 64);
+            ASSERT_EQ(nullptr, dynamic_cast<hash::hash_stream *>(compiled.get()));
+            ASSERT_NE(nullptr, dynamic_cast<hash::hash_stream *>(dynamic.get()));
+
+            // the streams built after them get the same seeds
+            std::array<std::uint32_t, 2> next_seeds, dynamic_next_seeds;
+            seeder.generate(next_seeds.begin(), next_seeds.end());
+            dynamic_seeder.generate(dynamic_next_seeds.begin(), dynamic_next_seeds.end());
+            ASSERT_EQ(dynamic_next_seeds, next_seeds);
+
+            ASSERT_EQ(generate(dynamic, 8), generate(compiled, 8)) << config.dump();
+            dynamic->skip(5);
+            compiled->skip(5);
+            ASSERT_EQ(generate(dynamic, 8), generate(compiled, 8)) << config.dump();
+            ASSERT_EQ(dynamic->seekable(), compiled->seekable());
+        }
+    }
+}
+
+TEST(hash_pipeline, DISABLED_benchmark) {
+    const unsigned vectors = 1u << 20;
+    for (const std::string algorithm : {"Keccak", "SHA2"}) {
+        for (const bool compile : {false, true}) {
+            json config = hash_config(algorithm, {{"type", "pcg32_stream"}});
+            config["compile"] = compile;
+            std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> pipes;
+            seed_seq_from<pcg32> seeder(seed::create("1fe40505e131963c"));
+
+            // single hashes, so the calls between the stream and the hash function dominate
+            std::unique_ptr<stream> source = make_stream(config, seeder, pipes, 32);
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < vectors; ++i)
+                source->next();
+            const std::chrono::duration<double, std::nano> elapsed =
+                std::chrono::steady_clock::now() - start;
+            std::cout << (compile ? "compiled " : "dynamic ") << algorithm
+                      << " over pcg32_stream: " << elapsed.count() / vectors << " ns per vector"
+                      << std::endl;
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include <memory>
 #include <eacirc-core/seed.h>
 #include <streams/prngs/std-prngs/functions/lcg_generator.h>
+#include <streams/prngs/std-prngs/mersenne_twister.h>
 
 
 TEST(STD_LCG, basic_test) {
@@ -19,4 +20,43 @@ TEST(STD_LCG, basic_test) {
         ASSERT_EQ((k * 48271UL) % 2147483647UL, data[0]);
         ASSERT_EQ((k * 48271UL * 48271UL) % 2147483647UL, data[1]);
     }
-}
\ No newline at end of file
+}
+
+TEST(STD_LCG, jump) {
+    for (std::uint64_t n : {1, 1000, 123456}) {
+        auto jumped = std::make_unique<prng::lcg_generator>(std::make_unique<counter>(4), false);
+        auto sequential = std::make_unique<prng::lcg_generator>(std::make_unique<counter>(4), false);
+
+        std::vector<uint32_t> data(n);
+        sequential->generate_bits(reinterpret_cast<uint8_t *>(data.data()), data.size() * 4);
+        jumped->jump(n);
+
+        std::vector<uint32_t> expected(16);
+        std::vector<uint32_t> actual(16);
+        sequential->generate_bits(reinterpret_cast<uint8_t *>(expected.data()), expected.size() * 4);
+        jumped->generate_bits(reinterpret_cast<uint8_t *>(actual.data()), actual.size() * 4);
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(STD_MERSENNE_TWISTER, same_as_std) {
+    prng::mersenne_twister generator(42);
+    std::mt19937 reference(42);
+
+    for (auto k = 0; k < 10000; k++) {
+        ASSERT_EQ(reference(), generator());
+    }
+}
+
+TEST(STD_MERSENNE_TWISTER, jump) {
+    for (std::uint64_t n : {1, 623, 624, 100000, 3000001}) {
+        prng::mersenne_twister jumped(42);
+        std::mt19937 reference(42);
+
+        reference.discard(n);
+        jumped.jump(n);
+        for (auto k = 0; k < 1000; k++) {
+            ASSERT_EQ(reference(), jumped()) << "n = " << n;
+        }
+    }
+}
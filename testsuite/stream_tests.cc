@@ -2,11 +2,23 @@
 // Created by mhajas on 5/4/17.
 //
 
+#include "bit_transpose.h"
+#include "combinators.h"
+#include "fd_writer.h"
 #include "stream.h"
 #include "streams.h"
+#include "work_stealing_pool.h"
 #include "gtest/gtest.h"
 #include <eacirc-core/seed.h>
 #include <testsuite/test_utils/test_case.h>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <glob.h>
+#include <numeric>
+#include <thread>
+#include <unistd.h>
 
 const static int testing_size = 1536;
 
@@ -46,6 +58,153 @@ TEST(counter_stream, basic_test) {
     }
 }
 
+TEST(counter_stream, word_wise_options) {
+    const json little = {{"type", "counter"}, {"stride", 0x1234567}, {"width", 11}};
+    json big = little;
+    big["endianness"] = "big";
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    auto little_stream = make_stream(little, seeder, map, 13);
+    auto big_stream = make_stream(big, seeder, map, 13);
+
+    // reference value in 11 bytes
+    std::vector<value_type> value(11);
+    for (unsigned i = 0; i < 300; ++i) {
+        unsigned carry = 0x1234567;
+        for (auto &byte : value) {
+            carry += byte;
+            byte = value_type(carry);
+            carry >>= 8;
+        }
+
+        std::vector<value_type> expected_little(value);
+        expected_little.resize(13);
+        std::vector<value_type> expected_big(value.rbegin(), value.rend());
+        expected_big.resize(13);
+
+        ASSERT_EQ(expected_little, little_stream->next().copy_to_vector());
+        ASSERT_EQ(expected_big, big_stream->next().copy_to_vector());
+    }
+}
+
+TEST(counter_stream, wraps_and_seeks) {
+    const json config = {{"type", "counter"}, {"stride", 0xFFFFFFFFFFFFFFFFull}};
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    auto sequential = make_stream(config, seeder, map, 9);
+
+    std::vector<std::vector<value_type>> expected;
+    for (unsigned i = 0; i < 600; ++i)
+        expected.push_back(sequential->next().copy_to_vector());
+
+    for (const std::uint64_t offset : {0, 1, 255, 256, 257, 511, 599}) {
+        json shard_config = config;
+        shard_config["offset"] = offset;
+        auto shard = make_stream(shard_config, seeder, map, 9);
+        ASSERT_EQ(expected[offset], shard->next().copy_to_vector()) << offset;
+    }
+
+    // batches are the same vectors
+    json batch_config = config;
+    auto batched = make_stream(batch_config, seeder, map, 9);
+    std::vector<value_type> batch(600 * 9);
+    batched->next_batch(batch.data(), 600);
+    for (unsigned i = 0; i < 600; ++i)
+        ASSERT_TRUE(std::equal(expected[i].begin(), expected[i].end(), batch.begin() + 9 * i));
+}
+
+TEST(counter_stream, default_is_bytewise) {
+    auto stream = std::make_unique<counter>(3);
+    std::vector<value_type> expected(3, 0);
+    for (unsigned i = 0; i < (1u << 24) + 5; ++i) {
+        for (auto &byte : expected)
+            if (++byte != 0)
+                break;
+        vec_cview actual = stream->next();
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin())) << i;
+    }
+}
+
+TEST(rng_streams, compatible_mode) {
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    auto stream = std::make_unique<pcg32_stream>(seeder1, 13);
+    pcg32 rng(seeder2);
+
+    for (unsigned i = 0; i < 16; ++i) {
+        for (auto value : stream->next()) {
+            ASSERT_EQ(std::uniform_int_distribution<std::uint8_t>()(rng), value);
+        }
+    }
+}
+
+TEST(rng_streams, bulk_mode) {
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    // odd size, the unused bytes of one output continue in the next vector
+    auto stream = std::make_unique<pcg32_stream>(seeder1, 7, true);
+    pcg32 rng(seeder2);
+
+    std::vector<value_type> expected;
+    std::vector<value_type> actual;
+    for (unsigned i = 0; i < 16; ++i) {
+        vec_cview view = stream->next();
+        actual.insert(actual.end(), view.begin(), view.end());
+    }
+    while (expected.size() < actual.size()) {
+        std::uint32_t value = rng();
+        for (unsigned j = 0; j < 4; ++j) {
+            expected.push_back(value_type(value >> (8 * j)));
+        }
+    }
+    expected.resize(actual.size());
+
+    ASSERT_EQ(expected, actual);
+}
+
+TEST(rng_streams, pcg32x8_lanes) {
+    std::array<std::uint64_t, pcg32x8::lanes> states;
+    std::array<std::uint64_t, pcg32x8::lanes> sequences;
+    std::vector<pcg32> reference;
+    for (std::size_t i = 0; i < pcg32x8::lanes; ++i) {
+        states[i] = 0x853c49e6748fea9bULL * (i + 1);
+        sequences[i] = 0xda3e39cb94b95bdbULL + i;
+        reference.emplace_back(states[i], sequences[i]);
+    }
+
+    pcg32x8 simd_rng(states, sequences);
+    pcg32x8 scalar_rng(states, sequences);
+    std::vector<value_type> simd_out(pcg32x8::block_size * 33);
+    std::vector<value_type> scalar_out(simd_out.size());
+    simd_rng.generate_blocks(simd_out.data(), 33, true);
+    scalar_rng.generate_blocks(scalar_out.data(), 33, false);
+
+    ASSERT_EQ(scalar_out, simd_out);
+    for (std::size_t i = 0; i < scalar_out.size(); i += 4) {
+        std::uint32_t value = reference[(i / 4) % pcg32x8::lanes]();
+        ASSERT_EQ(value, std::uint32_t(scalar_out[i]) | std::uint32_t(scalar_out[i + 1]) << 8 |
+                             std::uint32_t(scalar_out[i + 2]) << 16 |
+                             std::uint32_t(scalar_out[i + 3]) << 24);
+    }
+}
+
+TEST(rng_streams, pcg32x8_stream_is_continuous) {
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    auto odd = std::make_unique<pcg32x8_stream>(seeder1, 5);
+    auto whole = std::make_unique<pcg32x8_stream>(seeder2, 5 * 64);
+
+    std::vector<value_type> concatenated;
+    for (unsigned i = 0; i < 64; ++i) {
+        vec_cview view = odd->next();
+        concatenated.insert(concatenated.end(), view.begin(), view.end());
+    }
+
+    ASSERT_EQ(whole->next().copy_to_vector(), concatenated);
+}
+
 TEST(sac_streams, basic_test) {
     seed_seq_from<pcg32> seeder(testsuite::seed1);
     std::unique_ptr<sac_stream> stream = std::make_unique<sac_stream>(seeder, 16);
@@ -109,6 +268,129 @@ TEST(sac_streams, fixed_position) {
     }
 }
 
+TEST(distribution_streams, bernoulli_bit_parallel) {
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+
+    for (double p : {0.0, 0.25, 0.49, 1.0}) {
+        const json json_config = {{"p", p}, {"sampler", "bit_parallel"}};
+        auto stream = std::make_unique<bernoulli_distribution_stream>(json_config, seeder, 1000);
+
+        std::size_t ones = 0;
+        const std::size_t bits = 1000 * 8 * 128;
+        for (unsigned i = 0; i < 128; ++i) {
+            for (auto value : stream->next()) {
+                for (unsigned j = 0; j < 8; ++j) {
+                    ones += (value >> j) & 1;
+                }
+            }
+        }
+        // 6 standard deviations of the binomial distribution
+        ASSERT_NEAR(p, double(ones) / bits, 6 * std::sqrt(0.25 / bits));
+        if (p == 0.0 || p == 1.0) {
+            ASSERT_EQ(p * bits, double(ones));
+        }
+    }
+}
+
+TEST(distribution_streams, unknown_sampler) {
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    const json json_config = {{"p", 0.5}, {"sampler", "table"}};
+
+    EXPECT_THROW(std::make_unique<bernoulli_distribution_stream>(json_config, seeder, 16),
+                 std::runtime_error);
+}
+
+TEST(distribution_streams, binomial_table) {
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    const json json_config = {{"max_value", 40}, {"p", 0.3}, {"sampler", "table"}};
+    auto stream = std::make_unique<binomial_distribution_stream>(json_config, seeder, 4096);
+
+    const auto weights = binomial_distribution_stream::binomial_weights(40, 0.3);
+    sampler::byte_alias_table table(weights);
+    for (unsigned k = 0; k < 256; ++k) {
+        ASSERT_NEAR(weights[k], table.probability(std::uint8_t(k)), std::ldexp(1.0, -25));
+    }
+
+    double sum = 0;
+    for (unsigned i = 0; i < 64; ++i) {
+        for (auto value : stream->next()) {
+            ASSERT_LE(value, 40);
+            sum += value;
+        }
+    }
+    ASSERT_NEAR(12.0, sum / (64 * 4096), 0.05);
+}
+
+namespace {
+
+template <typename Stream>
+double total_variation(const json &config, const std::array<double, 256> &weights) {
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    auto stream = std::make_unique<Stream>(config, seeder, 1 << 16);
+
+    std::array<double, 256> histogram;
+    histogram.fill(0.0);
+    const unsigned vectors = 16;
+    for (unsigned i = 0; i < vectors; ++i) {
+        for (auto value : stream->next()) {
+            histogram[value] += 1.0 / (vectors << 16);
+        }
+    }
+
+    const double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double distance = 0.0;
+    for (unsigned k = 0; k < 256; ++k) {
+        distance += std::abs(histogram[k] - weights[k] / sum) / 2;
+    }
+    return distance;
+}
+
+template <typename Stream>
+void check_table_sampler(json config, const std::array<double, 256> &weights) {
+    // the table represents the weights up to 2^-25 per value
+    const double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    sampler::byte_alias_table table(weights);
+    for (unsigned k = 0; k < 256; ++k) {
+        ASSERT_NEAR(weights[k] / sum, table.probability(std::uint8_t(k)), std::ldexp(1.0, -25));
+    }
+
+    // 2^20 samples of a 256 valued distribution are within total variation distance 0.01 of it
+    // with overwhelming probability; the std sampler checks that the weights describe its output
+    EXPECT_LT(total_variation<Stream>(config, weights), 0.01) << config.dump();
+    config["sampler"] = "table";
+    EXPECT_LT(total_variation<Stream>(config, weights), 0.01) << config.dump();
+}
+
+} // namespace
+
+// mean of normal and lambda of exponential distribution streams are read as integers
+
+TEST(distribution_streams, normal_table) {
+    for (auto params :
+         {std::make_pair(0, 1.0), std::make_pair(1, 2.5), std::make_pair(-3, 1.0)}) {
+        const json json_config = {{"mean", params.first}, {"std_dev", params.second}};
+        check_table_sampler<normal_distribution_stream>(
+            json_config,
+            normal_distribution_stream::normal_weights(params.first, params.second));
+    }
+}
+
+TEST(distribution_streams, poisson_table) {
+    for (double mean : {3.0, 127.0, 200.0}) {
+        const json json_config = {{"mean", mean}};
+        check_table_sampler<poisson_distribution_stream>(
+            json_config, poisson_distribution_stream::poisson_weights(mean));
+    }
+}
+
+TEST(distribution_streams, exponential_table) {
+    for (int lambda : {1, 2}) {
+        const json json_config = {{"lambda", lambda}};
+        check_table_sampler<exponential_distribution_stream>(
+            json_config, exponential_distribution_stream::exponential_weights(lambda));
+    }
+}
+
 TEST(hw_counter, invalid_params) {
     const json json_config = {
         {"randomize_start", false},
@@ -193,6 +475,82 @@ TEST(hw_counter, period_test) {
     }
 }
 
+TEST(hw_counter, rank_unrank) {
+    ASSERT_EQ(4960u, hw_counter::binomial(32, 3));
+    ASSERT_EQ(std::numeric_limits<std::uint64_t>::max(), hw_counter::binomial(1024, 512));
+
+    std::vector<std::size_t> positions = {0, 1, 2};
+    for (std::uint64_t index = 0; index < 4960; ++index) {
+        ASSERT_EQ(positions, hw_counter::unrank(index, 32, 3));
+        ASSERT_EQ(index, hw_counter::rank(positions, 32));
+
+        // lexicographic successor
+        std::size_t i = positions.size();
+        while (i-- > 0 && positions[i] == 32 - positions.size() + i) {
+        }
+        if (i < positions.size()) {
+            ++positions[i];
+            for (std::size_t j = i + 1; j < positions.size(); ++j)
+                positions[j] = positions[j - 1] + 1;
+        }
+    }
+    ASSERT_THROW(hw_counter::unrank(4960, 32, 3), std::runtime_error);
+}
+
+TEST(hw_counter, seek) {
+    for (const bool increase_hw : {false, true}) {
+        const json json_config = {{"increase_hw", increase_hw}, {"hw", 2}};
+
+        seed_seq_from<pcg32> seeder(testsuite::seed1);
+        auto sequential = std::make_unique<hw_counter>(json_config, seeder, 3);
+        std::vector<std::vector<value_type>> expected;
+        for (unsigned i = 0; i < 3000; ++i)
+            expected.push_back(sequential->next().copy_to_vector());
+
+        for (const std::uint64_t offset : {0, 1, 275, 276, 2300, 2302, 2999}) {
+            json shard_config = json_config;
+            shard_config["offset"] = offset;
+            auto shard = std::make_unique<hw_counter>(shard_config, seeder, 3);
+            for (std::uint64_t i = offset; i < std::min<std::uint64_t>(offset + 300, 3000); ++i)
+                ASSERT_EQ(expected[i], shard->next().copy_to_vector()) << increase_hw << " " << i;
+        }
+    }
+}
+
+TEST(hw_counter, large_weights) {
+    // binomial(128, 64) does not fit 64 bits, indices which do are still reachable
+    std::vector<std::size_t> first(64);
+    std::iota(first.begin(), first.end(), 0);
+    ASSERT_EQ(first, hw_counter::unrank(0, 128, 64));
+    ASSERT_EQ(0u, hw_counter::rank(first, 128));
+
+    std::vector<std::size_t> second = first;
+    second.back() = 64;
+    ASSERT_EQ(second, hw_counter::unrank(1, 128, 64));
+    ASSERT_EQ(1u, hw_counter::rank(second, 128));
+
+    const std::uint64_t far = std::uint64_t(1) << 62;
+    ASSERT_EQ(far, hw_counter::rank(hw_counter::unrank(far, 128, 64), 128));
+    std::vector<std::size_t> last(64);
+    std::iota(last.begin(), last.end(), 64);
+    ASSERT_EQ(std::numeric_limits<std::uint64_t>::max(), hw_counter::rank(last, 128));
+
+    for (const std::size_t hw : {16, 64}) {
+        const json json_config = {{"increase_hw", false}, {"hw", hw}};
+        seed_seq_from<pcg32> seeder(testsuite::seed1);
+        auto sequential = std::make_unique<hw_counter>(json_config, seeder, 16);
+        std::vector<std::vector<value_type>> expected;
+        for (unsigned i = 0; i < 300; ++i)
+            expected.push_back(sequential->next().copy_to_vector());
+
+        json shard_config = json_config;
+        shard_config["offset"] = 200;
+        auto shard = std::make_unique<hw_counter>(shard_config, seeder, 16);
+        for (unsigned i = 200; i < 300; ++i)
+            ASSERT_EQ(expected[i], shard->next().copy_to_vector()) << hw << " " << i;
+    }
+}
+
 TEST(column_streams, test_with_counter) {
     json json_config = R"({
        "type": "column_stream",
@@ -400,6 +758,262 @@ TEST(column_streams, test_with_counter) {
 
 }
 
+TEST(column_streams, transpose_kernels) {
+    pcg32 rng(testsuite::seed1);
+
+    for (std::size_t rows : {8, 16, 24, 32, 40, 72, 136}) {
+        for (std::size_t row_bytes : {1, 3, 16, 17, 33}) {
+            std::vector<value_type> in(rows * row_bytes);
+            for (auto &byte : in)
+                byte = value_type(rng());
+
+            // bit i of output row j is bit j of input row i, most significant bit first
+            std::vector<value_type> expected(rows * row_bytes);
+            for (std::size_t i = 0; i < rows; ++i) {
+                for (std::size_t j = 0; j < row_bytes * 8; ++j) {
+                    const int bit = (in[i * row_bytes + j / 8] >> (7 - j % 8)) & 1;
+                    expected[j * (rows / 8) + i / 8] |= value_type(bit << (7 - i % 8));
+                }
+            }
+
+            std::vector<value_type> simd(expected.size());
+            std::vector<value_type> scalar(expected.size());
+            bit_transpose::transpose(in.data(), rows, row_bytes, simd.data());
+            bit_transpose::transpose(in.data(), rows, row_bytes, scalar.data(), false);
+
+            ASSERT_EQ(expected, simd) << rows << "x" << row_bytes;
+            ASSERT_EQ(expected, scalar) << rows << "x" << row_bytes;
+        }
+    }
+}
+
+TEST(column_streams, columns_from_one_pass) {
+    const json source = {{"type", "pcg32_stream"}};
+    const std::vector<std::size_t> positions = {3, 100, 7};
+    const json config = {
+        {"type", "columns"}, {"size", 16}, {"positions", positions}, {"source", source}};
+    json interleaved_config = config;
+    interleaved_config["layout"] = "interleaved";
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    seed_seq_from<pcg32> interleaved_seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> columns = make_stream(config, seeder, map, 4);
+    std::unique_ptr<stream> interleaved = make_stream(interleaved_config, interleaved_seeder, map, 4);
+
+    std::vector<std::unique_ptr<stream>> fixed;
+    for (const std::size_t position : positions) {
+        seed_seq_from<pcg32> fixed_seeder(testsuite::seed1);
+        const json fixed_config = {
+            {"type", "column_fixed_position"}, {"size", 16}, {"position", position}, {"source", source}};
+        fixed.push_back(make_stream(fixed_config, fixed_seeder, map, 4));
+    }
+
+    for (unsigned batch = 0; batch < 8; ++batch) {
+        std::vector<std::vector<value_type>> expected;
+        for (std::size_t k = 0; k < positions.size(); ++k) {
+            expected.push_back(fixed[k]->next().copy_to_vector());
+            ASSERT_EQ(expected[k], columns->next().copy_to_vector());
+        }
+
+        std::vector<value_type> expected_interleaved;
+        for (std::size_t b = 0; b < 4; ++b)
+            for (std::size_t k = 0; k < positions.size(); ++k)
+                expected_interleaved.push_back(expected[k][b]);
+        std::vector<value_type> actual_interleaved;
+        for (std::size_t k = 0; k < positions.size(); ++k) {
+            vec_cview v = interleaved->next();
+            actual_interleaved.insert(actual_interleaved.end(), v.begin(), v.end());
+        }
+        ASSERT_EQ(expected_interleaved, actual_interleaved);
+    }
+}
+
+TEST(column_streams, columns_range_is_column_stream) {
+    const json source = {{"type", "counter"}};
+    const json all = {{"type", "columns"},
+                      {"size", 4},
+                      {"positions", {{"from", 0}, {"count", 32}}},
+                      {"source", source}};
+    const json column = {{"type", "column"}, {"size", 4}, {"source", source}};
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> expected = make_stream(column, seeder, map, 8);
+    std::unique_ptr<stream> actual = make_stream(all, seeder, map, 8);
+
+    for (unsigned i = 0; i < 100; ++i)
+        ASSERT_EQ(expected->next().copy_to_vector(), actual->next().copy_to_vector());
+
+    const json outside = {
+        {"type", "columns"}, {"size", 4}, {"positions", {32}}, {"source", source}};
+    ASSERT_THROW(make_stream(outside, seeder, map, 8), std::runtime_error);
+}
+
+TEST(column_streams, DISABLED_transpose_benchmark) {
+    // 128 bit columns of 1M rows
+    const std::size_t rows = 1 << 20;
+    const std::size_t row_bytes = 16;
+    std::vector<value_type> in(rows * row_bytes, 0x5a);
+    // aligned like the buffer of column_stream, so the SIMD kernels use streaming stores
+    aligned_buffer out(in.size());
+
+    // moving the bytes once is the bound of the transposition
+    const auto copy_start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < 16; ++i)
+        std::copy(in.begin(), in.end(), out.data());
+    const std::chrono::duration<double> copy_time = std::chrono::steady_clock::now() - copy_start;
+    std::cout << "copy: " << copy_time.count() / 16 << " s" << std::endl;
+
+    for (bool use_simd : {false, true}) {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < 16; ++i)
+            bit_transpose::transpose(in.data(), rows, row_bytes, out.data(), use_simd);
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        std::cout << (use_simd ? "simd: " : "scalar: ") << time.count() / 16 << " s per transposition"
+                  << std::endl;
+    }
+}
+
+TEST(combinator_streams, kernels_match_reference) {
+    pcg32 rng(testsuite::seed1);
+
+    for (std::size_t word_size : {1, 2, 4, 8}) {
+        for (std::size_t n : {8, 40, 72, 264}) {
+            std::vector<value_type> a(n);
+            std::vector<value_type> b(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = value_type(rng());
+                b[i] = value_type(rng());
+            }
+
+            // little endian words, sums wrap around within the word
+            std::vector<value_type> sum(n);
+            for (std::size_t i = 0; i < n; i += word_size) {
+                unsigned carry = 0;
+                for (std::size_t j = i; j < i + word_size; ++j) {
+                    carry += unsigned(a[j]) + b[j];
+                    sum[j] = value_type(carry);
+                    carry >>= 8;
+                }
+            }
+            const unsigned shift = unsigned(rng() % (8 * word_size));
+            std::vector<value_type> rotated(n);
+            for (std::size_t bit = 0; bit < 8 * n; ++bit) {
+                const std::size_t word = bit / (8 * word_size) * (8 * word_size);
+                const std::size_t from =
+                    word + (bit - word + 8 * word_size - shift) % (8 * word_size);
+                rotated[bit / 8] |= value_type(((a[from / 8] >> (from % 8)) & 1) << (bit % 8));
+            }
+
+            for (bool use_simd : {true, false}) {
+                std::vector<value_type> acc = a;
+                combine::accumulate(
+                    combine::operation::add, word_size, acc.data(), b.data(), n, use_simd);
+                ASSERT_EQ(sum, acc) << word_size << " " << n;
+
+                acc = a;
+                combine::accumulate(
+                    combine::operation::xor_op, word_size, acc.data(), b.data(), n, use_simd);
+                for (std::size_t i = 0; i < n; ++i)
+                    ASSERT_EQ(value_type(a[i] ^ b[i]), acc[i]);
+
+                acc = a;
+                combine::accumulate(
+                    combine::operation::and_op, word_size, acc.data(), b.data(), n, use_simd);
+                for (std::size_t i = 0; i < n; ++i)
+                    ASSERT_EQ(value_type(a[i] & b[i]), acc[i]);
+
+                acc = a;
+                combine::rotate(acc.data(), n, word_size, shift, use_simd);
+                ASSERT_EQ(rotated, acc) << word_size << " " << shift;
+            }
+        }
+    }
+}
+
+TEST(combinator_streams, select_matches_naive_extraction) {
+    const std::string mask = "f00f0ff0aa0180ff11";
+    const json config = {{"type", "combine"},
+                         {"operation", "select"},
+                         {"mask", mask},
+                         {"sources", {{{"type", "pcg32_stream"}}}}};
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    seed_seq_from<pcg32> reference_seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> select = make_stream(config, seeder, map, 5);
+    std::unique_ptr<stream> source =
+        make_stream(config["sources"][0], reference_seeder, map, mask.size() / 2);
+
+    const std::vector<value_type> mask_bytes = testsuite::hex_string_to_binary(mask);
+    std::vector<int> bits;
+    for (unsigned v = 0; v < 40; ++v) {
+        while (bits.size() < 8 * 5) {
+            vec_cview in = source->next();
+            for (std::size_t i = 0; i < 8 * mask_bytes.size(); ++i)
+                if ((mask_bytes[i / 8] >> (i % 8)) & 1)
+                    bits.push_back((in.begin()[std::ptrdiff_t(i / 8)] >> (i % 8)) & 1);
+        }
+        std::vector<value_type> expected(5);
+        for (std::size_t i = 0; i < 8 * 5; ++i)
+            expected[i / 8] |= value_type(bits[i] << (i % 8));
+        bits.erase(bits.begin(), bits.begin() + 8 * 5);
+
+        vec_cview out = select->next();
+        ASSERT_EQ(expected, std::vector<value_type>(out.begin(), out.end())) << v;
+    }
+}
+
+TEST(combinator_streams, batch_same_as_next) {
+    const json random = {{"type", "pcg32_stream"}};
+    const json config = {{"type", "combine"},
+                         {"operation", "xor"},
+                         {"sources", {random, {{"type", "counter"}}, random}}};
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    seed_seq_from<pcg32> batch_seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> single = make_stream(config, seeder, map, 24);
+    std::unique_ptr<stream> batched = make_stream(config, batch_seeder, map, 24);
+
+    std::vector<value_type> expected;
+    for (unsigned i = 0; i < 20; ++i) {
+        vec_cview v = single->next();
+        expected.insert(expected.end(), v.begin(), v.end());
+    }
+    std::vector<value_type> batch(expected.size());
+    batched->next_batch(batch.data(), 20);
+    ASSERT_EQ(expected, batch);
+}
+
+TEST(combinator_streams, invalid_params) {
+    const json random = {{"type", "pcg32_stream"}};
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+
+    EXPECT_THROW(make_stream({{"type", "combine"}, {"operation", "sub"}, {"sources", {random}}},
+                             seeder,
+                             map,
+                             16),
+                 std::runtime_error);
+    EXPECT_THROW(make_stream({{"type", "combine"},
+                              {"operation", "add"},
+                              {"word_size", 3},
+                              {"sources", {random}}},
+                             seeder,
+                             map,
+                             16),
+                 std::runtime_error);
+    EXPECT_THROW(make_stream({{"type", "combine"},
+                              {"operation", "rotate"},
+                              {"sources", {random, random}}},
+                             seeder,
+                             map,
+                             16),
+                 std::runtime_error);
+}
+
 TEST(rnd_plt_ctx_streams, aes_single_vector) {
     const json json_config = R"({
          "type": "tuple_stream",
@@ -577,3 +1191,576 @@ TEST(pipe_streams, pipe_out_fist) {
         ASSERT_EQ(in_view.copy_to_vector(), out_view.copy_to_vector());
     }
 }
+
+TEST(pipe_streams, pipe_out_reads_latest_vector) {
+    const json config = R"({
+         "type": "tuple_stream",
+         "sources": [
+             {"type": "pipe_in_stream", "id": "p", "output_size": 2,
+              "source": {"type": "counter"}},
+             {"type": "repeating_stream", "period": 1000, "output_size": 2,
+              "source": {"type": "pipe_out_stream", "id": "p"}}
+         ]
+     }
+    )"_json;
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> tuple = make_stream(config, seeder, map, 4);
+
+    // the pipe_out_stream is read once per 1000 vectors of the pipe_in_stream, the counter
+    // starts at 1
+    for (unsigned i = 1; i <= 2500; ++i) {
+        const std::vector<value_type> v = tuple->next().copy_to_vector();
+        const unsigned latest = (i - 1) / 1000 * 1000 + 1;
+        ASSERT_EQ(std::vector<value_type>({value_type(i), value_type(i >> 8), value_type(latest),
+                                           value_type(latest >> 8)}),
+                  v);
+    }
+}
+
+TEST(pipe_streams, consumers_read_at_own_pace) {
+    const json json_in = R"({
+         "type": "pipe_in_stream",
+         "id": "id",
+         "ordered": true,
+         "capacity": 4,
+         "source": {
+             "type": "counter"
+         }
+     }
+    )"_json;
+    const json json_out = R"({
+         "type": "pipe_out_stream",
+         "id": "id"
+     }
+    )"_json;
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+
+    std::unique_ptr<stream> pipe_in = make_stream(json_in, seeder, map, 16);
+    std::unique_ptr<stream> pipe_out = make_stream(json_out, seeder, map, 16);
+    const auto &buffer = static_cast<const pipe_buffer &>(**map.at("id"));
+
+    std::vector<std::vector<value_type>> out_vectors;
+    for (unsigned i = 0; i < 3; ++i) {
+        out_vectors.push_back(pipe_out->next().copy_to_vector());
+    }
+    ASSERT_EQ(3u, buffer.buffered());
+
+    for (unsigned i = 0; i < 3; ++i) {
+        ASSERT_EQ(out_vectors[i], pipe_in->next().copy_to_vector());
+    }
+    // only the last vector returned to each consumer is kept
+    ASSERT_EQ(1u, buffer.buffered());
+
+    for (unsigned i = 0; i < 4; ++i) {
+        pipe_in->next();
+    }
+    ASSERT_THROW(pipe_in->next(), std::runtime_error);
+}
+
+TEST(threaded_streams, same_as_source) {
+    const json source = R"({
+         "type": "tuple_stream",
+         "sources": [
+             {"type": "pipe_in_stream", "id": "p", "output_size": 5,
+              "source": {"type": "pcg32_stream"}},
+             {"type": "counter", "output_size": 6},
+             {"type": "pipe_out_stream", "id": "p", "output_size": 5}
+         ]
+     }
+    )"_json;
+    const json threaded = {{"type", "threaded_stream"}, {"batch", 3}, {"capacity", 2},
+                           {"source", source}};
+
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map1;
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map2;
+
+    std::unique_ptr<stream> expected = make_stream(source, seeder1, map1, 16);
+    std::unique_ptr<stream> actual = make_stream(threaded, seeder2, map2, 16);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        ASSERT_EQ(expected->next().copy_to_vector(), actual->next().copy_to_vector());
+    }
+}
+
+/**
+ * Two instances of each algorithm which used to keep its key schedule or scratch state in globals
+ */
+static json ciphers_with_former_globals() {
+    const json counter = {{"type", "counter"}};
+    const json random = {{"type", "pcg32_stream"}};
+    json sources = json::array();
+    for (const std::string algorithm : {"ECHO", "CRUNCH", "Fugue", "MD6"}) {
+        sources.push_back({{"type", "hash"},
+                           {"algorithm", algorithm},
+                           {"round", algorithm == "MD6" ? 16 : 4},
+                           {"hash_size", 32},
+                           {"input_size", 32},
+                           {"output_size", 32},
+                           {"source", counter}});
+    }
+    sources.push_back({{"type", "block"},
+                       {"init_frequency", "only_once"},
+                       {"algorithm", "TWOFISH"},
+                       {"round", 16},
+                       {"block_size", 16},
+                       {"plaintext", counter},
+                       {"key_size", 16},
+                       {"key", random},
+                       {"iv", random},
+                       {"output_size", 16}});
+    sources.push_back({{"type", "stream_cipher"},
+                       {"algorithm", "Zk-Crypt"},
+                       {"round", 0},
+                       {"block_size", 16},
+                       {"plaintext", counter},
+                       {"key_size", 16},
+                       {"key", random},
+                       {"iv_size", 16},
+                       {"iv", random},
+                       {"output_size", 16}});
+
+    json twice = sources;
+    for (const json &source : sources)
+        twice.push_back(source);
+    return twice;
+}
+
+TEST(threaded_streams, concurrent_ciphers_same_as_sequential) {
+    const json sequential = {{"type", "tuple_stream"}, {"sources", ciphers_with_former_globals()}};
+    // the first instance of each algorithm runs on a worker, the second on this thread
+    json threaded = sequential;
+    for (std::size_t i = 0; i < threaded["sources"].size() / 2; ++i) {
+        json &source = threaded["sources"][i];
+        source = {{"type", "threaded_stream"},
+                  {"output_size", source["output_size"]},
+                  {"source", source}};
+    }
+
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map1;
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map2;
+
+    std::unique_ptr<stream> expected = make_stream(sequential, seeder1, map1, 320);
+    std::unique_ptr<stream> actual = make_stream(threaded, seeder2, map2, 320);
+
+    for (unsigned i = 0; i < 2000; ++i) {
+        ASSERT_EQ(expected->next().copy_to_vector(), actual->next().copy_to_vector()) << i;
+    }
+}
+
+TEST(threaded_streams, pipe_crossing_boundary) {
+    const json threaded = R"({
+         "type": "threaded_stream",
+         "source": {
+             "type": "pipe_in_stream",
+             "id": "p",
+             "source": {"type": "counter"}
+         }
+     }
+    )"_json;
+
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+
+    ASSERT_THROW(make_stream(threaded, seeder, map, 16), std::runtime_error);
+}
+
+TEST(tuple_streams, parallel_same_as_sequential) {
+    json sequential = R"({
+         "type": "tuple_stream",
+         "sources": [
+             {"type": "pcg32_stream", "output_size": 3},
+             {"type": "pipe_out_stream", "id": "p", "output_size": 4},
+             {"type": "counter", "output_size": 2},
+             {"type": "pipe_in_stream", "id": "p", "output_size": 4,
+              "source": {"type": "mt19937_stream"}},
+             {"type": "tuple_stream", "parallel": true, "output_size": 3, "sources": [
+                 {"type": "pcg32_stream", "output_size": 1},
+                 {"type": "counter", "output_size": 2}
+             ]}
+         ]
+     }
+    )"_json;
+    json parallel = sequential;
+    parallel["parallel"] = true;
+
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map1;
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map2;
+
+    std::unique_ptr<stream> expected = make_stream(sequential, seeder1, map1, 16);
+    std::unique_ptr<stream> actual = make_stream(parallel, seeder2, map2, 16);
+
+    for (unsigned i = 0; i < 1000; ++i) {
+        ASSERT_EQ(expected->next().copy_to_vector(), actual->next().copy_to_vector());
+    }
+}
+
+TEST(tuple_streams, parallel_ciphers_same_as_sequential) {
+    const json sequential = {{"type", "tuple_stream"}, {"sources", ciphers_with_former_globals()}};
+    json parallel = sequential;
+    parallel["parallel"] = true;
+
+    seed_seq_from<pcg32> seeder1(testsuite::seed1);
+    seed_seq_from<pcg32> seeder2(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map1;
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map2;
+
+    std::unique_ptr<stream> expected = make_stream(sequential, seeder1, map1, 320);
+    std::unique_ptr<stream> actual = make_stream(parallel, seeder2, map2, 320);
+
+    for (unsigned i = 0; i < 2000; ++i) {
+        ASSERT_EQ(expected->next().copy_to_vector(), actual->next().copy_to_vector()) << i;
+    }
+}
+
+TEST(tuple_streams, parallel_propagates_exceptions) {
+    work_stealing_pool pool(3);
+    std::atomic<unsigned> calls(0);
+
+    ASSERT_THROW(pool.parallel_for(8,
+                                   [&](std::size_t i) {
+                                       ++calls;
+                                       if (i == 5)
+                                           throw std::runtime_error("task failed");
+                                   }),
+                 std::runtime_error);
+    ASSERT_EQ(8u, calls.load());
+}
+
+TEST(work_stealing_pool, waiting_join_runs_only_its_tasks) {
+    work_stealing_pool pool(2);
+    std::atomic<unsigned> foreign(0);
+    std::atomic<unsigned> inner_calls(0);
+
+    pool.parallel_for(32, [&](std::size_t) {
+        // set while the thread waits for the nested join
+        static thread_local bool joining = false;
+        if (joining)
+            ++foreign;
+
+        joining = true;
+        pool.parallel_for(4, [&](std::size_t) {
+            ++inner_calls;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        });
+        joining = false;
+    });
+    EXPECT_EQ(0u, foreign.load());
+    EXPECT_EQ(32u * 4, inner_calls.load());
+}
+
+TEST(work_stealing_pool, without_workers_runs_on_caller) {
+    work_stealing_pool pool(0);
+    EXPECT_EQ(0u, pool.size());
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::vector<std::size_t> order;
+    pool.parallel_for(5, [&](std::size_t i) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        order.push_back(i);
+    });
+    EXPECT_EQ(std::vector<std::size_t>({0, 1, 2, 3, 4}), order);
+}
+
+TEST(stream, skip_matches_discarded_vectors) {
+    const std::vector<json> configs = {
+        {{"type", "counter"}, {"width", 5}, {"stride", 3}, {"endianness", "big"}},
+        {{"type", "pcg32_stream"}},
+        {{"type", "pcg32_stream"}, {"bulk", true}},
+        {{"type", "mt19937_stream"}, {"bulk", true}},
+        {{"type", "pcg32x8_stream"}},
+        {{"type", "xor_stream"}, {"source", {{"type", "pcg32_stream"}, {"bulk", true}}}},
+        {{"type", "combine"},
+         {"operation", "add"},
+         {"sources", {{{"type", "counter"}}, {{"type", "pcg32x8_stream"}}}}},
+        {{"type", "combine"},
+         {"operation", "select"},
+         {"mask", "f00f0ff0aa0180ff11"},
+         {"sources", {{{"type", "pcg32_stream"}, {"bulk", true}}}}},
+        {{"type", "xor_stream"}, {"source", {{"type", "hw_counter"}, {"hw", 2}}}}};
+
+    // 13 bytes are not a multiple of the generator outputs, so parts of outputs are carried
+    for (const json &config : configs) {
+        for (std::uint64_t count : {0, 1, 2, 9, 1000}) {
+            seed_seq_from<pcg32> seeder1(testsuite::seed1);
+            seed_seq_from<pcg32> seeder2(testsuite::seed1);
+            std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+            std::unique_ptr<stream> sequential = make_stream(config, seeder1, map, 13);
+            std::unique_ptr<stream> skipped = make_stream(config, seeder2, map, 13);
+
+            for (std::uint64_t i = 0; i < count; ++i)
+                sequential->next();
+            skipped->skip(count);
+
+            for (unsigned i = 0; i < 5; ++i) {
+                ASSERT_EQ(sequential->next().copy_to_vector(), skipped->next().copy_to_vector())
+                    << config.dump() << " count " << count;
+            }
+        }
+    }
+}
+
+TEST(materialized_streams, replay_extends_and_detects_corruption) {
+    const json source = {{"type", "xor_stream"}, {"source", {{"type", "pcg32_stream"}}}};
+    const json config = {
+        {"type", "materialize"}, {"dir", "materialize_test_dir"}, {"source", source}};
+
+    seed_seq_from<pcg32> reference_seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> reference = make_stream(source, reference_seeder, map, 16);
+    std::vector<value_type> expected(100 * 16);
+    reference->next_batch(expected.data(), 100);
+
+    // the number of vectors read before, and whether the stored data are damaged
+    const std::vector<std::pair<std::size_t, bool>> runs = {
+        {0, false}, {30, false}, {100, false}, {70, true}};
+    for (const auto &run : runs) {
+        if (run.second) {
+            glob_t data;
+            ASSERT_EQ(0, glob("materialize_test_dir/*.bin", 0, nullptr, &data));
+            std::fstream file(data.gl_pathv[0], std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(123);
+            file.put('x');
+            globfree(&data);
+        }
+
+        seed_seq_from<pcg32> seeder(testsuite::seed1);
+        std::unique_ptr<stream> materialized = make_stream(config, seeder, map, 16);
+        std::uint32_t after[2];
+        seeder.generate(after, after + 1);
+        seed_seq_from<pcg32> reference_after(testsuite::seed1);
+        make_stream(source, reference_after, map, 16);
+        reference_after.generate(after + 1, after + 2);
+        EXPECT_EQ(after[0], after[1]); // the seeder is used as by the source alone
+
+        // a skip over the stored vectors, then single vectors and a batch over the end
+        materialized->skip(run.first / 2);
+        for (std::size_t i = run.first / 2; i < run.first; ++i)
+            ASSERT_EQ(std::vector<value_type>(expected.begin() + std::ptrdiff_t(i * 16),
+                                              expected.begin() + std::ptrdiff_t(i * 16 + 16)),
+                      materialized->next().copy_to_vector());
+        std::vector<value_type> batch((100 - run.first) * 16);
+        materialized->next_batch(batch.data(), 100 - run.first);
+        EXPECT_TRUE(std::equal(
+            batch.begin(), batch.end(), expected.begin() + std::ptrdiff_t(run.first * 16)));
+    }
+
+    glob_t entries;
+    ASSERT_EQ(0, glob("materialize_test_dir/*", 0, nullptr, &entries));
+    EXPECT_EQ(2u, entries.gl_pathc);
+    for (std::size_t i = 0; i < entries.gl_pathc; ++i)
+        std::remove(entries.gl_pathv[i]);
+    globfree(&entries);
+    rmdir("materialize_test_dir");
+}
+
+TEST(materialized_streams, checks_blocks_when_read) {
+    const json source = {{"type", "pcg32_stream"}, {"bulk", true}};
+    const json config = {
+        {"type", "materialize"}, {"dir", "materialize_blocks_dir"}, {"source", source}};
+    const std::size_t osize = 4096; // 256 vectors in a block of the checksums
+    const std::size_t vectors = 600;
+
+    seed_seq_from<pcg32> reference_seeder(testsuite::seed1);
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    std::unique_ptr<stream> reference = make_stream(source, reference_seeder, map, osize);
+    std::vector<value_type> expected(vectors * osize);
+    reference->next_batch(expected.data(), vectors);
+
+    const auto read = [&](const std::size_t count) {
+        seed_seq_from<pcg32> seeder(testsuite::seed1);
+        std::unique_ptr<stream> materialized = make_stream(config, seeder, map, osize);
+        std::vector<value_type> data(count * osize);
+        materialized->next_batch(data.data(), count);
+        return std::equal(data.begin(), data.end(), expected.begin());
+    };
+    const auto stored = [&]() {
+        glob_t data;
+        EXPECT_EQ(0, glob("materialize_blocks_dir/*.bin", 0, nullptr, &data));
+        std::ifstream file(data.gl_pathv[0], std::ios::binary);
+        globfree(&data);
+        return std::vector<value_type>(std::istreambuf_iterator<char>(file), {});
+    };
+
+    ASSERT_TRUE(read(vectors));
+    {
+        glob_t data;
+        ASSERT_EQ(0, glob("materialize_blocks_dir/*.bin", 0, nullptr, &data));
+        std::fstream file(data.gl_pathv[0], std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(3 << 19); // in the second block
+        file.put(char(expected[3 << 19] ^ 1));
+        globfree(&data);
+    }
+
+    // the damaged block is not read, the file stays as it is
+    ASSERT_TRUE(read(100));
+    EXPECT_NE(expected, stored());
+
+    // the vectors from the damaged block on are generated and stored again
+    ASSERT_TRUE(read(vectors));
+    EXPECT_EQ(expected, stored());
+    ASSERT_TRUE(read(vectors));
+
+    glob_t entries;
+    ASSERT_EQ(0, glob("materialize_blocks_dir/*", 0, nullptr, &entries));
+    for (std::size_t i = 0; i < entries.gl_pathc; ++i)
+        std::remove(entries.gl_pathv[i]);
+    globfree(&entries);
+    rmdir("materialize_blocks_dir");
+}
+
+TEST(file_streams, offset_stride_loop_and_skip) {
+    {
+        std::ofstream file("file_stream_test.bin", std::ios::binary);
+        for (int i = 0; i < 100; ++i)
+            file.put(char(i));
+    }
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+
+    // vectors start at 3, 13, ..., 93, the last one ends at byte 96
+    json config = {{"type", "file_stream"},
+                   {"path", "file_stream_test.bin"},
+                   {"offset", 3},
+                   {"stride", 10},
+                   {"loop", true}};
+    std::unique_ptr<stream> looped = make_stream(config, seeder, map, 4);
+    for (int i = 0; i < 25; ++i) {
+        const auto start = value_type(3 + 10 * (i % 10));
+        ASSERT_EQ((std::vector<value_type>{start, value_type(start + 1), value_type(start + 2),
+                                           value_type(start + 3)}),
+                  looped->next().copy_to_vector());
+    }
+    looped->skip(12); // from vector 5 to 7
+    EXPECT_EQ(73, looped->next().copy_to_vector()[0]);
+
+    config.erase("loop");
+    config.erase("stride");
+    std::unique_ptr<stream> once = make_stream(config, seeder, map, 4);
+    std::vector<value_type> all(24 * 4);
+    once->next_batch(all.data(), 24);
+    EXPECT_EQ(98, all.back());
+    EXPECT_THROW(once->next(), std::runtime_error);
+    std::remove("file_stream_test.bin");
+
+    // special files are read through the buffer
+    const json device = {{"type", "file_stream"}, {"path", "/dev/zero"}, {"offset", 5}};
+    std::unique_ptr<stream> zeros = make_stream(device, seeder, map, 16);
+    zeros->skip(1000000);
+    EXPECT_EQ(std::vector<value_type>(16, 0), zeros->next().copy_to_vector());
+    EXPECT_THROW(make_stream(json{{"type", "file_stream"}, {"path", "/dev/zero"}, {"loop", true}},
+                             seeder, map, 16),
+                 std::runtime_error);
+}
+
+TEST(fd_streams, reads_pipe_in_vectors_and_batches) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    std::vector<value_type> data(10000);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = value_type(i * 7);
+    std::thread writer([&]() {
+        // small writes, so that the reads get partial data
+        for (std::size_t i = 0; i < data.size(); i += 100)
+            ASSERT_EQ(100, write(fds[1], data.data() + i, 100));
+        close(fds[1]);
+    });
+
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    const json config = {{"type", "fd_stream"}, {"fd", fds[0]}, {"buffer_size", 64}};
+    std::unique_ptr<stream> piped = make_stream(config, seeder, map, 16);
+
+    EXPECT_EQ(std::vector<value_type>(data.begin(), data.begin() + 16),
+              piped->next().copy_to_vector());
+    piped->skip(3);
+    // larger than the buffer, read directly
+    std::vector<value_type> batch(500 * 16);
+    piped->next_batch(batch.data(), 500);
+    EXPECT_TRUE(std::equal(batch.begin(), batch.end(), data.begin() + 64));
+    piped->skip(100);
+    EXPECT_EQ(std::vector<value_type>(data.begin() + 9664, data.begin() + 9680),
+              piped->next().copy_to_vector());
+    piped->skip(19);
+    EXPECT_EQ(std::vector<value_type>(data.end() - 16, data.end()), piped->next().copy_to_vector());
+    EXPECT_THROW(piped->next(), std::runtime_error);
+
+    writer.join();
+    close(fds[0]);
+}
+
+TEST(fd_streams, stdin_stream_rejects_other_descriptors) {
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> map;
+    seed_seq_from<pcg32> seeder(testsuite::seed1);
+    EXPECT_THROW(make_stream(json{{"type", "stdin_stream"}, {"fd", 3}}, seeder, map, 16),
+                 std::runtime_error);
+    EXPECT_THROW(make_stream(json{{"type", "stdin_stream"}, {"fd", 0}}, seeder, map, 16),
+                 std::runtime_error);
+    EXPECT_NO_THROW(make_stream(json{{"type", "stdin_stream"}}, seeder, map, 16));
+}
+
+TEST(fd_writer, writes_pipe_and_file_in_order) {
+    std::vector<char> data(std::size_t(5) << 20);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = char(i * 31 + i / 4096);
+
+    // odd write sizes, so that the buffers fill at different offsets
+    auto write_all = [&data](std::ostream &out) {
+        for (std::size_t i = 0, n = 1; i < data.size(); i += n, n = n * 7 % 100003)
+            out.write(data.data() + i, std::streamsize(std::min(n, data.size() - i)));
+        out.put('x');
+    };
+
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    std::vector<char> received;
+    std::thread reader([&]() {
+        // a slow consumer, the pipe stays full while the buffers are refilled
+        std::vector<char> chunk(10000);
+        for (ssize_t got; (got = read(fds[0], chunk.data(), chunk.size())) > 0;) {
+            received.insert(received.end(), chunk.begin(), chunk.begin() + got);
+            if (received.size() % 7 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+    {
+        fd_writer writer(fds[1], "test pipe", 4096);
+        EXPECT_EQ(0u, writer.buffer_size() % 4096);
+        std::ostream out(&writer);
+        write_all(out);
+        writer.close();
+        EXPECT_TRUE(out.good());
+    }
+    close(fds[1]);
+    reader.join();
+    close(fds[0]);
+    ASSERT_EQ(data.size() + 1, received.size());
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), received.begin()));
+    EXPECT_EQ('x', received.back());
+
+    const std::string name = "fd_writer_test.bin";
+    const int file = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(-1, file);
+    {
+        // written on destruction
+        fd_writer writer(file, name, 100000);
+        std::ostream out(&writer);
+        write_all(out);
+    }
+    close(file);
+    std::ifstream in(name, std::ios::binary);
+    const std::vector<char> stored((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+    std::remove(name.c_str());
+    ASSERT_EQ(data.size() + 1, stored.size());
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), stored.begin()));
+}
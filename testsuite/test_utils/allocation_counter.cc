@@ -0,0 +1,68 @@
+#include "allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// all threads, so the workers of threaded and parallel streams are counted too
+std::atomic<unsigned> counters(0);
+std::atomic<std::size_t> count(0);
+
+void *allocate(std::size_t size) {
+    if (counters.load(std::memory_order_relaxed) != 0)
+        count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        if (void *p = std::malloc(size))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace testsuite {
+
+allocation_counter::allocation_counter()
+    : _start(count.load()) {
+    ++counters;
+}
+
+allocation_counter::~allocation_counter() {
+    --counters;
+}
+
+std::size_t allocation_counter::allocations() const {
+    return count.load() - _start;
+}
+
+} // namespace testsuite
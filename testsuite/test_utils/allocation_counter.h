@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+namespace testsuite {
+
+/**
+ * Counts heap allocations made by any thread while an instance exists.
+ * The testsuite replaces the global operator new to make this possible.
+ */
+struct allocation_counter {
+    allocation_counter();
+    ~allocation_counter();
+
+    allocation_counter(const allocation_counter &) = delete;
+    allocation_counter &operator=(const allocation_counter &) = delete;
+
+    std::size_t allocations() const;
+
+private:
+    std::size_t _start;
+};
+
+} // namespace testsuite
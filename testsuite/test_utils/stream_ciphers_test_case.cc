@@ -65,7 +65,7 @@ void stream_cipher_test_case::test(
     decryptor->ivsetup(_iv.data());
     decryptor->decrypt_bytes(ciphertext.data(), plain.data(), ciphertext.size());
 
-    vec_cview plain_view = vec_cview(plain.cbegin(), plain.cend());
+    vec_cview plain_view = vec_cview(plain.data(), plain.data() + plain.size());
     ASSERT_EQ(plain_view.copy_to_vector(), _plaintext);
 }
 
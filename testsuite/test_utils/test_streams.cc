@@ -12,7 +12,8 @@ vec_cview testsuite::test_stream::next() {
     if (++_position >= _data.size()) {
         _position = 0;
     }
-    return make_cview(_data.at(current_position));
+    const std::vector<value_type> &current = _data.at(current_position);
+    return vec_cview(current.data(), current.data() + current.size());
 }
 
 testsuite::test_stream::test_stream(const std::initializer_list<std::vector<value_type>> &data)
@@ -65,6 +65,27 @@ TEST(LCG, random_seed_test) {
 
 
 
+TEST(LCG, jump) {
+    for (std::uint64_t n : {1, 1000, 123456}) {
+        seed seed1 = seed::create("1fe40505e131963c");
+        seed_seq_from<pcg32> seeder1(seed1);
+        seed_seq_from<pcg32> seeder2(seed1);
+
+        auto jumped = std::make_unique<prng::ulcg_generator>(std::make_unique<pcg32_stream>(seeder1, 7), false, 9223372036854775783, 4645906587823291368, 0);
+        auto sequential = std::make_unique<prng::ulcg_generator>(std::make_unique<pcg32_stream>(seeder2, 7), false, 9223372036854775783, 4645906587823291368, 0);
+
+        std::vector<uint8_t> data(n * 7);
+        sequential->generate_bits(data.data(), data.size());
+        jumped->jump(n);
+
+        std::vector<uint8_t> expected(16 * 7);
+        std::vector<uint8_t> actual(16 * 7);
+        sequential->generate_bits(expected.data(), expected.size());
+        jumped->generate_bits(actual.data(), actual.size());
+        ASSERT_EQ(expected, actual);
+    }
+}
+
 TEST(MRG, basic_test) {
     std::vector<long> a = {2975962250, 2909704450};
     uint64_t m = 9223372036854775783;
@@ -105,6 +126,31 @@ TEST(MRG, random_seed_test) {
     }
 }
 
+TEST(MRG, jump) {
+    std::vector<long> a = {2975962250, 2909704450};
+    uint64_t m = 9223372036854775783;
+    size_t viable_bytes = prng::umrg_generator::get_viable_number_of_bytes(m);
+
+    for (std::uint64_t n : {1, 1000, 123456}) {
+        seed seed1 = seed::create("1fe40505e131963c");
+        seed_seq_from<pcg32> seeder1(seed1);
+        seed_seq_from<pcg32> seeder2(seed1);
+
+        auto jumped = std::make_unique<prng::umrg_generator>(std::make_unique<pcg32_stream>(seeder1, 2 * viable_bytes), false, m, a);
+        auto sequential = std::make_unique<prng::umrg_generator>(std::make_unique<pcg32_stream>(seeder2, 2 * viable_bytes), false, m, a);
+
+        std::vector<uint8_t> data(n * 7);
+        sequential->generate_bits(data.data(), data.size());
+        jumped->jump(n);
+
+        std::vector<uint8_t> expected(16 * 7);
+        std::vector<uint8_t> actual(16 * 7);
+        sequential->generate_bits(expected.data(), expected.size());
+        jumped->generate_bits(actual.data(), actual.size());
+        ASSERT_EQ(expected, actual);
+    }
+}
+
 TEST(XORSHIFT, random_seed_test) {
     seed seed1 = seed::create("1fe40505e131963c");
     seed_seq_from<pcg32> seeder(seed1);
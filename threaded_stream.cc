@@ -0,0 +1,112 @@
+#include "threaded_stream.h"
+#include "streams.h"
+#include <stdexcept>
+
+namespace {
+
+double seconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+} // namespace
+
+void threaded_stream::check_pipes_are_internal(const json &config) {
+    std::set<std::string> in;
+    std::set<std::string> out;
+    collect_pipe_ids(config, in, out);
+
+    for (const auto &id : in)
+        if (out.count(id) == 0)
+            throw std::runtime_error("pipe \"" + id +
+                                     "\" leaves threaded_stream, its pipe_out_stream is outside");
+    for (const auto &id : out)
+        if (in.count(id) == 0)
+            throw std::runtime_error("pipe \"" + id +
+                                     "\" enters threaded_stream, its pipe_in_stream is outside");
+}
+
+threaded_stream::threaded_stream(
+    const json &config,
+    default_seed_source &seeder,
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &,
+    const std::size_t osize)
+    : stream(osize)
+    , _name(config.at("source").at("type").get<std::string>())
+    , _batch(std::size_t(config.value("batch", 16)))
+    , _ring(std::size_t(config.value("capacity", 4)),
+            std::vector<value_type>(_batch * osize))
+    , _current(nullptr)
+    , _position(0)
+    , _producer_busy(0)
+    , _producer_blocked(0)
+    , _consumer_blocked(0) {
+    if (_batch == 0 || config.value("capacity", 4) == 0)
+        throw std::runtime_error("threaded_stream needs non-zero batch and capacity");
+    check_pipes_are_internal(config.at("source"));
+
+    // the subtree gets its own pipe table, the check above guarantees it needs no other pipe
+    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> local_pipes;
+    {
+        // written by the worker, its buffers stay apart from those of the consuming thread
+        const aligned_buffer::arena_scope arena;
+        _source = make_stream(config.at("source"), seeder, local_pipes, osize);
+    }
+
+    _start = clock::now();
+    _worker = std::thread(&threaded_stream::produce, this);
+}
+
+threaded_stream::~threaded_stream() {
+    _ring.close();
+    _worker.join();
+
+    const double total = seconds(clock::now() - _start);
+    if (total > 0) {
+        logger::info() << "threaded_stream " << _name << ": producer busy "
+                       << 100 * seconds(_producer_busy) / total << "%, blocked on full ring "
+                       << 100 * seconds(_producer_blocked) / total << "%; consumer waited "
+                       << 100 * seconds(_consumer_blocked) / total << "%" << std::endl;
+    }
+}
+
+void threaded_stream::produce() {
+    try {
+        for (;;) {
+            const auto wait_start = clock::now();
+            std::vector<value_type> *slot = _ring.acquire_write();
+            const auto work_start = clock::now();
+            _producer_blocked += work_start - wait_start;
+            if (slot == nullptr)
+                return;
+
+            _source->next_batch(slot->data(), _batch);
+            _ring.commit_write();
+            _producer_busy += clock::now() - work_start;
+        }
+    } catch (...) {
+        _error = std::current_exception();
+        _ring.close();
+    }
+}
+
+vec_cview threaded_stream::next() {
+    if (_current == nullptr) {
+        const auto wait_start = clock::now();
+        _current = _ring.acquire_read();
+        _consumer_blocked += clock::now() - wait_start;
+        if (_current == nullptr) {
+            // the ring is only closed from here by the worker, after storing its exception
+            std::rethrow_exception(_error);
+        }
+        _position = 0;
+    }
+
+    const auto begin = _current->begin() + std::ptrdiff_t(_position * osize());
+    std::copy(begin, begin + std::ptrdiff_t(osize()), _data.begin());
+
+    if (++_position == _batch) {
+        _ring.release_read();
+        _current = nullptr;
+    }
+    return make_cview(_data);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "spsc_ring.h"
+#include "stream.h"
+#include <chrono>
+#include <eacirc-core/json.h>
+#include <eacirc-core/random.h>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Runs its source subtree on a worker thread
+ *
+ * The subtree is constructed on the calling thread, so the seeder is used exactly as without the
+ * node and the output is identical. The worker then produces batches of "batch" vectors into a
+ * ring of "capacity" batches, overlapping the subtree with the stages consuming this stream.
+ * Pipes have to stay inside the subtree. The subtree runs concurrently with other instances of
+ * the same algorithms, which therefore keep no state in globals (tested for the ciphers which did).
+ * Utilization of both sides is logged on destruction.
+ */
+struct threaded_stream : stream {
+    threaded_stream(const json &config,
+                    default_seed_source &seeder,
+                    std::unordered_map<std::string, std::shared_ptr<std::unique_ptr<stream>>> &pipes,
+                    const std::size_t osize);
+    ~threaded_stream() override;
+
+    vec_cview next() override;
+
+    /**
+     * @brief Checks that every pipe used in the config has both ends inside of it
+     */
+    static void check_pipes_are_internal(const json &config);
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void produce();
+
+    const std::string _name;
+    const std::size_t _batch;
+    std::unique_ptr<stream> _source;
+    spsc_ring<std::vector<value_type>> _ring;
+
+    const std::vector<value_type> *_current;
+    std::size_t _position;
+
+    std::exception_ptr _error;
+    clock::duration _producer_busy;
+    clock::duration _producer_blocked;
+    clock::duration _consumer_blocked;
+    clock::time_point _start;
+
+    std::thread _worker;
+};
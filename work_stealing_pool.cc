@@ -0,0 +1,188 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <array>
+#include <exception>
+
+struct work_stealing_pool::join_state {
+    std::atomic<std::size_t> remaining;
+    std::mutex mutex;
+    std::exception_ptr error;
+};
+
+work_stealing_pool::work_stealing_pool(std::size_t threads)
+    : _queued(0)
+    , _next_queue(0)
+    , _stop(false) {
+    for (std::size_t i = 0; i < threads; ++i)
+        _queues.push_back(std::make_unique<task_queue>());
+    for (std::size_t i = 0; i < threads; ++i)
+        _workers.emplace_back(&work_stealing_pool::work, this, i);
+}
+
+work_stealing_pool::~work_stealing_pool() {
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto &worker : _workers)
+        worker.join();
+}
+
+work_stealing_pool &work_stealing_pool::shared() {
+    static work_stealing_pool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return pool;
+}
+
+void work_stealing_pool::parallel_for(std::size_t n, const std::function<void(std::size_t)> &f) {
+    if (n == 0)
+        return;
+
+    join_state state;
+    state.remaining = n;
+    // small joins keep their tasks on the stack, so that a steady fork-join does not allocate
+    std::array<task, 16> local_tasks;
+    std::vector<task> heap_tasks(n > local_tasks.size() ? n : 0);
+    task *tasks = n > local_tasks.size() ? heap_tasks.data() : local_tasks.data();
+
+    if (_queues.empty()) {
+        // without workers the caller runs the tasks one after another
+        for (std::size_t i = 0; i < n; ++i) {
+            tasks[i] = {&f, i, &state};
+            run(tasks[i]);
+        }
+        if (state.error)
+            std::rethrow_exception(state.error);
+        return;
+    }
+
+    // the caller runs the first task itself, the rest is spread over the worker deques
+    _queued += n - 1;
+    for (std::size_t i = 1; i < n; ++i) {
+        tasks[i] = {&f, i, &state};
+        task_queue &queue = *_queues[_next_queue++ % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.push_back(&tasks[i]);
+    }
+    if (n > 1) {
+        { std::lock_guard<std::mutex> lock(_sleep_mutex); }
+        _wake.notify_all();
+    }
+
+    tasks[0] = {&f, 0, &state};
+    run(tasks[0]);
+
+    // only tasks of this join, a task of another one could run for much longer than the join
+    while (state.remaining.load(std::memory_order_acquire) != 0) {
+        if (task *t = take(state))
+            run(*t);
+        else
+            std::this_thread::yield();
+    }
+    if (state.error)
+        std::rethrow_exception(state.error);
+}
+
+void work_stealing_pool::run(task &t) {
+    try {
+        (*t.f)(t.index);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(t.state->mutex);
+        if (!t.state->error)
+            t.state->error = std::current_exception();
+    }
+    t.state->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+work_stealing_pool::task *work_stealing_pool::pop(std::size_t self) {
+    task_queue &queue = *_queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    task *t = queue.pop_back();
+    if (t != nullptr)
+        --_queued;
+    return t;
+}
+
+work_stealing_pool::task *work_stealing_pool::steal(std::size_t self) {
+    for (std::size_t i = 0; i < _queues.size(); ++i) {
+        if (i == self)
+            continue;
+        task_queue &queue = *_queues[i];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        task *t = queue.pop_front();
+        if (t == nullptr)
+            continue;
+        --_queued;
+        return t;
+    }
+    return nullptr;
+}
+
+work_stealing_pool::task *work_stealing_pool::take(const join_state &state) {
+    for (auto &queue : _queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        task *t = queue->take(state);
+        if (t == nullptr)
+            continue;
+        --_queued;
+        return t;
+    }
+    return nullptr;
+}
+
+void work_stealing_pool::task_queue::push_back(task *t) {
+    if (count == ring.size()) {
+        std::vector<task *> grown(std::max<std::size_t>(2 * ring.size(), 16));
+        for (std::size_t i = 0; i < count; ++i)
+            grown[i] = ring[(head + i) % ring.size()];
+        ring.swap(grown);
+        head = 0;
+    }
+    ring[(head + count++) % ring.size()] = t;
+}
+
+work_stealing_pool::task *work_stealing_pool::task_queue::pop_back() {
+    if (count == 0)
+        return nullptr;
+    return ring[(head + --count) % ring.size()];
+}
+
+work_stealing_pool::task *work_stealing_pool::task_queue::pop_front() {
+    if (count == 0)
+        return nullptr;
+    task *t = ring[head];
+    head = (head + 1) % ring.size();
+    --count;
+    return t;
+}
+
+work_stealing_pool::task *work_stealing_pool::task_queue::take(const join_state &state) {
+    for (std::size_t i = 0; i < count; ++i) {
+        task *t = ring[(head + i) % ring.size()];
+        if (t->state != &state)
+            continue;
+        // the following tasks move one place to the front
+        for (std::size_t j = i + 1; j < count; ++j)
+            ring[(head + j - 1) % ring.size()] = ring[(head + j) % ring.size()];
+        --count;
+        return t;
+    }
+    return nullptr;
+}
+
+void work_stealing_pool::work(std::size_t self) {
+    for (;;) {
+        task *t = pop(self);
+        if (t == nullptr)
+            t = steal(self);
+        if (t != nullptr) {
+            run(*t);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _wake.wait(lock, [this] { return _stop || _queued.load() != 0; });
+        if (_stop)
+            return;
+    }
+}
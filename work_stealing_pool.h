@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fork-join thread pool with one task deque per worker
+ *
+ * A worker takes tasks from the back of its own deque and steals from the front of the others
+ * when it runs out. The thread calling parallel_for runs the not yet started tasks of its own
+ * call while it waits, so nested parallel_for calls from inside a task cannot deadlock and the
+ * waiting thread is not held up by unrelated tasks. A pool of zero workers runs every task on the
+ * calling thread.
+ */
+class work_stealing_pool {
+public:
+    explicit work_stealing_pool(std::size_t threads);
+    ~work_stealing_pool();
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+    /**
+     * @brief Calls f(0), ..., f(n - 1) concurrently and waits for all of them
+     *
+     * The first exception thrown by any call is rethrown after all calls finished.
+     */
+    void parallel_for(std::size_t n, const std::function<void(std::size_t)> &f);
+
+    std::size_t size() const { return _workers.size(); }
+
+    /**
+     * @brief Pool shared by all streams, one worker less than there are hardware threads
+     */
+    static work_stealing_pool &shared();
+
+private:
+    struct join_state;
+
+    struct task {
+        const std::function<void(std::size_t)> *f;
+        std::size_t index;
+        join_state *state;
+    };
+
+    /**
+     * Ring of tasks, it grows when full and never shrinks, so steady use does not allocate
+     */
+    struct task_queue {
+        void push_back(task *t);
+        task *pop_back();
+        task *pop_front();
+        task *take(const join_state &state); // the first task of the join
+
+        std::mutex mutex;
+        std::vector<task *> ring;
+        std::size_t head = 0;
+        std::size_t count = 0;
+    };
+
+    void work(std::size_t self);
+    task *pop(std::size_t self);
+    task *steal(std::size_t self);
+    task *take(const join_state &state);
+    static void run(task &t);
+
+    std::vector<std::unique_ptr<task_queue>> _queues;
+    std::atomic<std::size_t> _queued;
+    std::atomic<std::size_t> _next_queue;
+
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    bool _stop;
+
+    std::vector<std::thread> _workers;
+};